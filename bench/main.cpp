@@ -0,0 +1,366 @@
+// graphisque_bench: CPU microbenchmarks for the evaluators, the sampler and its thread
+// scaling. Links only the core sources; no window or GL context needed.
+//
+//   graphisque_bench [--json PATH] [--baseline PATH] [--threshold PERCENT]
+//                    [--max-resolution N] [--filter TEXT] [--quick] [--counters]
+//
+// --counters adds hardware counters per sample (cycles, IPC, L1d/LLC read
+// misses, branch misses) from one extra run of each single threaded case, when the
+// kernel allows perf_event_open.
+//
+// Every result is a throughput, so higher is better. With --baseline the run is compared
+// against a JSON file written earlier with --json; a result that got slower by more than
+// --threshold percent (default 5) is reported and the exit code is 1.
+
+#include "Expression.h"
+#include "HardwareCounters.h"
+#include "JobSystem.h"
+#include "SampleGrid.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+struct BenchResult {
+    std::string name;
+    double value = 0.0;
+    std::string unit;
+    CounterValues counters; // over one run of `items` samples
+    double items = 0.0;
+};
+
+struct BenchOptions {
+    const char* jsonPath = nullptr;
+    const char* baselinePath = nullptr;
+    double thresholdPercent = 5.0;
+    size_t maxResolution = 8192;
+    std::string filter;
+    double minSeconds = 0.25; // per measurement; the fastest run counts
+    bool counters = false;
+};
+
+// The interactive default surface, see f() in Equations.h
+static float nativeSurface(float x, float y) {
+    return std::sin(x) * std::tan(y);
+}
+
+static float nativeRipple(float x, float y) {
+    return std::sin(std::sqrt(x * x + y * y));
+}
+
+// Keeps results observable so the optimizer cannot drop the work being measured
+static volatile float g_sink = 0.0f;
+
+
+// Runs body() until minSeconds have passed and at least minRuns runs were made;
+// returns the fastest run in seconds
+template<typename Fn>
+static double fastestRun(Fn&& body, double minSeconds, int minRuns = 3) {
+    using Clock = std::chrono::steady_clock;
+    double best = 1e30;
+    double total = 0.0;
+    for (int run = 0; run < minRuns || total < minSeconds; ++run) {
+        auto start = Clock::now();
+        body();
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        best = std::min(best, seconds);
+        total += seconds;
+    }
+    return best;
+}
+
+static SampleDomain domainForResolution(size_t resolution) {
+    SampleDomain domain;
+    domain.step = (domain.xMax - domain.xMin) / static_cast<float>(resolution);
+    //rounding in countX() may add a row; pull the upper bound in by half a step
+    domain.xMax -= domain.step * 0.5f;
+    domain.yMax -= domain.step * 0.5f;
+    return domain;
+}
+
+
+class BenchSuite {
+    private:
+        BenchOptions _options;
+        std::vector<BenchResult> _results;
+        std::unique_ptr<HardwareCounters> _counters;
+
+        bool selected(const std::string& name) const {
+            return _options.filter.empty() || name.find(_options.filter) != std::string::npos;
+        }
+
+        void report(const std::string& name, double value, const std::string& unit) {
+            BenchResult result;
+            result.name = name;
+            result.value = value;
+            result.unit = unit;
+            _results.push_back(std::move(result));
+            std::printf("%-44s %12.2f %s\n", name.c_str(), value, unit.c_str());
+            std::fflush(stdout);
+        }
+
+        // One more run of body() under the hardware counters, attached to the last result
+        template<typename Fn>
+        void count(Fn&& body, double items) {
+            if (!_counters || !_counters->isAvailable() || _results.empty()) {
+                return;
+            }
+            _counters->start();
+            body();
+            BenchResult& result = _results.back();
+            result.counters = _counters->stop();
+            result.items = items;
+
+            const CounterValues& c = result.counters;
+            auto perItem = [&c, items](HardwareCounter counter, double scale) {
+                return c.has(counter) ? static_cast<double>(c.get(counter)) * scale / items : -1.0;
+            };
+            std::printf("%-44s cycles/item %.1f  IPC %.2f  per 1k items: L1d %.1f  LLC %.2f  branch %.2f\n", "",
+                        perItem(HardwareCounter::Cycles, 1.0), c.ipc(), perItem(HardwareCounter::L1DataMisses, 1000.0),
+                        perItem(HardwareCounter::LastLevelMisses, 1000.0), perItem(HardwareCounter::BranchMisses, 1000.0));
+        }
+
+        template<typename Fn>
+        void benchEvaluator(const std::string& name, Fn&& evaluate) {
+            if (!selected(name)) {
+                return;
+            }
+            //a 1024 x 1024 sweep over the default domain
+            const int n = 1024;
+            const float step = 10.0f / n;
+            auto sweep = [&]() {
+                float sum = 0.0f;
+                for (int i = 0; i < n; ++i) {
+                    float x = -5.0f + static_cast<float>(i) * step;
+                    for (int j = 0; j < n; ++j) {
+                        sum += evaluate(x, -5.0f + static_cast<float>(j) * step);
+                    }
+                }
+                g_sink = sum;
+            };
+            double seconds = fastestRun(sweep, _options.minSeconds);
+            report(name, static_cast<double>(n) * n / seconds / 1e6, "Msamples/s");
+            count(sweep, static_cast<double>(n) * n);
+        }
+
+    public:
+        explicit BenchSuite(const BenchOptions& options) : _options(options) {
+            if (options.counters) {
+                _counters = std::make_unique<HardwareCounters>();
+            }
+        }
+
+        const std::vector<BenchResult>& results() const { return _results; }
+
+        void evaluators() {
+            const Expression surface("sin(x) * tan(y)");
+            const Expression ripple("sin(sqrt(x*x + y*y))");
+            const std::function<float(float, float)> surfaceFunction = nativeSurface;
+            const std::function<float(float, float)> rippleFunction = nativeRipple;
+
+            //native: inlined call; function: through std::function like Equation; expression: the postfix interpreter
+            benchEvaluator("eval/native/sin(x)*tan(y)", nativeSurface);
+            benchEvaluator("eval/function/sin(x)*tan(y)", surfaceFunction);
+            benchEvaluator("eval/expression/sin(x)*tan(y)", surface);
+            benchEvaluator("eval/native/sin(sqrt(x*x+y*y))", nativeRipple);
+            benchEvaluator("eval/function/sin(sqrt(x*x+y*y))", rippleFunction);
+            benchEvaluator("eval/expression/sin(sqrt(x*x+y*y))", ripple);
+        }
+
+        // Single threaded sampleSurface, allocation of the grid included
+        void sampling() {
+            const Expression expression("sin(x) * tan(y)");
+            for (size_t resolution = 64; resolution <= _options.maxResolution; resolution *= 2) {
+                std::string name = "sample/" + std::to_string(resolution) + "^2";
+                if (!selected(name)) {
+                    continue;
+                }
+                SampleDomain domain = domainForResolution(resolution);
+                auto sample = [&]() {
+                    SampleGrid grid = sampleSurface(expression, domain);
+                    g_sink = grid.points.back().y;
+                };
+                double seconds = fastestRun(sample, _options.minSeconds, resolution >= 4096 ? 1 : 3);
+                report(name, static_cast<double>(domain.sampleCount()) / seconds / 1e6, "Msamples/s");
+                count(sample, static_cast<double>(domain.sampleCount()));
+            }
+        }
+
+        // The same tiled parallelFor the interactive rebuild uses, on 1..N workers
+        void threadScaling() {
+            const Expression expression("sin(x) * tan(y)");
+            const size_t resolution = std::min<size_t>(2048, _options.maxResolution);
+            const size_t tileRows = 16; // SAMPLE_TILE_ROWS
+            const unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+
+            std::vector<unsigned> counts;
+            for (unsigned threads = 1; threads < hardware; threads *= 2) {
+                counts.push_back(threads);
+            }
+            counts.push_back(hardware);
+
+            SampleDomain domain = domainForResolution(resolution);
+            SampleGrid grid;
+            grid.domain = domain;
+            grid.points.resize(domain.sampleCount());
+            double single = 0.0;
+            for (unsigned threads : counts) {
+                std::string name = "scaling/" + std::to_string(resolution) + "^2/threads=" + std::to_string(threads);
+                if (!selected(name)) {
+                    continue;
+                }
+                JobSystem jobs(threads);
+                double seconds = fastestRun([&]() {
+                    JobHandle done = jobs.parallelFor(domain.countX(), tileRows, [&](size_t rowBegin, size_t rowEnd) {
+                        sampleSurfaceRows(expression, grid, rowBegin, rowEnd);
+                    });
+                    jobs.wait(done);
+                }, _options.minSeconds);
+                double rate = static_cast<double>(domain.sampleCount()) / seconds / 1e6;
+                if (threads == 1) {
+                    single = rate;
+                }
+                report(name, rate, "Msamples/s");
+                if (single > 0.0) {
+                    std::printf("%-44s %12.2fx\n", "", rate / single);
+                }
+            }
+        }
+};
+
+
+static bool writeJson(const char* path, const std::vector<BenchResult>& results) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "(bench) Failed to open " << path << std::endl;
+        return false;
+    }
+    out << "{\n  \"version\": 1,\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        char value[64];
+        std::snprintf(value, sizeof(value), "%.6g", results[i].value);
+        out << "    {\"name\": \"" << results[i].name << "\", \"value\": " << value
+            << ", \"unit\": \"" << results[i].unit << "\"";
+        //raw counter totals over `items`, only those the machine provided
+        const CounterValues& counters = results[i].counters;
+        if (counters.any()) {
+            out << ", \"items\": " << results[i].items;
+            for (size_t c = 0; c < CounterValues::COUNT; ++c) {
+                if (counters.valid[c]) {
+                    out << ", \"" << hardwareCounterName(static_cast<HardwareCounter>(c)) << "\": " << counters.values[c];
+                }
+            }
+        }
+        out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+    return true;
+}
+
+// Reads back what writeJson() wrote: name -> value. Not a general JSON parser.
+static bool readBaseline(const char* path, std::map<std::string, double>& values) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "(bench) Failed to open baseline " << path << std::endl;
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    const std::string text = buffer.str();
+    const std::string nameKey = "\"name\": \"";
+    const std::string valueKey = "\"value\": ";
+    size_t pos = 0;
+    while ((pos = text.find(nameKey, pos)) != std::string::npos) {
+        size_t nameBegin = pos + nameKey.size();
+        size_t nameEnd = text.find('"', nameBegin);
+        size_t valuePos = text.find(valueKey, nameEnd);
+        if (nameEnd == std::string::npos || valuePos == std::string::npos) {
+            break;
+        }
+        values[text.substr(nameBegin, nameEnd - nameBegin)] = std::strtod(text.c_str() + valuePos + valueKey.size(), nullptr);
+        pos = valuePos;
+    }
+    return true;
+}
+
+// Prints old vs new for every result present in both; returns the number of regressions
+static int compareWithBaseline(const std::map<std::string, double>& baseline, const std::vector<BenchResult>& results,
+                               double thresholdPercent) {
+    int regressions = 0;
+    std::printf("\n%-44s %12s %12s %9s\n", "compared with baseline", "baseline", "current", "change");
+    for (const BenchResult& result : results) {
+        auto it = baseline.find(result.name);
+        if (it == baseline.end() || it->second <= 0.0) {
+            continue;
+        }
+        double change = (result.value - it->second) / it->second * 100.0;
+        bool regressed = change < -thresholdPercent;
+        regressions += regressed ? 1 : 0;
+        std::printf("%-44s %12.2f %12.2f %+8.1f%%%s\n", result.name.c_str(), it->second, result.value, change,
+                    regressed ? "  REGRESSION" : "");
+    }
+    return regressions;
+}
+
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--json") == 0 && hasValue) {
+            options.jsonPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--baseline") == 0 && hasValue) {
+            options.baselinePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--threshold") == 0 && hasValue) {
+            options.thresholdPercent = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--max-resolution") == 0 && hasValue) {
+            options.maxResolution = static_cast<size_t>(std::atol(argv[++i]));
+        } else if (std::strcmp(argv[i], "--filter") == 0 && hasValue) {
+            options.filter = argv[++i];
+        } else if (std::strcmp(argv[i], "--counters") == 0) {
+            options.counters = true;
+        } else if (std::strcmp(argv[i], "--quick") == 0) {
+            options.minSeconds = 0.05;
+            options.maxResolution = std::min<size_t>(options.maxResolution, 1024);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--json PATH] [--baseline PATH] [--threshold PERCENT]"
+                      << " [--max-resolution N] [--filter TEXT] [--quick] [--counters]" << std::endl;
+            return 2;
+        }
+    }
+
+    std::map<std::string, double> baseline;
+    if (options.baselinePath != nullptr && !readBaseline(options.baselinePath, baseline)) {
+        return 2;
+    }
+
+    BenchSuite suite(options);
+    suite.evaluators();
+    suite.sampling();
+    suite.threadScaling();
+
+    if (options.jsonPath != nullptr && !writeJson(options.jsonPath, suite.results())) {
+        return 2;
+    }
+    if (options.baselinePath != nullptr) {
+        int regressions = compareWithBaseline(baseline, suite.results(), options.thresholdPercent);
+        if (regressions > 0) {
+            std::printf("%d result(s) regressed by more than %.1f%%\n", regressions, options.thresholdPercent);
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,513 @@
+// graphisque_upload_bench: what each way of getting vertex data into a GLBuffer costs,
+// on a headless context (Mesa's surfaceless EGL platform works without a GPU or display).
+//
+//   graphisque_upload_bench [--json PATH] [--sizes KiB,KiB,...] [--seconds S]
+//
+// Every frame uploads new data with one strategy and then draws from what it just wrote,
+// so the driver has to honour the dependency. Patterns:
+//   full       the whole buffer is replaced every frame (a resampled surface)
+//   partial    an eighth of the buffer at a rotating offset (editing part of a grid)
+//   streaming  the buffer is filled in 64 KiB chunks with a draw after each (chunked uploads)
+// Reported per case: MB/s over the whole run including the final glFinish, and the mean
+// and p99 CPU time of a frame (upload + draw submission + any wait for a fence).
+// The summary names the fastest strategy per pattern and size, which is what the
+// GL_STATIC_DRAW / GL_DYNAMIC_DRAW / GL_STREAM_DRAW paths of GLBuffer should follow.
+
+#include <glad/glad.h>
+#include "GLBuffer.h"
+#include "GLFramebuffer.h"
+#include "HeadlessContext.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+// GL 4.4 / ARB_buffer_storage, beyond what the generated loader covers
+typedef void (APIENTRYP PFNGLBUFFERSTORAGEPROC)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+static PFNGLBUFFERSTORAGEPROC g_bufferStorage = nullptr;
+
+
+enum class Pattern { Full, Partial, Streaming };
+
+enum class Strategy {
+    BufferData,         // setData: glBufferData with the data, a new allocation every time
+    SubData,            // updateData: glBufferSubData into the existing storage
+    Orphan,             // resize (glBufferData with nullptr) then updateData
+    Map,                // map(GL_WRITE_ONLY) + memcpy + unmap
+    MapRangeInvalidate, // mapRange with GL_MAP_INVALIDATE_RANGE_BIT / _BUFFER_BIT
+    MapRangeUnsync,     // mapRange unsynchronized into a ring of three regions guarded by fences
+    Persistent          // glBufferStorage, mapped once, persistent + coherent ring with fences
+};
+
+static const char* patternName(Pattern pattern) {
+    switch (pattern) {
+        case Pattern::Full:      return "full";
+        case Pattern::Partial:   return "partial";
+        case Pattern::Streaming: return "streaming";
+    }
+    return "";
+}
+
+static const char* strategyName(Strategy strategy) {
+    switch (strategy) {
+        case Strategy::BufferData:         return "bufferdata";
+        case Strategy::SubData:            return "subdata";
+        case Strategy::Orphan:             return "orphan";
+        case Strategy::Map:                return "map";
+        case Strategy::MapRangeInvalidate: return "maprange-invalidate";
+        case Strategy::MapRangeUnsync:     return "maprange-unsync";
+        case Strategy::Persistent:         return "persistent";
+    }
+    return "";
+}
+
+// Strategies that make sense for a pattern; rings need whole regions, orphaning drops the
+// parts of the buffer a partial update leaves alone
+static bool applies(Pattern pattern, Strategy strategy) {
+    switch (pattern) {
+        case Pattern::Full:
+            return true;
+        case Pattern::Partial:
+            return strategy == Strategy::SubData || strategy == Strategy::Map || strategy == Strategy::MapRangeInvalidate;
+        case Pattern::Streaming:
+            return strategy != Strategy::BufferData && strategy != Strategy::Map;
+    }
+    return false;
+}
+
+
+struct CaseResult {
+    Pattern pattern = Pattern::Full;
+    Strategy strategy = Strategy::SubData;
+    size_t bytes = 0;
+    size_t frames = 0;
+    double megabytesPerSecond = 0.0;
+    double meanFrameMs = 0.0;
+    double p99FrameMs = 0.0;
+};
+
+
+static const char* VERTEX_SHADER = R"(#version 330 core
+layout(location = 0) in vec3 aPos;
+void main() { gl_Position = vec4(aPos * 0.001, 1.0); }
+)";
+
+static const char* FRAGMENT_SHADER = R"(#version 330 core
+out vec4 color;
+void main() { color = vec4(1.0); }
+)";
+
+static GLuint compileProgram() {
+    auto compile = [](GLenum type, const char* source) {
+        GLuint shader = glCreateShader(type);
+        glShaderSource(shader, 1, &source, nullptr);
+        glCompileShader(shader);
+        GLint ok = GL_FALSE;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+        if (ok != GL_TRUE) {
+            throw std::runtime_error("Benchmark shader failed to compile");
+        }
+        return shader;
+    };
+    GLuint vertex = compile(GL_VERTEX_SHADER, VERTEX_SHADER);
+    GLuint fragment = compile(GL_FRAGMENT_SHADER, FRAGMENT_SHADER);
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertex);
+    glAttachShader(program, fragment);
+    glLinkProgram(program);
+    glDeleteShader(vertex);
+    glDeleteShader(fragment);
+    GLint ok = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &ok);
+    if (ok != GL_TRUE) {
+        throw std::runtime_error("Benchmark program failed to link");
+    }
+    return program;
+}
+
+
+class UploadBench {
+    private:
+        static constexpr size_t RING_REGIONS = 3;
+        static constexpr size_t STREAM_CHUNK = 64 * 1024;
+        static constexpr GLsizei DRAW_VERTICES = 1024;
+
+        double _minSeconds;
+        GLuint _program = 0;
+        GLuint _vao = 0;
+        std::unique_ptr<GLFramebuffer> _target;
+        std::vector<uint8_t> _source;
+
+        // per case
+        std::unique_ptr<GLBuffer> _buffer;
+        GLuint _storageBuffer = 0; // Persistent; GLBuffer has no immutable storage
+        uint8_t* _persistent = nullptr;
+        GLsync _fences[RING_REGIONS] = {};
+        size_t _frame = 0;
+
+        void bindForDraw(GLuint buffer) {
+            glBindVertexArray(_vao);
+            glBindBuffer(GL_ARRAY_BUFFER, buffer);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 12, nullptr);
+            glEnableVertexAttribArray(0);
+        }
+
+        // Reads back what was just written: a draw over (up to) the first vertices of the range
+        void drawRange(size_t offset, size_t bytes) {
+            GLsizei count = static_cast<GLsizei>(std::min<size_t>(DRAW_VERTICES, bytes / 12));
+            glDrawArrays(GL_POINTS, static_cast<GLint>(offset / 12), count);
+        }
+
+        void waitRegion(size_t region) {
+            if (_fences[region] == nullptr) {
+                return;
+            }
+            while (glClientWaitSync(_fences[region], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED) {
+            }
+            glDeleteSync(_fences[region]);
+            _fences[region] = nullptr;
+        }
+
+        void fenceRegion(size_t region) {
+            if (_fences[region] != nullptr) {
+                glDeleteSync(_fences[region]);
+            }
+            _fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        }
+
+        size_t allocationFor(Strategy strategy, size_t bytes) const {
+            return strategy == Strategy::MapRangeUnsync || strategy == Strategy::Persistent ? bytes * RING_REGIONS : bytes;
+        }
+
+        void setUp(Strategy strategy, size_t bytes) {
+            size_t allocation = allocationFor(strategy, bytes);
+            if (strategy == Strategy::Persistent) {
+                glGenBuffers(1, &_storageBuffer);
+                glBindBuffer(GL_ARRAY_BUFFER, _storageBuffer);
+                GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+                g_bufferStorage(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(allocation), nullptr, flags);
+                _persistent = static_cast<uint8_t*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, allocation, flags));
+                if (_persistent == nullptr) {
+                    throw std::runtime_error("Failed to map persistent buffer");
+                }
+                bindForDraw(_storageBuffer);
+            } else {
+                _buffer = std::make_unique<GLBuffer>(GL_ARRAY_BUFFER, GL_DYNAMIC_DRAW);
+                _buffer->setData(_source.data(), allocation);
+                bindForDraw(_buffer->getID());
+            }
+            _frame = 0;
+        }
+
+        void tearDown() {
+            glFinish();
+            for (GLsync& fence : _fences) {
+                if (fence != nullptr) {
+                    glDeleteSync(fence);
+                    fence = nullptr;
+                }
+            }
+            if (_storageBuffer != 0) {
+                glBindBuffer(GL_ARRAY_BUFFER, _storageBuffer);
+                glUnmapBuffer(GL_ARRAY_BUFFER);
+                glDeleteBuffers(1, &_storageBuffer);
+                _storageBuffer = 0;
+                _persistent = nullptr;
+            }
+            _buffer.reset();
+        }
+
+        // Writes `bytes` of source data at `offset` of the buffer with one strategy; for the
+        // rings `offset` is already inside the current region
+        void write(Strategy strategy, size_t offset, size_t bytes, const uint8_t* data, bool wholeBuffer) {
+            switch (strategy) {
+                case Strategy::BufferData:
+                    _buffer->setData(data, bytes);
+                    break;
+                case Strategy::SubData:
+                    _buffer->updateData(data, bytes, offset);
+                    break;
+                case Strategy::Orphan:
+                    _buffer->updateData(data, bytes, offset);
+                    break;
+                case Strategy::Map: {
+                    uint8_t* mapped = static_cast<uint8_t*>(_buffer->map(GL_WRITE_ONLY));
+                    std::memcpy(mapped + offset, data, bytes);
+                    _buffer->unmap();
+                    break;
+                }
+                case Strategy::MapRangeInvalidate: {
+                    GLbitfield invalidate = wholeBuffer ? GL_MAP_INVALIDATE_BUFFER_BIT : GL_MAP_INVALIDATE_RANGE_BIT;
+                    void* mapped = _buffer->mapRange(offset, bytes, GL_MAP_WRITE_BIT | invalidate);
+                    std::memcpy(mapped, data, bytes);
+                    _buffer->unmap();
+                    break;
+                }
+                case Strategy::MapRangeUnsync: {
+                    GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
+                    void* mapped = _buffer->mapRange(offset, bytes, access);
+                    std::memcpy(mapped, data, bytes);
+                    _buffer->unmap();
+                    break;
+                }
+                case Strategy::Persistent:
+                    std::memcpy(_persistent + offset, data, bytes);
+                    break;
+            }
+        }
+
+        void runFrame(Pattern pattern, Strategy strategy, size_t bytes) {
+            const bool ring = strategy == Strategy::MapRangeUnsync || strategy == Strategy::Persistent;
+            const size_t region = _frame % RING_REGIONS;
+            const size_t base = ring ? region * bytes : 0;
+            //fresh data every frame so nothing can be skipped as unchanged
+            const uint8_t* data = _source.data() + (_frame % 2) * 12;
+
+            if (ring) {
+                waitRegion(region);
+            }
+            if (strategy == Strategy::Orphan) {
+                _buffer->resize(bytes);
+            }
+            switch (pattern) {
+                case Pattern::Full:
+                    write(strategy, base, bytes, data, true);
+                    drawRange(base, bytes);
+                    break;
+                case Pattern::Partial: {
+                    size_t slice = std::max<size_t>(bytes / 8 / 12 * 12, 12);
+                    size_t offset = (_frame % 8) * slice;
+                    if (offset + slice > bytes) {
+                        offset = 0;
+                    }
+                    write(strategy, offset, slice, data, false);
+                    drawRange(offset, slice);
+                    break;
+                }
+                case Pattern::Streaming:
+                    for (size_t offset = 0; offset < bytes; offset += STREAM_CHUNK) {
+                        size_t chunk = std::min(STREAM_CHUNK, bytes - offset);
+                        write(strategy, base + offset, chunk, data + offset, false);
+                        drawRange(base + offset, chunk);
+                    }
+                    break;
+            }
+            if (ring) {
+                fenceRegion(region);
+            }
+            ++_frame;
+        }
+
+    public:
+        explicit UploadBench(double minSeconds) : _minSeconds(minSeconds) {
+            _program = compileProgram();
+            glGenVertexArrays(1, &_vao);
+            _target = std::make_unique<GLFramebuffer>(64, 64);
+            _target->bind();
+            glViewport(0, 0, 64, 64);
+            glUseProgram(_program);
+        }
+
+        ~UploadBench() {
+            tearDown();
+            glDeleteVertexArrays(1, &_vao);
+            glDeleteProgram(_program);
+        }
+
+        CaseResult run(Pattern pattern, Strategy strategy, size_t bytes) {
+            using Clock = std::chrono::steady_clock;
+            //source: the largest ring allocation plus the per-frame shift
+            size_t sourceBytes = allocationFor(Strategy::Persistent, bytes) + 12;
+            if (_source.size() < sourceBytes) {
+                _source.resize(sourceBytes);
+                for (size_t i = 0; i < _source.size(); ++i) {
+                    _source[i] = static_cast<uint8_t>(i * 2654435761u >> 24);
+                }
+            }
+
+            CaseResult result;
+            result.pattern = pattern;
+            result.strategy = strategy;
+            result.bytes = bytes;
+
+            setUp(strategy, bytes);
+            for (int i = 0; i < 3; ++i) {
+                runFrame(pattern, strategy, bytes); // warm up: first-touch allocations, shader variants
+            }
+            glFinish();
+
+            const size_t bytesPerFrame = pattern == Pattern::Partial ? std::max<size_t>(bytes / 8 / 12 * 12, 12) : bytes;
+            std::vector<double> frameMs;
+            auto start = Clock::now();
+            double elapsed = 0.0;
+            while ((elapsed < _minSeconds || frameMs.size() < 10) && frameMs.size() < 5000) {
+                auto frameStart = Clock::now();
+                runFrame(pattern, strategy, bytes);
+                auto frameEnd = Clock::now();
+                frameMs.push_back(std::chrono::duration<double, std::milli>(frameEnd - frameStart).count());
+                elapsed = std::chrono::duration<double>(frameEnd - start).count();
+            }
+            glFinish();
+            double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            tearDown();
+
+            GLenum error = glGetError();
+            if (error != GL_NO_ERROR) {
+                throw std::runtime_error("OpenGL error " + std::to_string(error) + " in " + strategyName(strategy));
+            }
+
+            result.frames = frameMs.size();
+            result.megabytesPerSecond = static_cast<double>(bytesPerFrame) * result.frames / seconds / 1e6;
+            double total = 0.0;
+            for (double ms : frameMs) {
+                total += ms;
+            }
+            result.meanFrameMs = total / static_cast<double>(frameMs.size());
+            std::sort(frameMs.begin(), frameMs.end());
+            result.p99FrameMs = frameMs[std::min(frameMs.size() - 1, frameMs.size() * 99 / 100)];
+            return result;
+        }
+};
+
+
+// Sizes are trimmed to whole vertices, so label them rounded
+static std::string sizeLabel(size_t bytes) {
+    if (bytes >= (1u << 20) - 12) {
+        return std::to_string((bytes + (1u << 19)) >> 20) + "MiB";
+    }
+    return std::to_string((bytes + 512) >> 10) + "KiB";
+}
+
+static bool writeJson(const char* path, const std::vector<CaseResult>& results) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "(upload bench) Failed to open " << path << std::endl;
+        return false;
+    }
+    out << "{\n  \"version\": 1,\n  \"renderer\": \"" << glGetString(GL_RENDERER) << "\",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const CaseResult& r = results[i];
+        char line[512];
+        std::snprintf(line, sizeof(line),
+                      "    {\"name\": \"upload/%s/%s/%s\", \"value\": %.6g, \"unit\": \"MB/s\", "
+                      "\"frame_ms_mean\": %.6g, \"frame_ms_p99\": %.6g, \"frames\": %zu}%s\n",
+                      patternName(r.pattern), sizeLabel(r.bytes).c_str(), strategyName(r.strategy),
+                      r.megabytesPerSecond, r.meanFrameMs, r.p99FrameMs, r.frames, i + 1 < results.size() ? "," : "");
+        out << line;
+    }
+    out << "  ]\n}\n";
+    return true;
+}
+
+
+int main(int argc, char** argv) {
+    const char* jsonPath = nullptr;
+    double minSeconds = 0.3;
+    std::vector<size_t> sizes = {64 << 10, 1 << 20, 4 << 20, 16 << 20};
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--json") == 0 && hasValue) {
+            jsonPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--seconds") == 0 && hasValue) {
+            minSeconds = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--sizes") == 0 && hasValue) {
+            sizes.clear();
+            for (const char* p = argv[++i]; *p != '\0';) {
+                char* end = nullptr;
+                long kib = std::strtol(p, &end, 10);
+                if (end == p || kib <= 0) {
+                    break;
+                }
+                sizes.push_back(static_cast<size_t>(kib) * 1024);
+                p = *end == ',' ? end + 1 : end;
+            }
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--json PATH] [--sizes KiB,KiB,...] [--seconds S]" << std::endl;
+            return 2;
+        }
+    }
+
+    //whole vertices, so draws and ring regions start on a vertex
+    for (size_t& bytes : sizes) {
+        bytes = bytes / 12 * 12;
+    }
+
+    HeadlessContext context;
+    if (!context.create(3, 3) || !context.makeCurrent()) {
+        std::cerr << "Failed to create a headless OpenGL context" << std::endl;
+        return 1;
+    }
+    if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(HeadlessContext::getProcAddress))) {
+        std::cerr << "Failed to initialize GLAD!" << std::endl;
+        return 1;
+    }
+    GLint major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    bool bufferStorage = major > 4 || (major == 4 && minor >= 4);
+    GLint extensions = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensions);
+    for (GLint i = 0; i < extensions && !bufferStorage; ++i) {
+        const char* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+        bufferStorage = name != nullptr && std::strcmp(name, "GL_ARB_buffer_storage") == 0;
+    }
+    if (bufferStorage) {
+        g_bufferStorage = reinterpret_cast<PFNGLBUFFERSTORAGEPROC>(HeadlessContext::getProcAddress("glBufferStorage"));
+    }
+    std::printf("%s, %s, GL %d.%d%s\n", context.getDescription().c_str(), glGetString(GL_RENDERER), major, minor,
+                g_bufferStorage != nullptr ? "" : " (no buffer storage, persistent mapping skipped)");
+
+    std::vector<CaseResult> results;
+    try {
+        UploadBench bench(minSeconds);
+        std::printf("%-10s %-8s %-20s %12s %12s %12s\n", "pattern", "size", "strategy", "MB/s", "frame ms", "p99 ms");
+        for (Pattern pattern : {Pattern::Full, Pattern::Partial, Pattern::Streaming}) {
+            for (size_t bytes : sizes) {
+                const CaseResult* best = nullptr;
+                size_t first = results.size();
+                for (int s = 0; s <= static_cast<int>(Strategy::Persistent); ++s) {
+                    Strategy strategy = static_cast<Strategy>(s);
+                    if (!applies(pattern, strategy) || (strategy == Strategy::Persistent && g_bufferStorage == nullptr)) {
+                        continue;
+                    }
+                    results.push_back(bench.run(pattern, strategy, bytes));
+                    const CaseResult& r = results.back();
+                    std::printf("%-10s %-8s %-20s %12.1f %12.3f %12.3f\n", patternName(pattern), sizeLabel(bytes).c_str(),
+                                strategyName(strategy), r.megabytesPerSecond, r.meanFrameMs, r.p99FrameMs);
+                    std::fflush(stdout);
+                }
+                for (size_t i = first; i < results.size(); ++i) {
+                    if (best == nullptr || results[i].megabytesPerSecond > best->megabytesPerSecond) {
+                        best = &results[i];
+                    }
+                }
+                if (best != nullptr) {
+                    std::printf("%-10s %-8s fastest: %s\n", "", "", strategyName(best->strategy));
+                }
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "(upload bench) " << e.what() << std::endl;
+        return 1;
+    }
+
+    if (jsonPath != nullptr && !writeJson(jsonPath, results)) {
+        return 2;
+    }
+    context.destroy();
+    return 0;
+}
@@ -0,0 +1,22 @@
+# Writes OUTPUT, a C++ source holding every file of SHADER_DIR as a string (see ShaderLibrary.h).
+# Run as a script: cmake -DSHADER_DIR=... -DOUTPUT=... -P EmbedShaders.cmake
+file(GLOB SHADER_FILES RELATIVE ${SHADER_DIR} ${SHADER_DIR}/*)
+list(SORT SHADER_FILES)
+
+set(CONTENT "// Generated from shaders/ by cmake/EmbedShaders.cmake, do not edit\n")
+string(APPEND CONTENT "#include \"ShaderLibrary.h\"\n\n")
+string(APPEND CONTENT "const EmbeddedShader EMBEDDED_SHADERS[] = {\n")
+foreach(NAME ${SHADER_FILES})
+    file(READ ${SHADER_DIR}/${NAME} SOURCE)
+    string(APPEND CONTENT "    {\"${NAME}\", R\"glsl(${SOURCE})glsl\"},\n")
+endforeach()
+string(APPEND CONTENT "};\n\n")
+string(APPEND CONTENT "const size_t EMBEDDED_SHADER_COUNT = sizeof(EMBEDDED_SHADERS) / sizeof(EMBEDDED_SHADERS[0]);\n")
+
+# only touch the file when a shader changed, so nothing recompiles needlessly
+if(EXISTS ${OUTPUT})
+    file(READ ${OUTPUT} PREVIOUS)
+endif()
+if(NOT "${PREVIOUS}" STREQUAL "${CONTENT}")
+    file(WRITE ${OUTPUT} "${CONTENT}")
+endif()
@@ -0,0 +1,71 @@
+#ifndef ALLOCATION_TRACKER_H
+#define ALLOCATION_TRACKER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+
+struct AllocationCounts {
+    uint64_t allocations = 0;
+    uint64_t frees = 0;
+    uint64_t bytes = 0; // requested bytes, frees are not subtracted
+};
+
+
+// Counts every global operator new/delete (GRAPHISQUE_TRACK_ALLOCATIONS builds only).
+//
+// Each thread counts into its own block with relaxed stores, so the hooks never lock and
+// never allocate themselves. Allocations are attributed to the innermost profiler scope
+// of the allocating thread (see Profiler::threadScope), "(no scope)" outside of one.
+// Without GRAPHISQUE_TRACK_ALLOCATIONS everything reads as zero.
+class AllocationTracker {
+    public:
+        struct ScopeEntry {
+            const char* name;
+            AllocationCounts counts;
+        };
+
+        static constexpr bool isEnabled() {
+#ifdef GRAPHISQUE_TRACK_ALLOCATIONS
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        // Since startup, summed over every thread that ever allocated
+        static AllocationCounts totals();
+        // Since startup, calling thread only
+        static AllocationCounts threadTotals();
+        // Merged over all threads, most allocations first
+        static std::pmr::vector<ScopeEntry> scopes(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+        // Called by the operator new/delete replacements
+        static void recordAllocation(size_t size);
+        static void recordFree();
+
+        // Allocating on this thread while forbidden prints the size and the scope and aborts
+        static void setForbidden(bool forbidden);
+        static bool isForbidden();
+};
+
+
+// RAII; the calling thread must not allocate while this is alive (nests)
+class NoAllocationScope {
+    private:
+        bool _wasForbidden;
+
+    public:
+        NoAllocationScope() : _wasForbidden(AllocationTracker::isForbidden()) {
+            AllocationTracker::setForbidden(true);
+        }
+        ~NoAllocationScope() {
+            AllocationTracker::setForbidden(_wasForbidden);
+        }
+        NoAllocationScope(const NoAllocationScope&) = delete;
+        NoAllocationScope& operator=(const NoAllocationScope&) = delete;
+};
+
+#endif // ALLOCATION_TRACKER_H
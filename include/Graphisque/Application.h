@@ -8,18 +8,52 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <memory>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <array>
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "Globals.h"
 #include "GLBuffer.h"
 #include "GLVertexArray.h"
 #include "Shader.h"
+#include "ShaderVariants.h"
 #include "Camera.h"
 
 #include "Grid3D.h"
 #include "Cube.h"
 #include "Axes.h"
 #include "Equations.h"
+#include "UploadWorker.h"
+#include "FrameSnapshot.h"
+#include "TripleBuffer.h"
+#include "JobSystem.h"
+#include "LockFreeQueue.h"
+#include "FrameScheduler.h"
+#include "UiLayer.h"
+#include "Profiler.h"
+#include "GpuProfiler.h"
+#include "ProfilerOverlay.h"
+#include "RenderStatsOverlay.h"
+#include "ColormapOverlay.h"
+#include "Colormap.h"
+#include "HeadlessContext.h"
+#include "GLFramebuffer.h"
+#include "DynamicResolution.h"
+#include "FramePacer.h"
+#include "FrameCapture.h"
+#include "TiledRenderer.h"
+#include "InputRecording.h"
+
+
+enum class RenderLoopMode { 
+    Continuous, // redraw every iteration (animations, benchmarks)
+    OnDemand    // redraw only when something marked the frame dirty, otherwise sleep in glfwWaitEventsTimeout
+};
 
 
 class Application { 
@@ -33,7 +67,10 @@ class Application {
         float lastFrame;
         static Application* getApplicationPtr(GLFWwindow* window); // Static method to get the application pointer from GLFW window user pointer
 
+        ShaderVariants _shaderVariants;
         std::shared_ptr<Shader> _mainShader;
+        std::shared_ptr<Shader> _colormapShader; // linked on first use
+        std::unique_ptr<ColormapTexture> _colormaps;
         std::shared_ptr<Camera> devCamera;
         std::shared_ptr<Camera> activeCamera;
         std::shared_ptr<OrbitalCamera> orbitCamera;
@@ -46,6 +83,104 @@ class Application {
 
         std::unique_ptr<Axes> axes;
         std::unique_ptr<Equation> equation;
+        std::unique_ptr<UploadWorker> _uploadWorker; // uploads sampled surfaces on a shared context
+        std::unique_ptr<JobSystem> _jobs;
+        CancellationToken _rebuildToken; // cancelled as soon as a newer rebuild is requested
+        LockFreeQueue<SampleGrid> _readyGrids{8}; // sampled grids waiting for a synchronous upload
+        std::atomic<uint64_t> _rebuildGeneration{0}; // the equation's generation, for the sampling jobs
+        //the newest grid when both queues were full; the current rebuild's result is never dropped
+        std::mutex _overflowMutex;
+        SampleGrid _overflowGrid;
+        bool _hasOverflowGrid = false;
+        void deliverGrid(SampleGrid&& grid);
+        FrameScheduler _frameScheduler; // time sliced GL-thread work (mesh creation, chunked uploads)
+        UiLayer _ui;
+        ProfilerOverlay _profilerOverlay;
+        RenderStatsOverlay _statsOverlay;
+        ColormapOverlay _colormapOverlay;
+
+        //main thread (simulation/UI) state that the render side only sees through snapshots
+        SampleDomain _equationDomain;
+        ColorMapping _colorMapping;
+        ResolutionSettings _resolutionSettings;
+        uint64_t _frameIndex = 0;
+        //range the render thread last mapped the surface with, for the colormap panel
+        std::atomic<float> _shownRangeMin{0.0f};
+        std::atomic<float> _shownRangeMax{-1.0f};
+
+        //render thread; owns the GL context while running
+        bool _threadedRendering = true;
+        std::thread _renderThread;
+        std::atomic<bool> _renderRunning{false};
+        TripleBuffer<FrameSnapshot> _frameMailbox;
+        std::mutex _frameMutex; // only parks the render thread, the mailbox itself is lock free
+        std::condition_variable _frameCv;
+        int _viewportWidth = 0, _viewportHeight = 0; // render thread owned
+        DynamicResolution _dynamicResolution; // render thread owned
+        FramePacer _framePacer;               // render thread owned, after every swap
+        double _frameInputTime = 0.0;         // render thread; the drawn frame's input, for _framePacer
+
+        //low latency mode: the main thread hands the camera straight to the render side, which
+        //takes it right before drawing instead of using the one in the (older) snapshot
+        //the view, projection and viewport go together: a resize between two snapshots changes all three
+        struct LatchedCamera { 
+            glm::mat4 view = glm::mat4(1.0f);
+            glm::mat4 projection = glm::mat4(1.0f);
+            int framebufferWidth = 0;
+            int framebufferHeight = 0;
+            double inputTime = 0.0; // the pending input time, once the view includes it
+        };
+        bool _lowLatency = false;
+        std::mutex _latchMutex;
+        LatchedCamera _latched;
+        double _pendingInputTime = 0.0; // oldest input no frame shows yet, 0 for none
+        void noteInput();
+        void publishCamera();
+        double takeInputTime();
+        LatchedCamera latchCamera();
+
+        //headless mode: EGL context + offscreen framebuffer instead of a GLFW window
+        bool _headless = false;
+        std::unique_ptr<HeadlessContext> _headlessContext;
+        std::unique_ptr<GLFramebuffer> _offscreenTarget;
+        std::chrono::steady_clock::time_point _startTime = std::chrono::steady_clock::now();
+        bool initHeadless();
+        double elapsedSeconds() const;
+        glm::mat4 projectionFor(int width, int height) const;
+
+        //frame capture; the turntable angle advances per rendered frame, on the render side
+        FrameCapture _capture;
+        std::atomic<uint32_t> _turntableFrames{0}; // 0 when no turntable is being recorded
+        uint32_t _turntableRendered = 0;           // render thread owned
+        int _screenshotCount = 0;
+
+        //input record/replay; processInput reads the key state the key events maintain, so
+        //live input and a replayed recording go through exactly the same code
+        std::array<bool, GLFW_KEY_LAST + 1> _keysDown{};
+        InputRecorder _recorder;
+        bool _replaying = false; // live GLFW input is ignored while a recording plays
+        bool isKeyDown(int key) const { return key >= 0 && key <= GLFW_KEY_LAST && _keysDown[key]; }
+        void recordInput(const InputEvent& event);
+        void applyInputEvent(const InputEvent& event);
+        void applyReplaySize(int width, int height);
+        void renderReplayFrame();
+
+        //--assert-no-alloc: once the scene has settled, drawing a frame must not allocate
+        bool _assertNoAllocations = false;
+        uint32_t _settledFrames = 0; // render thread owned
+
+        //dirty tracking for RenderLoopMode::OnDemand
+        RenderLoopMode _loopMode = RenderLoopMode::OnDemand;
+        std::atomic<bool> _frameDirty{true};
+        double _idleTimeout = 0.5; // seconds the loop may sleep without events
+        bool hasPendingRenderWork() const;
+
+        void buildSnapshot(FrameSnapshot& snapshot);
+        void publishSnapshot();
+        void setupRenderState();
+        void renderThreadLoop();
+        void runSingleThreaded();
+        void runThreaded();
 
 
         Cube * cube;
@@ -65,8 +200,68 @@ class Application {
         bool initImgui();
         void processInput(float deltaTime);
 
-        void render(float deltaTime);
+        void renderFrame(const FrameSnapshot& snapshot);
+        void drawScene(const FrameSnapshot& snapshot, const glm::mat4& view, const glm::mat4& projection);
+        void drawEquation(const ColorMapping& mapping, const glm::mat4& view, const glm::mat4& projection);
+        void drawUi(const FrameSnapshot& snapshot);
         void run() ;
+        void setThreadedRendering(bool enabled) { _threadedRendering = enabled; }
+        void setFrameBudget(double milliseconds) { _frameScheduler.setBudget(milliseconds); }
+        void setRenderLoopMode(RenderLoopMode mode) { _loopMode = mode; }
+        RenderLoopMode getRenderLoopMode() const { return _loopMode; }
+
+        // Render without a window into a width x height framebuffer; call before init()
+        void setHeadless(int width, int height);
+        bool isHeadless() const { return _headless; }
+        // Headless only: renders until the scene has settled (everything built and the
+        // full resolution surface shown) or maxFrames were drawn; returns the frame count
+        int renderOffscreen(int maxFrames = 600);
+        // True once nothing is left to build, sample or upload
+        bool isSceneSettled() const;
+        // Headless only: RGBA8 contents of the offscreen target, bottom row first
+        bool readPixels(std::vector<uint8_t>& rgba) const;
+        int getFramebufferWidth() const { return WIN_WIDTH; }
+        int getFramebufferHeight() const { return WIN_HEIGHT; }
+
+        // Capture without stalling rendering; see FrameCapture. The format follows the extension.
+        bool startCapture(const std::string& path, int fps = 30);
+        void stopCapture() { _capture.end(); }
+        bool isCapturing() const { return _capture.isActive(); }
+        bool captureScreenshot(const std::string& path);
+        // Records one full turn of the scene around the vertical axis in `frames` frames
+        bool recordTurntable(const std::string& path, uint32_t frames = 360, int fps = 30);
+        // Renders the current view at width x height in tiles, a tile per frame, into a PNG
+        void requestPoster(const std::string& path, int width, int height, int tileSize = 2048);
+        // Records input events and scene commands to `path` until stopInputRecording() or exit
+        bool startInputRecording(const std::string& path);
+        void stopInputRecording() { _recorder.end(); }
+        // Plays a recording back instead of run(): events are applied at fixed `timestep`
+        // ticks, every frame is rendered and finished, and the frame times are returned.
+        // The scene is left to settle first so each run starts from the same state.
+        FrameTimeSummary replayInput(const std::string& path, double timestep = 1.0 / 60.0);
+        // Scene command: recorded, unlike the +/- keys that change the step through input
+        void setSampleStep(float step);
+        // Colors the surface by a scalar channel through a colormap (M/N keys, F3 panel).
+        // Colormap and range changes are uniforms; the first channel enabled resamples once.
+        void setColorMapping(const ColorMapping& mapping);
+        const ColorMapping& getColorMapping() const { return _colorMapping; }
+        // Polls input before building a frame instead of after drawing it, takes the camera as
+        // late as possible before the scene is drawn and lets the driver queue at most
+        // `maxQueuedFrames` frames (0: no limit). Input to present latency is measured either
+        // way and shows in the F2 panel and the stats dump. Call before run().
+        void setLowLatency(bool enabled, int maxQueuedFrames = 1);
+        bool isLowLatency() const { return _lowLatency; }
+        // Scene resolution scale, MSAA and upscale sharpness (F2 panel). Out of range values
+        // are clamped; headless runs start at a fixed full scale so their output is repeatable.
+        void setResolutionSettings(const ResolutionSettings& settings);
+        const ResolutionSettings& getResolutionSettings() const { return _resolutionSettings; }
+        // Aborts (naming the scope) if a steady-state frame allocates; needs GRAPHISQUE_TRACK_ALLOCATIONS
+        void setAssertNoAllocations(bool enabled) { _assertNoAllocations = enabled; }
+        // Appends render counters to a CSV (".csv") or JSON-lines file every `interval` frames
+        bool setStatsDump(const std::string& path, unsigned interval = 60) { return RenderStats::instance().setDumpFile(path, interval); }
+
+        // Request a redraw; safe to call from any thread, wakes the event loop
+        void markDirty();
         
 
         //update projection matrix
@@ -74,12 +269,24 @@ class Application {
         void updateViewMatrix() const ;
         void processCameraMovement(float deltaTime);
 
+        //resample the equation and upload it in the background
+        void requestEquationRebuild();
+        void processCompletedUploads();
+        void scheduleChunkedUpload(SampleGrid&& grid);
+
 
 
      
 
 
 
+        //input handlers; the GLFW callbacks forward here after recording the event
+        void onKey(int key, int action, int mods);
+        // F9-F12; live input only, never recorded or replayed. False for any other key.
+        bool onCaptureKey(int key);
+        void onCursorPos(double xPos, double yPos);
+        void onMouseButton(int button, int action, int mods, double xPos, double yPos);
+
         //callback functions 
         static void framebuffer_size_callback(GLFWwindow* window, int width, int height) ;
         static void cursor_pos_callback(GLFWwindow* window, double xPosIn, double yPosIn) ;
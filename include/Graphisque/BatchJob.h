@@ -0,0 +1,35 @@
+#ifndef BATCH_JOB_H
+#define BATCH_JOB_H
+
+#include <string>
+#include <vector>
+#include "SampleGrid.h"
+
+
+// One plot of a batch run.
+//
+// Job files have one job per line as key=value pairs; values containing spaces are
+// double quoted, '#' starts a comment line, and a line starting with "defaults" sets
+// the values later jobs start from:
+//
+//   defaults size=256x256 step=0.1
+//   expr="sin(x) * cos(y)" out=thumbs/wave.png
+//   expr="x^2 - y^2" domain=-2,2,-2,2 camera=30,25,12 size=512x512
+//
+// Keys: expr (required), out (default plot_<index>.png), domain=xMin,xMax,yMin,yMax,
+// step, size=WIDTHxHEIGHT, camera=yaw,pitch,distance (degrees, orbit around the origin).
+struct BatchJob {
+    std::string expression;
+    std::string output;
+    SampleDomain domain;
+    int width = 256;
+    int height = 256;
+    float yaw = 45.0f;
+    float pitch = 35.26f;
+    float distance = 34.64f; // matches the interactive view's starting position
+};
+
+// Throws std::runtime_error naming the file and line on malformed input
+std::vector<BatchJob> loadBatchJobs(const std::string& path);
+
+#endif // BATCH_JOB_H
@@ -0,0 +1,71 @@
+#ifndef BATCH_RENDERER_H
+#define BATCH_RENDERER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Axes.h"
+#include "BatchJob.h"
+#include "Buffer.h"
+#include "Equations.h"
+#include "FrameCapture.h"
+#include "GLFramebuffer.h"
+#include "HeadlessContext.h"
+#include "JobSystem.h"
+#include "Shader.h"
+#include "ShaderVariants.h"
+
+
+struct BatchResult {
+    size_t rendered = 0;
+    size_t failed = 0;
+    double seconds = 0.0;
+
+    double plotsPerSecond() const { return seconds > 0.0 ? static_cast<double>(rendered) / seconds : 0.0; }
+};
+
+
+// Renders a list of BatchJobs to PNG files without a window.
+//
+// The run is a three stage pipeline: while the GL thread (the caller) draws job N, job
+// N+1 is already being sampled on the job system. Job N is read back through a lossless
+// FrameCapture session, so the readback lands in its PBO ring without a stall and is
+// encoded to PNG on the capture's encoder threads a few jobs later. Every job draws into
+// the same mesh buffer, grown only when a job needs more room.
+class BatchRenderer {
+    private:
+        HeadlessContext _context;
+        std::unique_ptr<JobSystem> _jobs;
+        ShaderVariants _shaderVariants;
+        std::shared_ptr<Shader> _shader;
+        std::unique_ptr<Axes> _axes;
+        std::unique_ptr<VertexBuffer> _mesh;
+        std::unique_ptr<VerteXArray> _meshArray;
+        std::unique_ptr<GLFramebuffer> _target;
+        std::unique_ptr<FrameCapture> _capture;
+
+        struct SampledJob {
+            std::shared_ptr<SampleGrid> grid;
+            JobHandle done;
+            std::string error; // set when the job cannot be rendered
+        };
+
+        SampledJob startSampling(const BatchJob& job);
+        bool renderJob(const BatchJob& job, const SampleGrid& grid);
+
+    public:
+        // workers == 0 picks the job system's default
+        explicit BatchRenderer(unsigned workers = 0);
+        ~BatchRenderer();
+
+        BatchRenderer(const BatchRenderer&) = delete;
+        BatchRenderer& operator=(const BatchRenderer&) = delete;
+
+        // Creates the headless context and the scene objects on the calling thread,
+        // which has to be the one calling run()
+        bool init();
+        BatchResult run(const std::vector<BatchJob>& jobs);
+};
+
+#endif // BATCH_RENDERER_H
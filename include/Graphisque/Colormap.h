@@ -0,0 +1,58 @@
+#ifndef COLORMAP_H
+#define COLORMAP_H
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <string>
+#include <glm/glm.hpp>
+
+#include "SampleGrid.h"
+
+
+enum class Colormap : uint32_t {
+    Viridis,   // perceptually uniform, the default
+    Coolwarm,  // diverging, for signed channels like curvature
+    Grayscale
+};
+static constexpr size_t COLORMAP_COUNT = 3;
+
+const char* colormapName(Colormap colormap);
+const char* scalarChannelName(ScalarChannel channel);
+// Lowercase names as printed above; false for anything else
+bool parseColormap(const std::string& name, Colormap& colormap);
+bool parseScalarChannel(const std::string& name, ScalarChannel& channel);
+
+// RGB of the colormap at t in [0, 1]; the texture is built from this
+glm::vec3 sampleColormap(Colormap colormap, float t);
+
+
+// What the surface is colored by. Scene state, handed to the render thread in FrameSnapshot.
+struct ColorMapping {
+    bool enabled = false; // flat objectColor otherwise
+    ScalarChannel channel = ScalarChannel::Height;
+    Colormap colormap = Colormap::Viridis;
+    bool autoRange = true;               // the channel's min/max from the last sampled grid
+    ScalarRange range = {0.0f, 1.0f};    // maps to the ends of the colormap unless autoRange
+};
+
+
+// Every colormap as one layer of a GL_TEXTURE_1D_ARRAY, so switching colormaps or ranges
+// while drawing is a uniform change. GL thread only.
+class ColormapTexture {
+    public:
+        static constexpr int WIDTH = 256;
+
+        // Throws std::runtime_error when the texture can't be created
+        ColormapTexture();
+        ~ColormapTexture();
+        ColormapTexture(const ColormapTexture&) = delete;
+        ColormapTexture& operator=(const ColormapTexture&) = delete;
+
+        void bind(GLuint unit) const;
+        GLuint getId() const { return _texture; }
+
+    private:
+        GLuint _texture = 0;
+};
+
+#endif // COLORMAP_H
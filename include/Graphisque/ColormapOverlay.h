@@ -0,0 +1,23 @@
+#ifndef COLORMAP_OVERLAY_H
+#define COLORMAP_OVERLAY_H
+
+#include "Colormap.h"
+
+
+// ImGui window for what the surface is colored by: channel, colormap and range.
+// Main/UI thread only.
+class ColormapOverlay {
+    private:
+        bool _visible = false;
+
+    public:
+        void toggle() { _visible = !_visible; }
+        bool isVisible() const { return _visible; }
+
+        // Call between UiLayer::beginFrame and UiLayer::endFrame. Edits `mapping` in place and
+        // returns whether it changed; `shownRange` is the range the last frame mapped, shown
+        // for the auto range and taken over when switching to a fixed one.
+        bool draw(ColorMapping& mapping, const ScalarRange& shownRange);
+};
+
+#endif // COLORMAP_OVERLAY_H
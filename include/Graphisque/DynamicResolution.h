@@ -0,0 +1,102 @@
+#ifndef DYNAMIC_RESOLUTION_H
+#define DYNAMIC_RESOLUTION_H
+
+#include <glad/glad.h>
+#include <atomic>
+#include <memory>
+
+#include "GLVertexArray.h"
+#include "Shader.h"
+#include "ShaderVariants.h"
+
+
+// Runtime settings of the scene target. Main thread state, handed over in FrameSnapshot.
+struct ResolutionSettings {
+    bool dynamic = true;     // adjust the scale to hold targetMs; otherwise always draw at `scale`
+    float scale = 1.0f;      // fixed scale, and where dynamic scaling starts
+    float minScale = 0.5f;
+    float maxScale = 1.0f;
+    float targetMs = 12.0f;  // GPU time of the scene and the composite, the UI not included
+    int samples = 4;         // MSAA samples of the scene target, 0 for none
+    float sharpness = 0.5f;  // of the upscale, 0..1; nothing to sharpen at full scale
+
+    bool operator==(const ResolutionSettings& other) const {
+        return dynamic == other.dynamic && scale == other.scale && minScale == other.minScale &&
+               maxScale == other.maxScale && targetMs == other.targetMs && samples == other.samples &&
+               sharpness == other.sharpness;
+    }
+    bool operator!=(const ResolutionSettings& other) const { return !(*this == other); }
+};
+
+
+// Draws the scene at a fraction of the window resolution and composites it to the frame
+// target with a sharpening upscale, so the UI on top stays at native resolution.
+//
+// The scene's GPU time is measured with timestamp queries (read back FRAME_LATENCY frames
+// later, never waited on) and the scale follows it: pixel cost goes with scale squared, so
+// a frame over the target shrinks by sqrt(target / measured). Storage is allocated for the
+// largest scale and the scene drawn into its lower left part, so a new scale is only a new
+// viewport. MSAA samples are resolved before the upscale.
+//
+// GL thread only, except scale() and gpuMs() which the UI may read from any thread.
+class DynamicResolution {
+    public:
+        static constexpr int FRAME_LATENCY = 4;
+
+        DynamicResolution() = default;
+        DynamicResolution(const DynamicResolution&) = delete;
+        DynamicResolution& operator=(const DynamicResolution&) = delete;
+
+        // Binds the scene target for a width x height frame, sets its viewport and clears it.
+        // False if the target can't be made; the caller then draws straight into the frame.
+        bool begin(int width, int height, const ResolutionSettings& settings, ShaderVariants& variants);
+        // Resolves and upscales into `target` (0 for the window), which is left bound with a
+        // full size viewport
+        void composite(GLuint target);
+
+        float scale() const { return _scale.load(std::memory_order_relaxed); }
+        // Smoothed GPU time of the scene and composite, 0 until measured
+        float gpuMs() const { return _gpuMs.load(std::memory_order_relaxed); }
+        // Samples actually in use (clamped to GL_MAX_SAMPLES)
+        int samples() const { return _samples; }
+
+        // Deletes the GL objects; the context must still be current
+        void release();
+
+    private:
+        bool allocate(int width, int height, int samples);
+        void releaseTargets();
+        void readTimings(const ResolutionSettings& settings);
+        void adjust(float measuredMs, const ResolutionSettings& settings);
+
+        //scene target: multisampled renderbuffers resolved into _resolveTexture, or with
+        //0 samples the texture itself
+        GLuint _sceneFramebuffer = 0;
+        GLuint _sceneColor = 0;
+        GLuint _sceneDepth = 0;
+        GLuint _resolveFramebuffer = 0;
+        GLuint _resolveTexture = 0;
+        int _allocatedWidth = 0, _allocatedHeight = 0;
+        int _samples = 0;
+        int _requestedSamples = -1;
+        int _failedSamples = -1; // an incomplete target isn't retried until the samples change
+        bool _failed = false;    // no composite shader, never retried
+
+        int _frameWidth = 0, _frameHeight = 0; // target size
+        int _drawWidth = 0, _drawHeight = 0;   // scaled size of this frame
+        float _sharpness = 0.0f;
+
+        std::shared_ptr<Shader> _compositeShader;
+        std::unique_ptr<GLVertexArray> _emptyVertexArray; // the full screen triangle has no attributes
+
+        //timestamp pair per frame in flight
+        GLuint _queries[FRAME_LATENCY][2] = {};
+        bool _issued[FRAME_LATENCY] = {};
+        int _frame = 0;
+        int _cooldown = 0;          // measurements still from before the last scale change
+        float _smoothedMs = 0.0f;
+        std::atomic<float> _scale{1.0f};
+        std::atomic<float> _gpuMs{0.0f};
+};
+
+#endif // DYNAMIC_RESOLUTION_H
@@ -4,9 +4,17 @@
 #ifndef EQUATIONS_H
 #define EQUATIONS_H
 
+#include <array>
 #include <cmath>
+#include <functional>
 #include<vector>
 #include "Shader.h"
+#include "Buffer.h"
+#include "SampleGrid.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include "HardwareCounters.h"
+#include "ResidencyManager.h"
 
 
 inline float f (float x, float y) {
@@ -17,40 +25,242 @@ inline float sphereEqn(float x, float y) {
     return sqrt(25 - x*x - y*y);
 }
 
+using SurfaceFunction = std::function<float(float, float)>;
+
 const float lim = 5.0f;
+// rows of the grid sampled per job; also the granularity at which a stale rebuild notices it was cancelled
+const size_t SAMPLE_TILE_ROWS = 16;
+
 class Equation {
-    std::vector<glm::vec3> graphPoints;
-    float xMin = -lim;
-    float xMax = lim;
-    float yMin = -lim;
-    float yMax = lim;
-    float step  = 0.25f;
+    std::vector<glm::vec3> graphPoints; // CPU copy of the displayed samples, only kept while pinned
+    size_t _vertexCount = 0;
+    SurfaceFunction _function = f;
+    SampleDomain _domain = {-lim, lim, -lim, lim, 0.25f};
+    uint64_t _generation = 0;
+    bool _showingFinal = true; // the displayed grid is the full resolution result of _generation
     std::unique_ptr<VertexBuffer> _vbo;
     std::unique_ptr<VerteXArray> _vao;
     glm::vec3 color = glm::vec3(0.4f, 0.1f, 0.6f);
 
+    uint32_t _channels = 0;     // scalar channels computed by the next rebuild
+    uint32_t _meshChannels = 0; // scalar channels in _vbo, after the points
+    std::array<size_t, SCALAR_CHANNEL_COUNT> _channelOffsets{};
+    ScalarRanges _ranges;
+    ScalarChannel _shownChannel = ScalarChannel::Height; // what attribute 1 points at
+
+    ResidencyId _residency = 0;
+    std::function<void()> _regenerate; // brings back an evicted mesh; synchronous resample when unset
+    bool _regenerating = false; // a rebuild for the evicted mesh is under way, until it lands or is lost
+    bool _evicted = false; // a fresh equation has no mesh yet either, but isn't regenerated on draw
+
+    // Residency eviction; the next draw regenerates the mesh
+    void evictMesh() {
+        _evicted = true;
+        _vao.reset();
+        _vbo.reset();
+        _vertexCount = 0;
+        _meshChannels = 0;
+        ResidencyManager::instance().setGpuBytes(_residency, 0);
+    }
+
+    // Positions in attribute 0 and, if the buffer has it, the shown channel in attribute 1.
+    // Both come from the one buffer, so showing another channel only changes an offset.
+    std::unique_ptr<VerteXArray> makeVertexArray(VertexBuffer& vbo) const {
+        auto vao = std::make_unique<VerteXArray>();
+        vao->addVertexBuffer(vbo, 0, 3, GL_FLOAT);
+        if (_meshChannels & channelBit(_shownChannel)) {
+            size_t offset = _channelOffsets[static_cast<size_t>(_shownChannel)];
+            vao->addVertexBuffer(vbo, 1, 1, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<const void*>(offset));
+        }
+        return vao;
+    }
+
 
 public:
+    // Starts without a mesh; init() or a rebuild whose grid is swapped in builds the first one
     Equation() {
-        _vbo = std::make_unique<VertexBuffer>();
-        _vao = std::make_unique<VerteXArray>();
-        init();
+        _residency = ResidencyManager::instance().registerObject("equation", [this] { evictMesh(); });
     };
+    ~Equation() {
+        ResidencyManager::instance().unregisterObject(_residency);
+    }
+    Equation(const Equation&) = delete;
+    Equation& operator=(const Equation&) = delete;
+
+    // Samples and uploads the first mesh synchronously
     void init() {
-        for (float x = xMin ; x < xMax ; x += step) {
-            for (float y = yMin ; y < yMax ; y += step) {
-                float z = f(x, y);
-                graphPoints.emplace_back(x, z, y);
+        applySampleGrid(sample(_generation));
+    }
+
+    // CPU only; safe to run off the GL thread
+    SampleGrid sample(uint64_t generation) const {
+        SampleGrid grid = sampleSurface(_function, _domain, generation);
+        computeScalarChannels(grid, _channels);
+        return grid;
+    }
+
+    // Samples `domain` as tile jobs; onComplete runs on a worker thread once every tile is done,
+    // unless the token was cancelled first. The returned job finishes after onComplete.
+    // Scalar channels are a second pass of tile jobs, with the auto range reduced per tile.
+    JobHandle scheduleSample(JobSystem& jobs, const SampleDomain& domain, bool preview, JobPriority priority,
+                             const CancellationToken& token, std::function<void(SampleGrid&&)> onComplete) const {
+        auto grid = std::make_shared<SampleGrid>();
+        grid->generation = _generation;
+        grid->preview = preview;
+        grid->domain = domain;
+        grid->points.resize(domain.sampleCount());
+        grid->resizeChannels(_channels);
+
+        SurfaceFunction function = _function;
+        const size_t rows = domain.countX();
+        JobHandle tiles = jobs.parallelFor(rows, SAMPLE_TILE_ROWS,
+            [grid, function](size_t rowBegin, size_t rowEnd) {
+                GRAPHISQUE_PROFILE_SCOPE("Sample tile");
+                GRAPHISQUE_PROFILE_COUNTERS("Sample tile");
+                sampleSurfaceRows(function, *grid, rowBegin, rowEnd);
+            }, priority, token);
+        if (grid->channels == 0) {
+            return jobs.schedule([grid, onComplete] { onComplete(std::move(*grid)); }, priority, token, {tiles});
+        }
+
+        //differences read the neighbouring rows, so this pass waits for every sample tile
+        auto partials = std::make_shared<std::vector<ScalarRanges>>((rows + SAMPLE_TILE_ROWS - 1) / SAMPLE_TILE_ROWS);
+        JobHandle scalars = jobs.parallelFor(rows, SAMPLE_TILE_ROWS,
+            [grid, partials](size_t rowBegin, size_t rowEnd) {
+                GRAPHISQUE_PROFILE_SCOPE("Scalar tile");
+                (*partials)[rowBegin / SAMPLE_TILE_ROWS] = computeScalarRows(*grid, rowBegin, rowEnd);
+            }, priority, token, {tiles});
+        return jobs.schedule([grid, partials, onComplete] {
+            for (const ScalarRanges& partial : *partials) {
+                for (size_t channel = 0; channel < SCALAR_CHANNEL_COUNT; ++channel) {
+                    grid->ranges[channel].merge(partial[channel]);
+                }
+            }
+            onComplete(std::move(*grid));
+        }, priority, token, {scalars});
+    }
+
+    // Starts a new rebuild; results carrying an older generation are stale
+    uint64_t nextGeneration() { 
+        _showingFinal = false;
+        _regenerating = false; // whatever it was waiting for is stale now too
+        return ++_generation;
+    }
+    // A grid of the current rebuild was lost on the way (failed or empty); the next draw of
+    // an evicted mesh asks for it again
+    void gridDropped(uint64_t generation) { 
+        if (generation == _generation) {
+            _regenerating = false;
+        }
+    }
+    uint64_t generation() const { return _generation; }
+    bool isShowingFinal() const { return _showingFinal; }
+
+    // Whether a finished grid should replace what is currently displayed
+    bool accepts(const SampleGrid& grid) const { 
+        return grid.generation == _generation && !(grid.preview && _showingFinal);
+    }
+
+    void setFunction(SurfaceFunction function) { _function = std::move(function); }
+    const SurfaceFunction& getFunction() const { return _function; }
+
+    void setDomain(const SampleDomain& domain) { _domain = domain; }
+    const SampleDomain& getDomain() const { return _domain; }
+
+    // ScalarChannel bits to compute from the next rebuild on; the current mesh keeps its own
+    void setChannels(uint32_t channels) { _channels = channels & ALL_SCALAR_CHANNELS; }
+    uint32_t getChannels() const { return _channels; }
+    // Whether the displayed mesh carries the channel
+    bool hasChannel(ScalarChannel channel) const { return _vao && (_meshChannels & channelBit(channel)); }
+    // Min/max of the channel over the displayed mesh
+    const ScalarRange& channelRange(ScalarChannel channel) const { return _ranges[static_cast<size_t>(channel)]; }
+    // Points attribute 1 at the channel; no upload, the mesh already has every channel it was built with.
+    // False when the displayed mesh doesn't have it.
+    bool showChannel(ScalarChannel channel) {
+        if (!hasChannel(channel)) {
+            return false;
+        }
+        if (channel != _shownChannel) {
+            _shownChannel = channel;
+            _vao->setAttributeOffset(*_vbo, 1, 1, GL_FLOAT, _channelOffsets[static_cast<size_t>(channel)]);
+        }
+        return true;
+    }
+
+    // Swaps in a buffer that was uploaded elsewhere (see UploadWorker). Must run on the GL thread.
+    // The samples are now on the GPU, so the CPU copy is dropped unless pinned.
+    void swapVertexBuffer(std::unique_ptr<VertexBuffer> vbo, SampleGrid&& grid) {
+        _meshChannels = grid.channels;
+        _ranges = grid.ranges;
+        for (size_t channel = 0; channel < SCALAR_CHANNEL_COUNT; ++channel) {
+            _channelOffsets[channel] = grid.pointBytes() + grid.channelStart(static_cast<ScalarChannel>(channel)) * sizeof(float);
+        }
+        _vao = makeVertexArray(*vbo);
+        _vbo = std::move(vbo);
+        _vertexCount = grid.points.size();
+        _showingFinal = !grid.preview;
+        _regenerating = false;
+        _evicted = false;
+
+        ResidencyManager& residency = ResidencyManager::instance();
+        if (residency.isPinned(_residency)) {
+            graphPoints = std::move(grid.points);
+        } else {
+            std::vector<glm::vec3>().swap(graphPoints);
+        }
+        residency.setCpuBytes(_residency, graphPoints.capacity() * sizeof(glm::vec3));
+        residency.setGpuBytes(_residency, _vbo->getSize());
+    }
+
+    // Synchronous path: upload on the calling (GL) thread
+    void applySampleGrid(SampleGrid&& grid) {
+        auto vbo = std::make_unique<VertexBuffer>();
+        uploadSampleGrid(*vbo, grid);
+        swapVertexBuffer(std::move(vbo), std::move(grid));
+    }
+
+    // Keeps the CPU copy of the samples after upload (picking, export). Pinning an equation
+    // whose copy was already dropped regenerates it.
+    void setPinned(bool pinned) {
+        ResidencyManager::instance().setPinned(_residency, pinned);
+        if (!pinned) {
+            std::vector<glm::vec3>().swap(graphPoints);
+            ResidencyManager::instance().setCpuBytes(_residency, 0);
+        } else if (graphPoints.empty()) {
+            regenerate();
+        }
+    }
+    // Empty unless pinned
+    const std::vector<glm::vec3>& points() const { return graphPoints; }
+
+    void setRegenerator(std::function<void()> regenerate) { _regenerate = std::move(regenerate); }
+    bool isResident() const { return _vao != nullptr; }
+
+    void regenerate() {
+        if (_regenerate) {
+            if (!_regenerating) {
+                _regenerate();
+                _regenerating = true; // after: the regenerator starts a new generation
             }
+        } else {
+            applySampleGrid(sample(_generation));
         }
-        _vbo->setData(graphPoints);
-        _vao->addVertexBuffer(*_vbo, 0, 3, GL_FLOAT);
     }
+
     void draw(const std::shared_ptr<Shader>& shader) {
+        if (!_vao) {
+            if (_evicted) {
+                regenerate(); // asynchronous regenerators draw it again once it is back
+            }
+            if (!_vao) {
+                return;
+            }
+        }
+        ResidencyManager::instance().markVisible(_residency);
         shader->setMat4("model", glm::mat4(1.0f));
         shader->setVec3("objectColor", color);
         glPointSize(3.0f);
-        _vao->drawArrays(GL_POINTS, 0, graphPoints.size());
+        _vao->drawArrays(GL_POINTS, 0, _vertexCount);
     }
 
 };
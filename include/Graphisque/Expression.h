@@ -0,0 +1,50 @@
+#ifndef EXPRESSION_H
+#define EXPRESSION_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+// z = f(x, y) typed in as text, e.g. "sin(x) * cos(y) + 0.1 * x^2".
+//
+// Supports + - * / ^ (right associative), unary minus, parentheses, the variables x and y,
+// the constants pi and e, and the functions sin cos tan asin acos atan sinh cosh tanh exp
+// log log10 sqrt abs floor ceil, plus atan2 pow min max with two arguments.
+//
+// The text is compiled once into a flat postfix program; evaluate() walks it with a small
+// fixed stack, so an Expression is cheap to copy into sampling jobs and safe to evaluate
+// from several threads at once. Syntax errors throw std::runtime_error with the position.
+class Expression {
+    public:
+        enum class OpCode : uint8_t {
+            Constant, VariableX, VariableY,
+            Add, Subtract, Multiply, Divide, Power, Negate,
+            Sin, Cos, Tan, Asin, Acos, Atan, Sinh, Cosh, Tanh,
+            Exp, Log, Log10, Sqrt, Abs, Floor, Ceil,
+            Atan2, Pow, Min, Max
+        };
+
+        struct Instruction {
+            OpCode op;
+            float value; // Constant only
+        };
+
+        static constexpr size_t MAX_STACK = 32;
+
+        Expression() = default;
+        explicit Expression(const std::string& source);
+
+        float evaluate(float x, float y) const;
+        float operator()(float x, float y) const { return evaluate(x, y); }
+
+        const std::string& getSource() const { return _source; }
+        const std::vector<Instruction>& getProgram() const { return _program; }
+        bool isValid() const { return !_program.empty(); }
+
+    private:
+        std::string _source;
+        std::vector<Instruction> _program;
+};
+
+#endif // EXPRESSION_H
@@ -0,0 +1,119 @@
+#ifndef FRAME_CAPTURE_H
+#define FRAME_CAPTURE_H
+
+#include <glad/glad.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "GLBuffer.h"
+
+
+enum class CaptureFormat {
+    Png,         // one file per frame; "{}" in the path becomes the frame number, e.g. "shot_{}.png"
+    PpmStream,   // binary PPM frames back to back (ffmpeg -f image2pipe -c:v ppm -i ...)
+    Y4m          // YUV4MPEG2 4:4:4, BT.709 limited range (ffmpeg -i capture.y4m ...)
+};
+
+
+// Captures rendered frames without stalling the render loop.
+//
+// readback() starts an asynchronous glReadPixels into one of a ring of pixel-pack
+// buffers and fences it. poll() maps the buffers whose fence has signalled, a few frames
+// later, copies the pixels out and hands them to encoder threads. If the ring or the
+// encoder queue is full the captured frame is dropped (and counted); the interactive
+// frame never waits. A lossless session (batch renders) waits for room instead.
+//
+// begin()/end() may be called from any thread; readback(), poll() and shutdown() only on
+// the thread that owns the GL context. Frames already in flight when end() is called
+// are still written; the session's file is closed after its last frame.
+class FrameCapture {
+    public:
+        static constexpr size_t RING_SIZE = 4;
+        static constexpr size_t MAX_QUEUED_FRAMES = 8;
+
+        explicit FrameCapture(unsigned encoderThreads = 2);
+        ~FrameCapture();
+
+        FrameCapture(const FrameCapture&) = delete;
+        FrameCapture& operator=(const FrameCapture&) = delete;
+
+        // Starts a session; maxFrames == 0 records until end(). A lossless session never drops
+        // a frame, readback() and poll() wait for the GPU and the encoders instead.
+        bool begin(const std::string& path, CaptureFormat format, int fps = 30, uint64_t maxFrames = 0,
+                   bool lossless = false);
+        void end();
+        bool isActive() const;
+
+        // GL thread: queue a readback of the current read framebuffer. False when there is no
+        // session or the frame was dropped. `path` names this frame's file instead of the
+        // session's pattern (Png sessions).
+        bool readback(int width, int height, const std::string& path = std::string());
+        // GL thread, once per frame: hand finished readbacks to the encoders
+        void poll();
+        // GL thread: waits until every frame read back so far has been written or dropped
+        void flush();
+        // GL thread: waits for outstanding readbacks and releases the buffers
+        void shutdown();
+
+        // .y4m -> Y4m, .ppm -> PpmStream, "-" (stdout) -> Y4m, anything else -> Png
+        static CaptureFormat formatForPath(const std::string& path);
+
+        uint64_t framesCaptured() const { return _captured.load(std::memory_order_relaxed); }
+        uint64_t framesDropped() const { return _dropped.load(std::memory_order_relaxed); }
+
+    private:
+        struct Session;
+
+        struct Slot {
+            std::unique_ptr<GLBuffer> buffer;
+            GLsync fence = nullptr;
+            std::shared_ptr<Session> session;
+            uint64_t frame = 0;
+            int width = 0;
+            int height = 0;
+            std::string path; // empty: from the session
+        };
+
+        struct EncodeTask {
+            std::shared_ptr<Session> session;
+            uint64_t frame = 0;
+            uint64_t sequence = 0;
+            int width = 0;
+            int height = 0;
+            std::string path;
+            std::unique_ptr<std::vector<uint8_t>> pixels;
+        };
+
+        mutable std::mutex _sessionMutex;
+        std::shared_ptr<Session> _session;
+
+        Slot _ring[RING_SIZE];
+        size_t _nextSlot = 0;  // GL thread only
+        size_t _oldestSlot = 0;
+        size_t _slotsInUse = 0;
+
+        std::mutex _queueMutex;
+        std::condition_variable _queueCv;
+        std::condition_variable _roomCv; // an encoder took or finished a task
+        std::deque<EncodeTask> _queue;
+        size_t _encoding = 0;
+        std::vector<std::unique_ptr<std::vector<uint8_t>>> _pixelPool;
+        bool _stopping = false;
+        std::vector<std::thread> _encoders;
+
+        std::atomic<uint64_t> _captured{0};
+        std::atomic<uint64_t> _dropped{0};
+
+        bool mapSlot(Slot& slot);
+        void encoderLoop();
+        void encode(EncodeTask& task);
+};
+
+#endif // FRAME_CAPTURE_H
@@ -0,0 +1,58 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <glad/glad.h>
+#include <atomic>
+
+
+// Bounds how many frames the driver may queue and measures input to present latency.
+//
+// endFrame() goes right after SwapBuffers. With a limit set it fences the frame and waits
+// until no more than that many frames are still queued, so the next frame samples its
+// input close to when it will be shown instead of behind a queue of older frames.
+//
+// Frames that show new input also get a timestamp query behind the swap. Its result, read
+// back a few frames later and never waited on, is when the GPU was done with the frame;
+// moved to the CPU clock with a GL_TIMESTAMP/CPU time pair taken when it was issued, minus
+// the time the input arrived, that is the latency. It goes to RenderStats.
+//
+// GL thread only, except setMaxQueuedFrames().
+class FramePacer {
+    public:
+        static constexpr int MAX_QUEUED_FRAMES = 3;
+
+        FramePacer() = default;
+        FramePacer(const FramePacer&) = delete;
+        FramePacer& operator=(const FramePacer&) = delete;
+
+        // 0 lets the driver queue as many frames as it likes
+        void setMaxQueuedFrames(int frames);
+        int maxQueuedFrames() const { return _maxQueued.load(std::memory_order_relaxed); }
+
+        // `inputTime` is when the oldest input the frame shows arrived (0 for none) and `now`
+        // the current time, both in seconds on the same clock
+        void endFrame(double inputTime, double now);
+
+        // Deletes the GL objects; the context must still be current
+        void release();
+
+    private:
+        static constexpr int SLOT_COUNT = MAX_QUEUED_FRAMES + 1;
+
+        struct Slot {
+            GLsync fence = nullptr;
+            GLuint query = 0;
+            double inputTime = 0.0; // 0 while there is nothing to measure
+            double cpuTime = 0.0;   // the CPU and GPU clocks when the query was issued
+            GLint64 gpuTime = 0;
+        };
+
+        void readLatency(Slot& slot);
+
+        Slot _slots[SLOT_COUNT];
+        int _next = 0;
+        std::atomic<int> _maxQueued{0};
+        double _smoothedMs = 0.0;
+};
+
+#endif // FRAME_PACER_H
@@ -0,0 +1,55 @@
+#ifndef FRAME_SCHEDULER_H
+#define FRAME_SCHEDULER_H
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+
+
+enum class TaskStatus {
+    Continue, // more slices left, call again
+    Done
+};
+
+// One call = one small slice of work. The task keeps its own progress between calls.
+using ResumableTask = std::function<TaskStatus()>;
+
+
+// Runs resumable tasks on the thread that owns the GL context, but only until a
+// per-frame time budget is spent; unfinished work resumes on the next frame.
+// Tasks start in FIFO order and take turns a slice at a time; every frame makes progress
+// on at least one slice.
+class FrameScheduler {
+    private:
+        struct Entry {
+            std::string name;
+            ResumableTask task;
+        };
+
+        std::deque<Entry> _tasks;    // frame thread only
+        std::deque<Entry> _incoming; // guarded by _incomingMutex, any thread may enqueue
+        std::mutex _incomingMutex;
+        std::atomic<size_t> _pending{0}; // queued and unfinished tasks, readable from any thread
+        double _budgetMs;
+        double _lastFrameMs = 0.0;
+
+    public:
+        explicit FrameScheduler(double budgetMs = 2.0) : _budgetMs(budgetMs) {}
+
+        void enqueue(std::string name, ResumableTask task);
+
+        // Runs slices until the budget is spent or nothing is left. Returns the number of slices run.
+        size_t runFrame();
+
+        void setBudget(double budgetMs) { _budgetMs = budgetMs; }
+        double getBudget() const { return _budgetMs; }
+        double lastFrameTime() const { return _lastFrameMs; }
+
+        // Any thread
+        size_t pending() const { return _pending.load(std::memory_order_acquire); }
+        bool idle() const { return pending() == 0; }
+};
+
+#endif // FRAME_SCHEDULER_H
@@ -0,0 +1,53 @@
+#ifndef FRAME_SNAPSHOT_H
+#define FRAME_SNAPSHOT_H
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "SampleGrid.h"
+#include "Colormap.h"
+#include "DynamicResolution.h"
+#include "UiLayer.h"
+
+
+// Everything the render thread may draw
+enum class DrawTarget {
+    Axes,
+    Equation
+};
+
+struct DrawCommand {
+    DrawTarget target;
+};
+
+
+// Immutable view of the scene produced by the main thread once per tick.
+// The render thread only ever reads it, so nothing in here may point back into
+// main thread state.
+struct FrameSnapshot {
+    uint64_t frameIndex = 0;
+    double time = 0.0;
+
+    int framebufferWidth = 0;
+    int framebufferHeight = 0;
+
+    glm::mat4 view = glm::mat4(1.0f);
+    glm::mat4 projection = glm::mat4(1.0f);
+    // Low latency mode: the render side replaces `view`, `projection` and the framebuffer size
+    // with the newest camera right before drawing, see Application::latchCamera
+    bool lowLatency = false;
+    double inputTime = 0.0; // when the oldest input this frame shows arrived, 0 for none
+
+    // Scene state: the render thread rebuilds the surface when this differs from what it shows
+    SampleDomain equationDomain;
+    ColorMapping colorMapping;
+    ResolutionSettings resolution;
+
+    std::vector<DrawCommand> drawList;
+
+    // ImGui output built on the main thread, drawn on top of the scene
+    UiDrawData ui;
+};
+
+#endif // FRAME_SNAPSHOT_H
@@ -4,6 +4,8 @@
 #include <stdexcept>
 #include <iostream>
 #include <string>
+#include "RenderStats.h"
+#include "GLResourceManager.h"
 
 
 
@@ -11,6 +13,7 @@
 class GLBuffer {
     private:
         GLuint m_bufferId;
+        GLHandle m_handle; // the name is pooled by GLResourceManager
         GLenum m_target; // Target can be GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER, etc.
         GLenum m_usage; // Usage can be GL_STATIC_DRAW, GL_DYNAMIC_DRAW, etc.
         size_t m_size;
@@ -18,15 +21,18 @@ class GLBuffer {
     public:
         GLBuffer(GLenum target = GL_ARRAY_BUFFER, GLenum usage = GL_STATIC_DRAW)
             :m_bufferId(0),  m_target(target), m_usage(usage), m_size(0), m_initialized(false) {
-            glGenBuffers(1, &m_bufferId);
+            m_handle = GLResourceManager::instance().create(GLResourceType::Buffer, m_bufferId);
             if (m_bufferId == 0) {
                 throw std::runtime_error("Failed to generate OpenGL buffer");
             }
+            RenderStats::bufferAllocated(0, 1);
         }
 
+        //deletion is deferred to the GL thread, so a buffer may be destroyed on any thread
         ~GLBuffer() {
             if(m_bufferId != 0) {
-                glDeleteBuffers(1, &m_bufferId);
+                GLResourceManager::instance().release(m_handle);
+                RenderStats::bufferAllocated(-static_cast<int64_t>(m_size), -1);
             }
         }
 
@@ -36,9 +42,10 @@ class GLBuffer {
         //and the old object is left in a valid but unspecified state
 
         GLBuffer(GLBuffer&& other) noexcept
-            : m_bufferId(other.m_bufferId), m_target(other.m_target), m_usage(other.m_usage),
+            : m_bufferId(other.m_bufferId), m_handle(other.m_handle), m_target(other.m_target), m_usage(other.m_usage),
               m_size(other.m_size), m_initialized(other.m_initialized) {
             other.m_bufferId = 0;
+            other.m_handle = GLHandle();
             other.m_size =  0;
             other.m_initialized  = false;
         }
@@ -46,15 +53,18 @@ class GLBuffer {
         GLBuffer& operator=(GLBuffer&& other) noexcept {
             if (this != &other) {
                 if (m_bufferId != 0) {
-                    glDeleteBuffers(1, &m_bufferId);
+                    GLResourceManager::instance().release(m_handle);
+                    RenderStats::bufferAllocated(-static_cast<int64_t>(m_size), -1);
                 }
                 m_bufferId = other.m_bufferId;
+                m_handle = other.m_handle;
                 m_target = other.m_target;
                 m_usage = other.m_usage;
                 m_size = other.m_size;
                 m_initialized = other.m_initialized;
 
                 other.m_bufferId = 0;
+                other.m_handle = GLHandle();
                 other.m_size = 0;
                 other.m_initialized = false;
             }
@@ -71,6 +81,7 @@ class GLBuffer {
                 throw std::runtime_error("Buffer not initialized");
             }
             glBindBuffer(m_target, m_bufferId); 
+            RenderStats::add(RenderStats::Counter::BufferBinds);
         }
 
         void unbind() const { 
@@ -89,8 +100,11 @@ class GLBuffer {
         void setData(const void* data, size_t size){ 
             bind();
             glBufferData(m_target, size, data, m_usage);
+            RenderStats::bufferAllocated(static_cast<int64_t>(size) - static_cast<int64_t>(m_size));
+            RenderStats::add(RenderStats::Counter::BytesUploaded, size);
             m_size = size;
             m_initialized = true;
+            GLResourceManager::instance().setSize(m_handle, size);
 
             GLenum error = glGetError();
             if(error != GL_NO_ERROR) {
@@ -117,6 +131,7 @@ class GLBuffer {
             }
             bind();
             glBufferSubData(m_target, offset, size, data);
+            RenderStats::add(RenderStats::Counter::BytesUploaded, size);
 
             GLenum error = glGetError();
             if(error != GL_NO_ERROR) {
@@ -130,8 +145,10 @@ class GLBuffer {
         void resize(size_t newSize) { 
             bind();
             glBufferData(m_target, newSize, nullptr, m_usage);
+            RenderStats::bufferAllocated(static_cast<int64_t>(newSize) - static_cast<int64_t>(m_size));
             m_size = newSize;
             m_initialized= true;
+            GLResourceManager::instance().setSize(m_handle, newSize);
         }
 
         // Map buffer for direct access (OpenGL 1.5+)
@@ -172,6 +189,7 @@ class GLBuffer {
 
     //Getters
     GLuint getID() const { return m_bufferId; }
+    GLHandle getHandle() const { return m_handle; }
     GLenum getTarget() const { return m_target; }
     GLenum getUsage() const { return m_usage; }
     size_t getSize() const { return m_size; }
@@ -206,6 +224,7 @@ class GLBuffer {
         glBindBuffer(GL_COPY_READ_BUFFER, source.getID());
         glBindBuffer(GL_COPY_WRITE_BUFFER, m_bufferId);
         glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, readOffset, writeOffset, size);
+        RenderStats::add(RenderStats::Counter::BufferBinds, 2);
     }
 
 
@@ -0,0 +1,121 @@
+#ifndef GL_FRAMEBUFFER_H
+#define GL_FRAMEBUFFER_H
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+// Offscreen render target: RGBA8 colour and 24/8 depth-stencil renderbuffers.
+// Used by the headless path in place of a window's default framebuffer.
+class GLFramebuffer {
+    private:
+        GLuint m_framebufferId;
+        GLuint m_colorId;
+        GLuint m_depthId;
+        int m_width;
+        int m_height;
+
+        void release() {
+            if (m_depthId != 0) {
+                glDeleteRenderbuffers(1, &m_depthId);
+            }
+            if (m_colorId != 0) {
+                glDeleteRenderbuffers(1, &m_colorId);
+            }
+            if (m_framebufferId != 0) {
+                glDeleteFramebuffers(1, &m_framebufferId);
+            }
+            m_framebufferId = m_colorId = m_depthId = 0;
+        }
+
+    public:
+        GLFramebuffer(int width, int height)
+            : m_framebufferId(0), m_colorId(0), m_depthId(0), m_width(0), m_height(0) {
+            glGenFramebuffers(1, &m_framebufferId);
+            glGenRenderbuffers(1, &m_colorId);
+            glGenRenderbuffers(1, &m_depthId);
+            if (m_framebufferId == 0 || m_colorId == 0 || m_depthId == 0) {
+                release();
+                throw std::runtime_error("Failed to generate framebuffer objects");
+            }
+            resize(width, height);
+        }
+
+        ~GLFramebuffer() {
+            release();
+        }
+
+        GLFramebuffer(GLFramebuffer&& other) noexcept
+            : m_framebufferId(other.m_framebufferId), m_colorId(other.m_colorId), m_depthId(other.m_depthId),
+              m_width(other.m_width), m_height(other.m_height) {
+            other.m_framebufferId = other.m_colorId = other.m_depthId = 0;
+        }
+
+        GLFramebuffer& operator=(GLFramebuffer&& other) noexcept {
+            if (this != &other) {
+                release();
+                m_framebufferId = other.m_framebufferId;
+                m_colorId = other.m_colorId;
+                m_depthId = other.m_depthId;
+                m_width = other.m_width;
+                m_height = other.m_height;
+                other.m_framebufferId = other.m_colorId = other.m_depthId = 0;
+            }
+            return *this;
+        }
+
+        GLFramebuffer(const GLFramebuffer&) = delete;
+        GLFramebuffer& operator=(const GLFramebuffer&) = delete;
+
+        // Reallocates the attachments; contents are lost
+        void resize(int width, int height) {
+            if (width <= 0 || height <= 0) {
+                throw std::runtime_error("Framebuffer size must be positive");
+            }
+            glBindRenderbuffer(GL_RENDERBUFFER, m_colorId);
+            glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+            glBindRenderbuffer(GL_RENDERBUFFER, m_depthId);
+            glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+            glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+            glBindFramebuffer(GL_FRAMEBUFFER, m_framebufferId);
+            glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_colorId);
+            glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_depthId);
+            GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+            if (status != GL_FRAMEBUFFER_COMPLETE) {
+                throw std::runtime_error("Framebuffer incomplete: " + std::to_string(status));
+            }
+            m_width = width;
+            m_height = height;
+        }
+
+        void bind() const {
+            glBindFramebuffer(GL_FRAMEBUFFER, m_framebufferId);
+        }
+
+        void unbind() const {
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        }
+
+        // Synchronous RGBA8 readback, rows bottom to top (OpenGL order)
+        void readPixels(std::vector<uint8_t>& rgba) const {
+            rgba.resize(static_cast<size_t>(m_width) * m_height * 4);
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebufferId);
+            glPixelStorei(GL_PACK_ALIGNMENT, 1);
+            glReadPixels(0, 0, m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+
+            GLenum error = glGetError();
+            if (error != GL_NO_ERROR) {
+                throw std::runtime_error("OpenGL error during readPixels: " + std::to_string(error));
+            }
+        }
+
+        GLuint getId() const { return m_framebufferId; }
+        int getWidth() const { return m_width; }
+        int getHeight() const { return m_height; }
+};
+
+#endif // GL_FRAMEBUFFER_H
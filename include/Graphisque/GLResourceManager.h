@@ -0,0 +1,123 @@
+#ifndef GL_RESOURCE_MANAGER_H
+#define GL_RESOURCE_MANAGER_H
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+
+enum class GLResourceType : uint8_t {
+    Buffer,
+    VertexArray
+};
+
+// Refers to a buffer or VAO owned by GLResourceManager. A handle whose object was released
+// resolves to 0 instead of to whatever object reuses the slot or the GL name.
+struct GLHandle {
+    uint32_t index = 0; // slot + 1, 0 is the null handle
+    uint32_t generation = 0;
+
+    explicit operator bool() const { return index != 0; }
+    bool operator==(const GLHandle& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const GLHandle& other) const { return !(*this == other); }
+};
+
+
+// Owns every buffer and vertex array name GLBuffer and GLVertexArray use.
+//
+// Released objects are not deleted right away: release() only queues the name, from any
+// thread and without touching GL, and processDeletions() on the GL thread resets it and
+// puts it back into a pool that create() hands out again. Rebuilding meshes over and over
+// then reuses the same few names instead of making the driver create and destroy objects.
+//
+// Buffer names are shared with the upload context, so buffers may be created on any thread
+// with a shared context current. A recycled buffer is orphaned on the GL thread, and the
+// other context must not write the name before that orphan is done, so the names are
+// fenced and only go back into the pool once the fence has signalled. VAOs aren't shared
+// between contexts; create them on the GL thread only.
+class GLResourceManager {
+    public:
+        struct Stats {
+            size_t liveBuffers = 0;
+            size_t liveVertexArrays = 0;
+            size_t pooledBuffers = 0;
+            size_t pooledVertexArrays = 0;
+            size_t pendingDeletes = 0; // includes buffers waiting on their orphan fence
+            uint64_t namesGenerated = 0;
+            uint64_t namesRecycled = 0;
+        };
+
+        static GLResourceManager& instance();
+
+        // Takes a pooled name or generates one; `name` is 0 (and the handle null) if GL fails
+        GLHandle create(GLResourceType type, GLuint& name);
+        // Any thread; the handle goes stale immediately, the name on the next processDeletions()
+        void release(GLHandle handle);
+
+        // 0 once released
+        GLuint name(GLHandle handle) const;
+        bool isAlive(GLHandle handle) const;
+        // Data store size in bytes, kept up to date by GLBuffer
+        void setSize(GLHandle handle, size_t bytes);
+        size_t size(GLHandle handle) const;
+
+        // GL thread, once per frame; returns the number of names recycled or deleted
+        size_t processDeletions();
+        // GL thread, before the context goes away. Deletes everything pooled or pending;
+        // releases after this are dropped.
+        void shutdown();
+
+        // Names kept per type; anything released beyond that is deleted
+        void setPoolLimit(size_t names);
+
+        Stats stats() const;
+
+    private:
+        struct Slot {
+            GLuint name = 0;
+            size_t size = 0;
+            uint32_t generation = 0;
+            GLResourceType type = GLResourceType::Buffer;
+            bool alive = false;
+        };
+
+        struct PendingDelete {
+            GLuint name;
+            GLResourceType type;
+        };
+
+        // Orphaned buffer names waiting for the GL thread's orphan to finish on the GPU
+        struct RetiringBuffers {
+            GLsync fence = nullptr;
+            std::vector<GLuint> names;
+        };
+        static constexpr size_t RETIRING_BATCHES = 4;
+
+        GLResourceManager();
+        Slot* find(GLHandle handle);
+        const Slot* find(GLHandle handle) const;
+        void deleteNames(GLResourceType type, const std::vector<GLuint>& names);
+        void reclaimRetired();
+
+        mutable std::mutex _mutex;
+        std::vector<Slot> _slots; // indexed by handle.index - 1
+        std::vector<uint32_t> _freeSlots;
+        std::vector<PendingDelete> _pending;
+        std::vector<PendingDelete> _processing; // swapped with _pending, keeps both capacities
+        std::vector<GLuint> _bufferPool;
+        std::vector<GLuint> _vertexArrayPool;
+        RetiringBuffers _retiring[RETIRING_BATCHES]; // a ring, GL thread only
+        size_t _retiringHead = 0; // oldest batch
+        size_t _retiringBatches = 0;
+        size_t _retiringNames = 0; // under _mutex, counts against the pool limit
+        size_t _poolLimit = 1024;
+        size_t _liveBuffers = 0;
+        size_t _liveVertexArrays = 0;
+        uint64_t _namesGenerated = 0;
+        uint64_t _namesRecycled = 0;
+        bool _shutDown = false;
+};
+
+#endif // GL_RESOURCE_MANAGER_H
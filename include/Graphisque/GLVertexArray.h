@@ -7,19 +7,23 @@
 #include <stdexcept>
 #include <string>
 #include "GLBuffer.h"
+#include "RenderStats.h"
+#include "GLResourceManager.h"
 
 
 class GLVertexArray{
 private:
     GLuint vao_id;
-    std::vector<std::reference_wrapper<GLBuffer>> vbo_refs; // Store references to GLBuffers
-    GLBuffer* ebo_ref; // Reference to element buffer
+    GLHandle vao_handle;
+    // Handles rather than references: a buffer destroyed or moved under the VAO is detected, not dangling
+    std::vector<GLHandle> vbo_handles;
+    GLHandle ebo_handle;
     bool is_valid;
     
 public:
-    // Default constructor
-   GLVertexArray() : vao_id(0), ebo_ref(nullptr), is_valid(false) {
-        glGenVertexArrays(1, &vao_id);
+    // Default constructor (GL thread only, VAOs aren't shared with the upload context)
+   GLVertexArray() : vao_id(0), is_valid(false) {
+        vao_handle = GLResourceManager::instance().create(GLResourceType::VertexArray, vao_id);
         if (vao_id == 0) {
             throw std::runtime_error("Failed to generate VAO");
         }
@@ -33,10 +37,11 @@ public:
     
     // Move constructor
     GLVertexArray(GLVertexArray&& other) noexcept 
-        : vao_id(other.vao_id), vbo_refs(std::move(other.vbo_refs)), 
-          ebo_ref(other.ebo_ref), is_valid(other.is_valid) {
+        : vao_id(other.vao_id), vao_handle(other.vao_handle), vbo_handles(std::move(other.vbo_handles)), 
+          ebo_handle(other.ebo_handle), is_valid(other.is_valid) {
         other.vao_id = 0;
-        other.ebo_ref = nullptr;
+        other.vao_handle = GLHandle();
+        other.ebo_handle = GLHandle();
         other.is_valid = false;
     }
     
@@ -45,12 +50,14 @@ public:
         if (this != &other) {
             cleanup();
             vao_id = other.vao_id;
-            vbo_refs = std::move(other.vbo_refs);
-            ebo_ref = other.ebo_ref;
+            vao_handle = other.vao_handle;
+            vbo_handles = std::move(other.vbo_handles);
+            ebo_handle = other.ebo_handle;
             is_valid = other.is_valid;
             
             other.vao_id = 0;
-            other.ebo_ref = nullptr;
+            other.vao_handle = GLHandle();
+            other.ebo_handle = GLHandle();
             other.is_valid = false;
         }
         return *this;
@@ -66,6 +73,7 @@ public:
             throw std::runtime_error("Attempting to bind invalid VAO");
         }
         glBindVertexArray(vao_id);
+        RenderStats::add(RenderStats::Counter::VertexArrayBinds);
     }
     
     // Unbind the GLVertexArray
@@ -118,8 +126,7 @@ public:
         glVertexAttribPointer(index, size, type, normalized, stride, pointer);
         glEnableVertexAttribArray(index);
         
-        // Store reference to the buffer
-        vbo_refs.emplace_back(std::ref(buffer));
+        vbo_handles.push_back(buffer.getHandle());
         
         GLenum error = glGetError();
         if (error != GL_NO_ERROR) {
@@ -156,8 +163,7 @@ public:
             glEnableVertexAttribArray(attr.index);
         }
         
-        // Store reference to the buffer
-        vbo_refs.emplace_back(std::ref(buffer));
+        vbo_handles.push_back(buffer.getHandle());
         
         GLenum error = glGetError();
         if (error != GL_NO_ERROR) {
@@ -182,7 +188,7 @@ public:
         bind();
         buffer.bind();
         
-        ebo_ref = &buffer;
+        ebo_handle = buffer.getHandle();
         
         GLenum error = glGetError();
         if (error != GL_NO_ERROR) {
@@ -190,6 +196,19 @@ public:
         }
     }
     
+    // Points an attribute at another offset of a buffer that was already added, e.g. another
+    // block of a buffer holding several attributes one after the other. Nothing is uploaded.
+    void setAttributeOffset(GLBuffer& buffer, GLuint index, GLint size, GLenum type, size_t offset) {
+        if (!is_valid) {
+            throw std::runtime_error("VAO is not valid");
+        }
+        
+        bind();
+        buffer.bind();
+        glVertexAttribPointer(index, size, type, GL_FALSE, 0, reinterpret_cast<const void*>(offset));
+        glEnableVertexAttribArray(index);
+    }
+    
     // Enable vertex attribute array
     void enableVertexAttribArray(GLuint index) {
         if (!is_valid) {
@@ -215,9 +234,11 @@ public:
         if (!is_valid) {
             throw std::runtime_error("VAO is not valid");
         }
+        checkBuffers();
         
         bind();
         glDrawArrays(mode, first, count);
+        RenderStats::countDraw(mode, count);
         
         GLenum error = glGetError();
         if (error != GL_NO_ERROR) {
@@ -231,12 +252,14 @@ public:
             throw std::runtime_error("VAO is not valid");
         }
         
-        if (!ebo_ref && indices == nullptr) {
+        if (!ebo_handle && indices == nullptr) {
             throw std::runtime_error("No element buffer set and no indices provided");
         }
+        checkBuffers();
         
         bind();
         glDrawElements(mode, count, type, indices);
+        RenderStats::countDraw(mode, count);
         
         GLenum error = glGetError();
         if (error != GL_NO_ERROR) {
@@ -246,13 +269,13 @@ public:
     
     // Draw elements with automatic count calculation
     void drawElements(GLenum mode, GLenum type = GL_UNSIGNED_INT) const {
-        if (!ebo_ref) {
+        if (!ebo_handle) {
             throw std::runtime_error("No element buffer set for automatic draw");
         }
         
         // Calculate count based on buffer size and type
         size_t typeSize = getIndexTypeSize(type);
-        GLsizei count = static_cast<GLsizei>(ebo_ref->getSize() / typeSize);
+        GLsizei count = static_cast<GLsizei>(GLResourceManager::instance().size(ebo_handle) / typeSize);
         
         drawElements(mode, count, type);
     }
@@ -269,23 +292,23 @@ public:
     
     // Get number of VBOs
     size_t getVBOCount() const {
-        return vbo_refs.size();
+        return vbo_handles.size();
     }
     
     // Check if element buffer is set
     bool hasElementBuffer() const {
-        return ebo_ref != nullptr;
+        return static_cast<bool>(ebo_handle);
     }
     
-    // Get element buffer reference (returns nullptr if not set)
-    GLBuffer* getElementBuffer() const {
-        return ebo_ref;
+    // Get element buffer handle (null if not set, stale once that buffer is destroyed)
+    GLHandle getElementBuffer() const {
+        return ebo_handle;
     }
     
     // Clear all buffer references (doesn't delete the buffers)
     void clearBufferReferences() {
-        vbo_refs.clear();
-        ebo_ref = nullptr;
+        vbo_handles.clear();
+        ebo_handle = GLHandle();
     }
     
     // Check OpenGL version compatibility
@@ -309,16 +332,30 @@ public:
 private:
     void cleanup() {
         if (is_valid && vao_id != 0) {
-            glDeleteVertexArrays(1, &vao_id);
+            GLResourceManager::instance().release(vao_handle);
             vao_id = 0;
+            vao_handle = GLHandle();
         }
         
         // Clear references (but don't delete the actual buffers)
-        vbo_refs.clear();
-        ebo_ref = nullptr;
+        vbo_handles.clear();
+        ebo_handle = GLHandle();
         is_valid = false;
     }
     
+    // The buffers must outlive the VAO; a released name may already belong to another mesh
+    void checkBuffers() const {
+        GLResourceManager& resources = GLResourceManager::instance();
+        for (const GLHandle& handle : vbo_handles) {
+            if (!resources.isAlive(handle)) {
+                throw std::runtime_error("Vertex buffer was destroyed while the VAO still uses it");
+            }
+        }
+        if (ebo_handle && !resources.isAlive(ebo_handle)) {
+            throw std::runtime_error("Element buffer was destroyed while the VAO still uses it");
+        }
+    }
+    
     // Helper function to get size of index types
     size_t getIndexTypeSize(GLenum type) const {
         switch (type) {
@@ -0,0 +1,81 @@
+#ifndef GPU_PROFILER_H
+#define GPU_PROFILER_H
+
+#include <glad/glad.h>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "Profiler.h"
+
+
+// GPU scope timing with GL_TIME_ELAPSED queries.
+//
+// Queries are read back FRAME_LATENCY frames after they were issued, and only if the
+// result is already available, so the CPU never waits on the GPU. Results are forwarded
+// to the Profiler as events on the "GPU" row.
+// GL_TIME_ELAPSED queries cannot nest: a scope opened while another one is active is ignored.
+// Everything here must run on the thread that owns the GL context.
+class GpuProfiler {
+    public:
+        static constexpr int FRAME_LATENCY = 4;
+        static constexpr int MAX_SCOPES_PER_FRAME = 32;
+
+        static GpuProfiler& instance();
+
+        bool init();
+        void shutdown();
+
+        // Reads back the oldest frame's results and recycles its queries
+        void beginFrame();
+        void endFrame();
+
+        // Returns false if the scope was ignored (nested, over the limit, or not initialized)
+        bool beginScope(const char* name);
+        void endScope();
+
+        // Most recent total GPU time of a frame, in milliseconds (0 until the first readback)
+        // (safe to read from any thread)
+        double lastFrameGpuMs() const { return _lastFrameGpuMs.load(std::memory_order_relaxed); }
+        uint64_t skippedReadbacks() const { return _skippedReadbacks; }
+
+    private:
+        struct PendingQuery {
+            const char* name;
+            uint64_t issuedNs;
+            GLuint query;
+        };
+
+        GLuint _queries[FRAME_LATENCY][MAX_SCOPES_PER_FRAME] = {};
+        std::vector<PendingQuery> _pending[FRAME_LATENCY];
+        int _frame = 0;
+        bool _initialized = false;
+        bool _scopeOpen = false;
+        std::atomic<double> _lastFrameGpuMs{0.0};
+        uint64_t _skippedReadbacks = 0;
+};
+
+
+class GpuProfileScope {
+    private:
+        bool _active;
+    public:
+        explicit GpuProfileScope(const char* name)
+            : _active(Profiler::isEnabled() && GpuProfiler::instance().beginScope(name)) {
+        }
+        ~GpuProfileScope() {
+            if (_active) {
+                GpuProfiler::instance().endScope();
+            }
+        }
+        GpuProfileScope(const GpuProfileScope&) = delete;
+        GpuProfileScope& operator=(const GpuProfileScope&) = delete;
+};
+
+#ifdef GRAPHISQUE_ENABLE_PROFILER
+    #define GRAPHISQUE_PROFILE_GPU_SCOPE(name) GpuProfileScope GRAPHISQUE_CONCAT(_gpuProfileScope, __LINE__)(name)
+#else
+    #define GRAPHISQUE_PROFILE_GPU_SCOPE(name) ((void)0)
+#endif
+
+#endif // GPU_PROFILER_H
@@ -0,0 +1,143 @@
+#ifndef HARDWARE_COUNTERS_H
+#define HARDWARE_COUNTERS_H
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "Profiler.h"
+
+
+enum class HardwareCounter {
+    Cycles,
+    Instructions,
+    BranchMisses,
+    L1DataMisses,    // L1 data cache read misses
+    LastLevelMisses, // last level cache read misses
+    Count
+};
+
+const char* hardwareCounterName(HardwareCounter counter);
+
+
+// Counter deltas over some stretch of code. A counter the CPU, the VM or the kernel does
+// not provide is left invalid rather than reported as zero.
+struct CounterValues {
+    static constexpr size_t COUNT = static_cast<size_t>(HardwareCounter::Count);
+
+    uint64_t values[COUNT] = {};
+    bool valid[COUNT] = {};
+
+    bool has(HardwareCounter counter) const { return valid[static_cast<size_t>(counter)]; }
+    uint64_t get(HardwareCounter counter) const { return values[static_cast<size_t>(counter)]; }
+    bool any() const;
+    // Instructions per cycle, 0 when either is missing
+    double ipc() const;
+
+    CounterValues& operator+=(const CounterValues& other);
+};
+
+
+// Linux perf_event_open counters for the calling thread (user space only).
+//
+// Each counter is opened on its own and left running; a measurement is the difference of
+// two readings, scaled up when the kernel had to multiplex counters. When the kernel
+// forbids access (perf_event_paranoid, seccomp in containers) or the platform is not
+// Linux, nothing is available and every reading comes back invalid; the reason is logged
+// once. Only the thread that created an instance may read it.
+class HardwareCounters {
+    public:
+        struct Reading {
+            uint64_t value = 0;
+            uint64_t enabledNs = 0;
+            uint64_t runningNs = 0;
+        };
+        struct Readings {
+            Reading counters[CounterValues::COUNT];
+        };
+
+        HardwareCounters();
+        ~HardwareCounters();
+
+        HardwareCounters(const HardwareCounters&) = delete;
+        HardwareCounters& operator=(const HardwareCounters&) = delete;
+
+        bool isAvailable() const;
+
+        Readings sample() const;
+        CounterValues difference(const Readings& from, const Readings& to) const;
+
+        // Convenience for a single measurement at a time
+        void start() { _started = sample(); }
+        CounterValues stop() const { return difference(_started, sample()); }
+
+        // The calling thread's counters, opened on first use
+        static HardwareCounters& forThisThread();
+
+        // GRAPHISQUE_PROFILE_COUNTERS scopes only count while this is on (off by default,
+        // every scope costs a few system calls)
+        static void setScopesEnabled(bool enabled);
+        static bool scopesEnabled();
+
+    private:
+        int _fds[CounterValues::COUNT];
+        Readings _started;
+};
+
+
+// Totals of every GRAPHISQUE_PROFILE_COUNTERS scope, by name
+class CounterScopeStats {
+    public:
+        struct Entry {
+            uint64_t calls = 0;
+            CounterValues totals;
+        };
+
+        static CounterScopeStats& instance();
+
+        void add(const char* name, const CounterValues& values);
+        std::map<std::string, Entry> entries() const;
+        // One line per scope: calls, IPC and misses per thousand instructions
+        void print(std::FILE* out) const;
+
+    private:
+        CounterScopeStats() = default;
+
+        mutable std::mutex _mutex;
+        std::map<std::string, Entry> _entries;
+};
+
+
+// RAII scope; use through GRAPHISQUE_PROFILE_COUNTERS. `name` must be a string literal.
+class CounterScope {
+    private:
+        const char* _name;
+        bool _active;
+        HardwareCounters::Readings _start;
+
+    public:
+        explicit CounterScope(const char* name) : _name(name), _active(HardwareCounters::scopesEnabled()) {
+            if (_active) {
+                _start = HardwareCounters::forThisThread().sample();
+            }
+        }
+        ~CounterScope() {
+            if (_active) {
+                HardwareCounters& counters = HardwareCounters::forThisThread();
+                CounterScopeStats::instance().add(_name, counters.difference(_start, counters.sample()));
+            }
+        }
+        CounterScope(const CounterScope&) = delete;
+        CounterScope& operator=(const CounterScope&) = delete;
+};
+
+
+#ifdef GRAPHISQUE_ENABLE_PROFILER
+    #define GRAPHISQUE_PROFILE_COUNTERS(name) CounterScope GRAPHISQUE_CONCAT(_counterScope, __LINE__)(name)
+#else
+    #define GRAPHISQUE_PROFILE_COUNTERS(name) ((void)0)
+#endif
+
+#endif // HARDWARE_COUNTERS_H
@@ -0,0 +1,43 @@
+#ifndef HEADLESS_CONTEXT_H
+#define HEADLESS_CONTEXT_H
+
+#include <string>
+
+
+// OpenGL core context without a window, created through EGL.
+//
+// Prefers Mesa's surfaceless platform (works in containers with no display and no GPU,
+// llvmpipe renders on the CPU) and falls back to the default EGL display. The context
+// is made current without a surface when EGL_KHR_surfaceless_context is there, otherwise
+// on a 1x1 pbuffer; either way all drawing goes into a GLFramebuffer.
+//
+// Builds without EGL (GRAPHISQUE_HAVE_EGL unset) keep the class, create() just fails.
+class HeadlessContext {
+    private:
+        void* _display = nullptr;  // EGLDisplay
+        void* _context = nullptr;  // EGLContext
+        void* _surface = nullptr;  // EGLSurface, only when surfaceless contexts are unsupported
+        std::string _description;
+
+    public:
+        HeadlessContext() = default;
+        ~HeadlessContext();
+
+        HeadlessContext(const HeadlessContext&) = delete;
+        HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+        bool create(int major = 3, int minor = 3);
+        void destroy();
+
+        bool makeCurrent();
+        void release();
+
+        bool isValid() const { return _context != nullptr; }
+        // Vendor/platform summary for logs
+        const std::string& getDescription() const { return _description; }
+
+        // Loader for gladLoadGLLoader
+        static void* getProcAddress(const char* name);
+};
+
+#endif // HEADLESS_CONTEXT_H
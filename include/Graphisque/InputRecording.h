@@ -0,0 +1,99 @@
+#ifndef INPUT_RECORDING_H
+#define INPUT_RECORDING_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+
+enum class InputEventType : uint8_t {
+    Key = 1,             // code = GLFW key, action, mods
+    MouseButton = 2,     // code = GLFW button, action, mods, x/y = cursor position
+    CursorPos = 3,       // x/y
+    FramebufferSize = 4, // x/y = width/height
+    Command = 5          // code = SceneCommand, value
+};
+
+// Scene changes made through the Application API rather than through input
+enum class SceneCommand : uint16_t {
+    SampleStep = 1
+};
+
+struct InputEvent {
+    InputEventType type = InputEventType::Key;
+    double time = 0.0; // seconds since the recording started
+    int code = 0;
+    int action = 0;
+    int mods = 0;
+    double x = 0.0;
+    double y = 0.0;
+    float value = 0.0f;
+};
+
+
+// Writes input events to a compact binary file:
+//
+//   header: "GQIR", u16 version, u16 reserved, i32 width, i32 height (framebuffer at start)
+//   event:  u8 type, u32 microseconds since the previous event, then per type
+//           Key i16 key, u8 action, u8 mods | MouseButton u8 button, u8 action, u8 mods, f64 x, f64 y
+//           CursorPos f64 x, f64 y | FramebufferSize i32 w, i32 h | Command u16 id, f32 value
+//
+// All fields little endian. Main thread only.
+class InputRecorder {
+    public:
+        static constexpr uint16_t VERSION = 1;
+
+        InputRecorder() = default;
+        ~InputRecorder();
+
+        InputRecorder(const InputRecorder&) = delete;
+        InputRecorder& operator=(const InputRecorder&) = delete;
+
+        bool begin(const std::string& path, int width, int height, double now);
+        void end();
+        bool isActive() const { return _file != nullptr; }
+
+        // `now` is the application clock in seconds
+        void record(const InputEvent& event, double now);
+        size_t eventCount() const { return _events; }
+
+    private:
+        std::FILE* _file = nullptr;
+        std::string _path;
+        double _startTime = 0.0;
+        uint64_t _lastMicros = 0;
+        size_t _events = 0;
+};
+
+
+// A recording loaded back into memory, events in time order
+class InputReplay {
+    public:
+        bool load(const std::string& path);
+
+        const std::vector<InputEvent>& getEvents() const { return _events; }
+        int getWidth() const { return _width; }
+        int getHeight() const { return _height; }
+        double getDuration() const { return _events.empty() ? 0.0 : _events.back().time; }
+
+    private:
+        std::vector<InputEvent> _events;
+        int _width = 0;
+        int _height = 0;
+};
+
+
+// Per-frame wall times of a replay, in milliseconds
+struct FrameTimeSummary {
+    size_t frames = 0;
+    double meanMs = 0.0;
+    double p50Ms = 0.0;
+    double p99Ms = 0.0;
+    double maxMs = 0.0;
+
+    static FrameTimeSummary from(std::vector<double> frameMs);
+    void print(std::FILE* out) const;
+};
+
+#endif // INPUT_RECORDING_H
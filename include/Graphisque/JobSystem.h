@@ -0,0 +1,106 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// Lower value = picked first
+enum class JobPriority {
+    VisibleNow = 0, // what is on screen right now is waiting on this
+    Refine = 1,     // improves something that is already visible
+    Prefetch = 2,   // speculative work, nobody is waiting yet
+    Count
+};
+
+
+// Cooperative cancellation. Copies share the same flag; jobs check it before
+// they start and long running jobs are expected to check it between tiles.
+class CancellationToken {
+    private:
+        std::shared_ptr<std::atomic<bool>> _cancelled;
+
+    public:
+        CancellationToken() : _cancelled(std::make_shared<std::atomic<bool>>(false)) {}
+
+        void cancel() const { _cancelled->store(true, std::memory_order_release); }
+        bool isCancelled() const { return _cancelled->load(std::memory_order_acquire); }
+};
+
+
+struct Job {
+    std::function<void()> work;
+    JobPriority priority = JobPriority::VisibleNow;
+    CancellationToken token;
+
+    std::atomic<int> pending{1};  // unfinished dependencies, +1 until the job is submitted
+    std::mutex mutex;
+    std::condition_variable finishedCv;
+    std::vector<std::shared_ptr<Job>> dependents; // guarded by mutex
+    bool finished = false;                        // guarded by mutex
+};
+
+using JobHandle = std::shared_ptr<Job>;
+
+
+// Thread pool running a graph of jobs. A job becomes runnable once every job it
+// depends on has finished (cancelled jobs count as finished, their work is skipped).
+class JobSystem {
+    private:
+        std::vector<std::thread> _workers;
+        std::deque<JobHandle> _queues[static_cast<int>(JobPriority::Count)];
+        std::mutex _queueMutex;
+        std::condition_variable _queueCv;
+        bool _stopping = false;
+
+        void workerLoop(unsigned index);
+        void enqueue(const JobHandle& job);
+        void release(const JobHandle& job);
+        void finish(const JobHandle& job);
+        // Finishes a job without running its work (shutting down)
+        void drop(const JobHandle& job);
+
+    public:
+        // 0 workers = one per hardware thread, minus the main and render threads
+        explicit JobSystem(unsigned workerCount = 0);
+        ~JobSystem();
+
+        JobSystem(const JobSystem&) = delete;
+        JobSystem& operator=(const JobSystem&) = delete;
+
+        JobHandle createJob(std::function<void()> work, JobPriority priority = JobPriority::VisibleNow,
+                            const CancellationToken& token = CancellationToken());
+
+        // Must be called before `job` is submitted
+        void addDependency(const JobHandle& job, const JobHandle& dependsOn);
+        void submit(const JobHandle& job);
+
+        // create + addDependency + submit in one go
+        JobHandle schedule(std::function<void()> work, JobPriority priority = JobPriority::VisibleNow,
+                           const CancellationToken& token = CancellationToken(),
+                           const std::vector<JobHandle>& dependencies = {});
+
+        // Splits [0, count) into chunks of `grain` and runs body(begin, end) for each chunk.
+        // The returned job finishes once every chunk has; a cancelled token skips remaining chunks.
+        // No chunk starts before all of `dependencies` have finished.
+        JobHandle parallelFor(size_t count, size_t grain, std::function<void(size_t, size_t)> body,
+                              JobPriority priority = JobPriority::VisibleNow,
+                              const CancellationToken& token = CancellationToken(),
+                              const std::vector<JobHandle>& dependencies = {});
+
+        void wait(const JobHandle& job);
+
+        // Stops the workers. Queued jobs that did not start, and jobs that become ready
+        // afterwards, finish without running their work, so wait() on them still returns.
+        void shutdown();
+
+        size_t workerCount() const { return _workers.size(); }
+};
+
+#endif // JOB_SYSTEM_H
@@ -0,0 +1,104 @@
+#ifndef LOCK_FREE_QUEUE_H
+#define LOCK_FREE_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+
+// Bounded multi-producer / multi-consumer ring buffer (Vyukov style).
+// Every cell carries a sequence number, so producers and consumers only
+// contend on their own cursor and never take a lock.
+// Capacity must be a power of two.
+template<typename T>
+class LockFreeQueue {
+    private:
+        struct Cell {
+            std::atomic<size_t> sequence;
+            T value;
+        };
+
+        static constexpr size_t CACHE_LINE = 64;
+
+        std::unique_ptr<Cell[]> _cells;
+        size_t _mask;
+        alignas(CACHE_LINE) std::atomic<size_t> _enqueuePos;
+        alignas(CACHE_LINE) std::atomic<size_t> _dequeuePos;
+
+    public:
+        explicit LockFreeQueue(size_t capacity)
+            : _cells(new Cell[capacity]), _mask(capacity - 1), _enqueuePos(0), _dequeuePos(0) {
+            if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+                throw std::invalid_argument("LockFreeQueue capacity must be a power of two");
+            }
+            for (size_t i = 0; i < capacity; ++i) {
+                _cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        LockFreeQueue(const LockFreeQueue&) = delete;
+        LockFreeQueue& operator=(const LockFreeQueue&) = delete;
+
+        // Returns false when the queue is full; the value is left untouched in that case
+        bool tryPush(T& value) {
+            Cell* cell;
+            size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+            for (;;) {
+                cell = &_cells[pos & _mask];
+                size_t seq = cell->sequence.load(std::memory_order_acquire);
+                intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+                if (diff == 0) {
+                    if (_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                } else if (diff < 0) {
+                    return false;
+                } else {
+                    pos = _enqueuePos.load(std::memory_order_relaxed);
+                }
+            }
+            cell->value = std::move(value);
+            cell->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool tryPush(T&& value) {
+            return tryPush(value);
+        }
+
+        // Returns false when the queue is empty
+        bool tryPop(T& out) {
+            Cell* cell;
+            size_t pos = _dequeuePos.load(std::memory_order_relaxed);
+            for (;;) {
+                cell = &_cells[pos & _mask];
+                size_t seq = cell->sequence.load(std::memory_order_acquire);
+                intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+                if (diff == 0) {
+                    if (_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                } else if (diff < 0) {
+                    return false;
+                } else {
+                    pos = _dequeuePos.load(std::memory_order_relaxed);
+                }
+            }
+            out = std::move(cell->value);
+            cell->sequence.store(pos + _mask + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Approximate; only meaningful when producers/consumers are quiet
+        bool empty() const {
+            return _enqueuePos.load(std::memory_order_acquire) == _dequeuePos.load(std::memory_order_acquire);
+        }
+
+        size_t capacity() const { return _mask + 1; }
+};
+
+#endif // LOCK_FREE_QUEUE_H
@@ -0,0 +1,192 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+
+#include "LockFreeQueue.h"
+
+
+enum class LogLevel : uint8_t {
+    Trace,
+    Debug,
+    Info,
+    Warning,
+    Error,
+    Off
+};
+
+// Levels below this are compiled out entirely (set through GRAPHISQUE_LOG_LEVEL in CMake)
+#ifndef GRAPHISQUE_LOG_MIN_LEVEL
+    #define GRAPHISQUE_LOG_MIN_LEVEL 2
+#endif
+
+
+// One queued message: the format string and the raw argument values. Strings are copied
+// (truncated to what fits); formatting happens on the logger thread. Once an argument
+// doesn't fit, it and every later one are left out and the record is marked truncated, so
+// the placeholders that did get a value still get the right one.
+struct LogRecord {
+    enum ArgType : uint8_t {
+        Signed,
+        Unsigned,
+        Float,
+        Char,
+        String,
+        Pointer
+    };
+
+    static constexpr size_t PAYLOAD_BYTES = 128;
+
+    uint64_t timeNs;
+    const char* tag;
+    const char* format;
+    uint32_t threadId;
+    LogLevel level;
+    uint8_t size; // payload bytes in use
+    bool truncated; // arguments were left out or cut short
+    unsigned char payload[PAYLOAD_BYTES];
+
+    template<typename T>
+    void putRaw(ArgType type, const T& value) {
+        if (truncated || size + sizeof(T) + 1 > PAYLOAD_BYTES) {
+            truncated = true;
+            return;
+        }
+        payload[size++] = type;
+        std::memcpy(payload + size, &value, sizeof(T));
+        size = static_cast<uint8_t>(size + sizeof(T));
+    }
+
+    void putString(std::string_view text) {
+        if (truncated || size + size_t(2) > PAYLOAD_BYTES) {
+            truncated = true;
+            return;
+        }
+        size_t length = std::min<size_t>(text.size(), PAYLOAD_BYTES - size - 2);
+        truncated = length < text.size();
+        payload[size++] = String;
+        payload[size++] = static_cast<unsigned char>(length);
+        std::memcpy(payload + size, text.data(), length);
+        size = static_cast<uint8_t>(size + length);
+    }
+
+    template<typename T>
+    void put(const T& value) {
+        using U = std::decay_t<T>;
+        if constexpr (std::is_same_v<U, char>) {
+            putRaw(Char, value);
+        } else if constexpr (std::is_same_v<U, bool>) {
+            putString(value ? "true" : "false");
+        } else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>) {
+            putRaw(Signed, static_cast<int64_t>(value));
+        } else if constexpr (std::is_integral_v<U> || std::is_enum_v<U>) {
+            putRaw(Unsigned, static_cast<uint64_t>(value));
+        } else if constexpr (std::is_floating_point_v<U>) {
+            putRaw(Float, static_cast<double>(value));
+        } else if constexpr (std::is_pointer_v<U> && std::is_convertible_v<U, const char*>) {
+            putString(value != nullptr ? std::string_view(value) : std::string_view("(null)"));
+        } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+            putString(std::string_view(value));
+        } else {
+            static_assert(std::is_pointer_v<U>, "unsupported log argument type");
+            putRaw(Pointer, reinterpret_cast<const void*>(value));
+        }
+    }
+};
+
+
+// Asynchronous logger.
+//
+// log() copies the message into a bounded lock-free ring and returns; a background thread
+// formats and writes it. So logging from input callbacks, camera updates or the render
+// thread costs well under a microsecond and never blocks on the terminal. When the ring is
+// full the message is dropped and counted rather than waited for.
+//
+// Formats use {} for the next argument, or {:spec} with a printf conversion ("{:.2f}",
+// "{:08x}"). Arguments may be numbers, chars, bools, pointers and strings.
+class Logger {
+    public:
+        static Logger& instance();
+
+        template<typename... Args>
+        void log(LogLevel level, const char* tag, const char* format, const Args&... args) {
+            if (level < _level.load(std::memory_order_relaxed)) {
+                return;
+            }
+            LogRecord record;
+            record.timeNs = nowNs();
+            record.tag = tag;
+            record.format = format;
+            record.threadId = threadId();
+            record.level = level;
+            record.size = 0;
+            record.truncated = false;
+            (record.put(args), ...);
+            if (_queue.tryPush(record)) {
+                _queued.fetch_add(1, std::memory_order_release);
+            } else {
+                _dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        // Runtime threshold on top of GRAPHISQUE_LOG_MIN_LEVEL
+        void setLevel(LogLevel level) { _level.store(level, std::memory_order_relaxed); }
+        LogLevel level() const { return _level.load(std::memory_order_relaxed); }
+
+        // Blocks until every message logged before the call is written
+        void flush();
+        uint64_t droppedMessages() const { return _dropped.load(std::memory_order_relaxed); }
+
+        // Formats one record the way the logger thread does, for tests and tools
+        static size_t format(const LogRecord& record, char* out, size_t capacity);
+
+    private:
+        static constexpr size_t QUEUE_CAPACITY = 4096;
+
+        Logger();
+        ~Logger();
+
+        static uint64_t nowNs();
+        static uint32_t threadId();
+        void drainLoop();
+        size_t drain();
+
+        LockFreeQueue<LogRecord> _queue{QUEUE_CAPACITY};
+        std::atomic<LogLevel> _level{LogLevel::Trace};
+        std::atomic<uint64_t> _queued{0};
+        std::atomic<uint64_t> _written{0};
+        std::atomic<uint64_t> _dropped{0};
+        std::atomic<bool> _running{true};
+        //the logger thread sleeps longer the longer nothing is logged; flush() and shutdown
+        //wake it, producers don't (that would be a syscall on their side)
+        std::mutex _wakeMutex;
+        std::condition_variable _wakeCv;
+        bool _wakeRequested = false;
+        std::thread _thread;
+};
+
+
+#define GRAPHISQUE_LOG(level, tag, ...)                                                  \
+    do {                                                                                 \
+        if constexpr (static_cast<int>(level) >= GRAPHISQUE_LOG_MIN_LEVEL) {             \
+            Logger::instance().log(level, tag, __VA_ARGS__);                             \
+        }                                                                                \
+    } while (0)
+
+#define GRAPHISQUE_LOG_TRACE(tag, ...) GRAPHISQUE_LOG(LogLevel::Trace, tag, __VA_ARGS__)
+#define GRAPHISQUE_LOG_DEBUG(tag, ...) GRAPHISQUE_LOG(LogLevel::Debug, tag, __VA_ARGS__)
+#define GRAPHISQUE_LOG_INFO(tag, ...) GRAPHISQUE_LOG(LogLevel::Info, tag, __VA_ARGS__)
+#define GRAPHISQUE_LOG_WARN(tag, ...) GRAPHISQUE_LOG(LogLevel::Warning, tag, __VA_ARGS__)
+#define GRAPHISQUE_LOG_ERROR(tag, ...) GRAPHISQUE_LOG(LogLevel::Error, tag, __VA_ARGS__)
+
+#endif // LOGGER_H
@@ -0,0 +1,121 @@
+#ifndef MEMORY_ARENA_H
+#define MEMORY_ARENA_H
+
+#include <cstddef>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+
+
+// Linear (bump) allocator for short-lived data. deallocate() is a no-op; memory comes back
+// all at once through reset() or rewind(). Chunks are kept across resets, and a reset
+// after the arena had to grow merges them into one, so a steady workload stops touching
+// the heap after a few rounds. Not thread safe: one owner thread per arena.
+//
+// Hand it to pmr containers: std::pmr::vector<float> v(&ArenaResource::frame());
+class ArenaResource : public std::pmr::memory_resource {
+    public:
+        struct Marker {
+            size_t chunk = 0;
+            size_t offset = 0;
+        };
+
+        explicit ArenaResource(size_t initialBytes = 64 * 1024,
+                               std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+        ~ArenaResource() override;
+
+        ArenaResource(const ArenaResource&) = delete;
+        ArenaResource& operator=(const ArenaResource&) = delete;
+
+        Marker mark() const { return {_current, _offset}; }
+        // Frees everything allocated after `marker` was taken
+        void rewind(const Marker& marker);
+        void reset();
+
+        size_t bytesUsed() const;
+        size_t capacity() const;
+        // Most bytes in use at once since construction
+        size_t peakBytes() const { return _peak; }
+
+        // Main thread; everything in it is gone after the current Application::run iteration
+        static ArenaResource& frame();
+        // The calling thread's scratch arena, for job and worker temporaries; see ScratchScope
+        static ArenaResource& scratch();
+
+    private:
+        struct Chunk {
+            std::byte* data;
+            size_t size;
+        };
+
+        const size_t _initialBytes;
+        std::pmr::memory_resource* _upstream;
+        std::vector<Chunk> _chunks;
+        size_t _current = 0;
+        size_t _offset = 0;
+        size_t _peak = 0;
+
+        Chunk allocateChunk(size_t size);
+
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void*, size_t, size_t) override {}
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+
+// RAII: everything allocated from the calling thread's scratch arena while this is alive
+// is released when it goes out of scope (nests like a stack)
+class ScratchScope {
+    private:
+        ArenaResource& _arena;
+        ArenaResource::Marker _marker;
+
+    public:
+        ScratchScope() : _arena(ArenaResource::scratch()), _marker(_arena.mark()) {}
+        ~ScratchScope() { _arena.rewind(_marker); }
+        ScratchScope(const ScratchScope&) = delete;
+        ScratchScope& operator=(const ScratchScope&) = delete;
+
+        ArenaResource* resource() { return &_arena; }
+};
+
+
+// Fixed size blocks on a free list, for objects that are created and destroyed all the time
+// (jobs). Requests larger than the block, or more strictly aligned, go to
+// `upstream`. Allocation and release lock a mutex so any thread may free a block.
+class PoolResource : public std::pmr::memory_resource {
+    public:
+        explicit PoolResource(size_t blockSize, size_t blocksPerChunk = 256,
+                              std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+        ~PoolResource() override;
+
+        PoolResource(const PoolResource&) = delete;
+        PoolResource& operator=(const PoolResource&) = delete;
+
+        size_t blockSize() const { return _blockSize; }
+        size_t blocksInUse() const;
+        size_t blocksAllocated() const;
+        // Requests the pool could not serve and passed upstream
+        size_t oversizedRequests() const;
+
+    private:
+        struct FreeBlock {
+            FreeBlock* next;
+        };
+
+        const size_t _blockSize;
+        const size_t _blocksPerChunk;
+        std::pmr::memory_resource* _upstream;
+
+        mutable std::mutex _mutex;
+        FreeBlock* _free = nullptr;
+        std::vector<std::byte*> _chunks;
+        size_t _inUse = 0;
+        size_t _oversized = 0;
+
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+#endif // MEMORY_ARENA_H
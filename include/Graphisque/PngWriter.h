@@ -0,0 +1,61 @@
+#ifndef PNG_WRITER_H
+#define PNG_WRITER_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+
+// Writes an RGBA8 PNG a row at a time, so images far larger than memory can be produced
+// from stripes. Output goes through a sink in IDAT chunks of roughly CHUNK_BYTES.
+//
+// Image data goes into stored (uncompressed) deflate blocks: files are about as big as
+// the raw pixels, but encoding is a memcpy plus CRC/Adler checksums, which keeps image
+// output limited by rendering rather than by compression.
+class PngStreamWriter {
+    public:
+        using Sink = std::function<bool(const uint8_t* data, size_t size)>;
+        static constexpr size_t CHUNK_BYTES = 1 << 20;
+
+        // Writes the signature and header
+        bool begin(Sink sink, int width, int height);
+        // `rgba` is one row of width*4 bytes; rows go top to bottom
+        bool writeRow(const uint8_t* rgba);
+        // Call after the last row; fails if rows are missing
+        bool finish();
+
+        int rowsWritten() const { return _rowsWritten; }
+
+    private:
+        Sink _sink;
+        int _width = 0;
+        int _height = 0;
+        int _rowsWritten = 0;
+        bool _ok = false;
+
+        std::vector<uint8_t> _chunk; // pending IDAT payload
+        uint64_t _rawRemaining = 0;  // uncompressed bytes still to come, filter bytes included
+        size_t _blockRemaining = 0;  // bytes left in the current stored block
+        uint32_t _adlerA = 1;
+        uint32_t _adlerB = 0;
+
+        void putData(const uint8_t* data, size_t size);
+        bool flushChunk();
+        bool writeChunk(const char type[4], const uint8_t* data, size_t size);
+};
+
+
+class PngWriter {
+    public:
+        // `rgba` is width*height*4 bytes. With flipVertically the first row in memory is
+        // written last, which is what glReadPixels output needs.
+        static void encode(int width, int height, const uint8_t* rgba, bool flipVertically,
+                           std::vector<uint8_t>& out);
+        static bool write(const std::string& path, int width, int height, const uint8_t* rgba,
+                          bool flipVertically = true);
+
+        static uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc = 0);
+};
+
+#endif // PNG_WRITER_H
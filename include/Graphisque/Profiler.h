@@ -0,0 +1,129 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+// One finished scope. `name` must be a string literal (or otherwise outlive the profiler).
+struct ProfileEvent {
+    const char* name = nullptr;
+    uint64_t startNs = 0;
+    uint64_t endNs = 0;
+    uint32_t threadId = 0;
+    uint16_t depth = 0;
+    bool gpu = false;
+};
+
+
+// Collects CPU (and GPU, see GpuProfiler) scope timings.
+//
+// Every thread writes into its own single-producer/single-consumer ring, so recording a
+// scope is two clock reads and a couple of relaxed stores; no locks on the hot path.
+// collect() drains all rings into a short history used by the overlay and by trace capture.
+class Profiler {
+    public:
+        static constexpr uint32_t GPU_THREAD_ID = 0xFFFF;
+
+        struct ThreadInfo {
+            uint32_t id;
+            std::string name;
+        };
+
+        static Profiler& instance();
+
+        static uint64_t nowNs();
+        static bool isEnabled() { return instance()._enabled.load(std::memory_order_relaxed); }
+        void setEnabled(bool enabled) { _enabled.store(enabled, std::memory_order_relaxed); }
+
+        // Names the calling thread in the overlay and in traces
+        void setThreadName(const std::string& name);
+
+        void record(const char* name, uint64_t startNs, uint64_t endNs, uint16_t depth, bool gpu = false);
+
+        // Drains every thread's ring; call from one thread only (the UI/main thread)
+        void collect();
+
+        // Events of the last `historyMs` milliseconds, oldest first
+        const std::deque<ProfileEvent>& history() const { return _history; }
+        std::vector<ThreadInfo> threads() const;
+        uint64_t droppedEvents() const { return _dropped.load(std::memory_order_relaxed); }
+
+        // Chrome trace (chrome://tracing, Perfetto) capture of everything collected in between
+        void beginCapture();
+        bool endCapture(const std::string& path);
+        bool isCapturing() const { return _capturing; }
+
+        void setHistoryMs(double ms) { _historyNs = static_cast<uint64_t>(ms * 1e6); }
+
+        // Per thread scope nesting; used by ProfileScope
+        static uint16_t& threadDepth();
+        // Innermost open scope of the calling thread, nullptr outside of one (AllocationTracker)
+        static const char*& threadScope();
+
+    private:
+        struct ThreadBuffer;
+
+        Profiler();
+        ThreadBuffer& threadBuffer();
+
+        std::atomic<bool> _enabled{true};
+        mutable std::mutex _registryMutex; // registration only, never taken while recording
+        std::vector<std::shared_ptr<ThreadBuffer>> _buffers;
+        std::atomic<uint64_t> _dropped{0};
+
+        std::deque<ProfileEvent> _history;
+        uint64_t _historyNs = 2000000000ull;
+
+        bool _capturing = false;
+        std::vector<ProfileEvent> _capture;
+};
+
+
+// RAII scope; use through GRAPHISQUE_PROFILE_SCOPE
+class ProfileScope {
+    private:
+        const char* _name;
+        const char* _parent;
+        uint64_t _start;
+        bool _active;
+
+    public:
+        explicit ProfileScope(const char* name)
+            : _name(name), _parent(Profiler::threadScope()), _start(0), _active(Profiler::isEnabled()) {
+            Profiler::threadScope() = name;
+            if (_active) {
+                ++Profiler::threadDepth();
+                _start = Profiler::nowNs();
+            }
+        }
+        ~ProfileScope() {
+            if (_active) {
+                uint64_t end = Profiler::nowNs();
+                uint16_t depth = --Profiler::threadDepth();
+                Profiler::instance().record(_name, _start, end, depth);
+            }
+            Profiler::threadScope() = _parent;
+        }
+        ProfileScope(const ProfileScope&) = delete;
+        ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+
+#define GRAPHISQUE_CONCAT_INNER(a, b) a##b
+#define GRAPHISQUE_CONCAT(a, b) GRAPHISQUE_CONCAT_INNER(a, b)
+
+#ifdef GRAPHISQUE_ENABLE_PROFILER
+    #define GRAPHISQUE_PROFILE_SCOPE(name) ProfileScope GRAPHISQUE_CONCAT(_profileScope, __LINE__)(name)
+    #define GRAPHISQUE_PROFILE_FUNCTION() GRAPHISQUE_PROFILE_SCOPE(__func__)
+#else
+    #define GRAPHISQUE_PROFILE_SCOPE(name) ((void)0)
+    #define GRAPHISQUE_PROFILE_FUNCTION() ((void)0)
+#endif
+
+#endif // PROFILER_H
@@ -0,0 +1,28 @@
+#ifndef PROFILER_OVERLAY_H
+#define PROFILER_OVERLAY_H
+
+#include <string>
+#include <vector>
+
+
+// ImGui window showing the profiler history as a per-thread timeline (nested scopes
+// stacked like a flame graph), recent frame times, and trace capture controls.
+// Main/UI thread only.
+class ProfilerOverlay {
+    private:
+        bool _visible = false;
+        float _timelineMs = 50.0f;  // width of the visible time window
+        int _captureCount = 0;
+        std::vector<float> _frameTimes;
+
+        void drawTimeline();
+
+    public:
+        void toggle() { _visible = !_visible; }
+        bool isVisible() const { return _visible; }
+
+        // Call between UiLayer::beginFrame and UiLayer::endFrame
+        void draw();
+};
+
+#endif // PROFILER_OVERLAY_H
@@ -0,0 +1,70 @@
+#ifndef PROGRAM_CACHE_H
+#define PROGRAM_CACHE_H
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+
+// On-disk cache of linked shader programs (glGetProgramBinary / glProgramBinary).
+//
+// Programs are keyed by a hash of their sources, their defines and the driver's vendor,
+// renderer and version strings, so a driver update or an edited shader simply misses.
+// A binary the driver rejects is deleted and the caller compiles from source as before.
+//
+// The entry points are GL 4.1 / ARB_get_program_binary and aren't in our glad loader,
+// so loadFunctions() has to be called with the same loader right after gladLoadGLLoader.
+// Without them, or without any binary format, every lookup misses and nothing is written.
+class ProgramCache {
+    public:
+        struct Stats {
+            uint32_t hits = 0;
+            uint32_t misses = 0;
+            uint32_t rejected = 0; // found on disk, refused by the driver
+            uint32_t stored = 0;
+        };
+
+        static ProgramCache& instance();
+
+        // GL thread, once a context is current
+        void loadFunctions(GLADloadproc loader);
+        bool isAvailable() const;
+
+        // Empty disables the cache. Default "./shader_cache"
+        void setDirectory(const std::string& directory);
+        const std::string& getDirectory() const { return _directory; }
+
+        // `defines` is whatever else changes the compiled program (preamble, variant flags)
+        uint64_t makeKey(const std::string& vertexSource, const std::string& fragmentSource,
+                         const std::string& defines = std::string()) const;
+
+        // A linked program, or 0 when there is no usable binary
+        GLuint load(uint64_t key);
+        // Call before linking a program that will be stored
+        void prepare(GLuint program) const;
+        // Writes the binary of a successfully linked program
+        bool store(uint64_t key, GLuint program);
+
+        Stats stats() const;
+
+    private:
+        typedef void (APIENTRYP GetProgramBinaryProc)(GLuint program, GLsizei bufSize, GLsizei* length,
+                                                     GLenum* binaryFormat, void* binary);
+        typedef void (APIENTRYP ProgramBinaryProc)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+        typedef void (APIENTRYP ProgramParameteriProc)(GLuint program, GLenum pname, GLint value);
+
+        ProgramCache() = default;
+        std::string pathFor(uint64_t key) const;
+
+        mutable std::mutex _mutex;
+        GetProgramBinaryProc _getProgramBinary = nullptr;
+        ProgramBinaryProc _programBinary = nullptr;
+        ProgramParameteriProc _programParameteri = nullptr;
+        bool _available = false;
+        std::string _driver; // vendor, renderer and version, part of every key
+        std::string _directory = "./shader_cache";
+        Stats _stats;
+};
+
+#endif // PROGRAM_CACHE_H
@@ -0,0 +1,120 @@
+#ifndef RENDER_STATS_H
+#define RENDER_STATS_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <memory_resource>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+
+
+// Counters for one finished frame
+struct RenderFrameStats {
+    uint64_t frameIndex = 0;
+    double timeMs = 0.0;           // wall time since the previous frame ended
+
+    uint64_t drawCalls = 0;
+    uint64_t triangles = 0;
+    uint64_t lines = 0;
+    uint64_t points = 0;
+    uint64_t programBinds = 0;
+    uint64_t vertexArrayBinds = 0;
+    uint64_t bufferBinds = 0;
+    uint64_t uniformUploads = 0;
+    uint64_t bytesUploaded = 0;    // setData/updateData/resize
+    uint64_t allocations = 0;      // operator new calls, all threads (AllocationTracker)
+    uint64_t allocatedBytes = 0;
+
+    // Gauges, not reset per frame
+    int64_t liveBuffers = 0;
+    int64_t liveBufferBytes = 0;
+    double inputLatencyMs = 0.0;   // input to present, smoothed (FramePacer); 0 until measured
+};
+
+
+// Cheap per-frame render counters fed by GLBuffer, GLVertexArray and Shader.
+//
+// Counting is a relaxed atomic add so the upload worker can report into the same
+// counters as the render thread. endFrame() (render thread) folds the counters into a
+// RenderFrameStats, keeps a short history for the UI and optionally appends it to a
+// CSV or JSON-lines file every `interval` frames.
+class RenderStats {
+    public:
+        enum class Counter {
+            DrawCalls,
+            Triangles,
+            Lines,
+            Points,
+            ProgramBinds,
+            VertexArrayBinds,
+            BufferBinds,
+            UniformUploads,
+            BytesUploaded,
+            Count
+        };
+
+        enum class DumpFormat {
+            Csv,
+            JsonLines
+        };
+
+        static RenderStats& instance();
+
+        static void add(Counter counter, uint64_t amount = 1) {
+            instance()._counters[static_cast<size_t>(counter)].fetch_add(amount, std::memory_order_relaxed);
+        }
+        static void countDraw(GLenum mode, GLsizei count);
+        static void bufferAllocated(int64_t bytesDelta, int64_t buffersDelta = 0) {
+            RenderStats& stats = instance();
+            stats._liveBufferBytes.fetch_add(bytesDelta, std::memory_order_relaxed);
+            stats._liveBuffers.fetch_add(buffersDelta, std::memory_order_relaxed);
+        }
+
+        static void setInputLatency(double milliseconds) {
+            instance()._inputLatencyMs.store(milliseconds, std::memory_order_relaxed);
+        }
+
+        // Render thread, once per frame after the last draw
+        void endFrame(uint64_t frameIndex);
+
+        RenderFrameStats lastFrame() const;
+        // Oldest first; at most historySize() frames
+        std::pmr::vector<RenderFrameStats> history(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const;
+        size_t historySize() const { return HISTORY_FRAMES; }
+
+        // Starts appending every `interval`-th frame to `path`. The format follows the
+        // extension (".csv", anything else is JSON lines). An empty path stops dumping.
+        bool setDumpFile(const std::string& path, unsigned interval = 60);
+        bool setDumpFile(const std::string& path, DumpFormat format, unsigned interval);
+
+    private:
+        static constexpr size_t HISTORY_FRAMES = 240;
+
+        RenderStats() = default;
+        void writeDump(const RenderFrameStats& frame);
+
+        std::atomic<uint64_t> _counters[static_cast<size_t>(Counter::Count)] = {};
+        std::atomic<int64_t> _liveBuffers{0};
+        std::atomic<int64_t> _liveBufferBytes{0};
+        std::atomic<double> _inputLatencyMs{0.0};
+        uint64_t _lastFrameNs = 0;
+        uint64_t _lastAllocations = 0;
+        uint64_t _lastAllocatedBytes = 0;
+
+        //fixed ring so that keeping the history does not allocate every few frames
+        mutable std::mutex _historyMutex;
+        std::array<RenderFrameStats, HISTORY_FRAMES> _history;
+        size_t _historyCount = 0;
+        size_t _historyNext = 0;
+
+        std::mutex _dumpMutex;
+        std::ofstream _dump;
+        DumpFormat _dumpFormat = DumpFormat::Csv;
+        unsigned _dumpInterval = 60;
+};
+
+#endif // RENDER_STATS_H
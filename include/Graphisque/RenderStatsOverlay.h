@@ -0,0 +1,28 @@
+#ifndef RENDER_STATS_OVERLAY_H
+#define RENDER_STATS_OVERLAY_H
+
+#include <string>
+#include <vector>
+#include "RenderStats.h"
+#include "DynamicResolution.h"
+
+
+// ImGui window with the last frame's render counters, a draw call graph, a switch for
+// the machine readable dump and the scene resolution settings. Main/UI thread only.
+class RenderStatsOverlay {
+    private:
+        bool _visible = false;
+        bool _dumping = false;
+        std::string _dumpPath = "graphisque_stats.jsonl";
+        std::vector<float> _drawCalls;
+
+    public:
+        void toggle() { _visible = !_visible; }
+        bool isVisible() const { return _visible; }
+
+        // Call between UiLayer::beginFrame and UiLayer::endFrame. `scale` and `gpuMs` are what
+        // the render thread measured; true when `resolution` was edited.
+        bool draw(ResolutionSettings& resolution, float scale, float gpuMs);
+};
+
+#endif // RENDER_STATS_OVERLAY_H
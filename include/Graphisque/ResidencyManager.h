@@ -0,0 +1,84 @@
+#ifndef RESIDENCY_MANAGER_H
+#define RESIDENCY_MANAGER_H
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+using ResidencyId = uint32_t;
+
+
+// Accounts the CPU sample memory and GPU buffer memory of every plot against two budgets.
+//
+// Objects register with a callback that drops their GPU mesh. Owners report their sizes
+// and mark themselves visible whenever they are drawn; endFrame() evicts the least
+// recently visible meshes that were not drawn since the previous endFrame() until the GPU
+// total fits the budget again. Whoever owns an evicted object regenerates it the next
+// time it has to be drawn.
+//
+// CPU copies of uploaded samples are only kept when pinned (picking, export); pinned
+// memory can't be evicted, so going over the CPU budget is only reported.
+class ResidencyManager {
+    public:
+        struct Totals {
+            size_t cpuBytes = 0;
+            size_t gpuBytes = 0;
+            size_t cpuBudget = 0;
+            size_t gpuBudget = 0;
+            size_t objects = 0;
+            size_t residentMeshes = 0;
+            uint64_t evictions = 0;
+        };
+
+        static ResidencyManager& instance();
+
+        // `evictGpu` runs on the thread calling endFrame() (the GL thread), without any lock held
+        ResidencyId registerObject(const std::string& name, std::function<void()> evictGpu);
+        void unregisterObject(ResidencyId id);
+
+        void setCpuBytes(ResidencyId id, size_t bytes);
+        void setGpuBytes(ResidencyId id, size_t bytes);
+        // Drawn in the current frame; a fresh upload counts as visible too
+        void markVisible(ResidencyId id);
+        void setPinned(ResidencyId id, bool pinned);
+        bool isPinned(ResidencyId id) const;
+
+        void setCpuBudget(size_t bytes);
+        void setGpuBudget(size_t bytes);
+
+        // GL thread, once per frame after drawing; returns the number of meshes evicted
+        size_t endFrame();
+
+        Totals totals() const;
+
+    private:
+        struct Entry {
+            std::string name;
+            std::function<void()> evictGpu;
+            size_t cpuBytes = 0;
+            size_t gpuBytes = 0;
+            uint64_t lastVisibleFrame = 0;
+            bool pinned = false;
+            bool active = false;
+        };
+
+        ResidencyManager() = default;
+        Entry* find(ResidencyId id);
+        const Entry* find(ResidencyId id) const;
+
+        mutable std::mutex _mutex;
+        std::vector<Entry> _entries; // indexed by id - 1
+        std::vector<ResidencyId> _freeIds;
+        size_t _cpuBytes = 0;
+        size_t _gpuBytes = 0;
+        size_t _cpuBudget = size_t(512) << 20;
+        size_t _gpuBudget = size_t(1024) << 20;
+        uint64_t _frame = 1;
+        uint64_t _evictions = 0;
+        bool _cpuOverBudgetReported = false;
+};
+
+#endif // RESIDENCY_MANAGER_H
@@ -0,0 +1,211 @@
+#ifndef SAMPLE_GRID_H
+#define SAMPLE_GRID_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include <glm/glm.hpp>
+
+
+// Rectangular domain an equation is sampled over
+struct SampleDomain {
+    float xMin = -5.0f;
+    float xMax = 5.0f;
+    float yMin = -5.0f;
+    float yMax = 5.0f;
+    float step = 0.25f;
+
+    bool operator==(const SampleDomain& other) const {
+        return xMin == other.xMin && xMax == other.xMax && yMin == other.yMin &&
+               yMax == other.yMax && step == other.step;
+    }
+    bool operator!=(const SampleDomain& other) const { return !(*this == other); }
+
+    // number of samples along x (rows of the grid) and y (columns)
+    size_t countX() const { return step > 0.0f && xMax > xMin ? static_cast<size_t>(std::ceil((xMax - xMin) / step)) : 0; }
+    size_t countY() const { return step > 0.0f && yMax > yMin ? static_cast<size_t>(std::ceil((yMax - yMin) / step)) : 0; }
+    size_t sampleCount() const { return countX() * countY(); }
+};
+
+
+// Optional per-vertex scalars a surface carries next to its positions, for colormapping
+enum class ScalarChannel : uint32_t {
+    Height,   // z = f(x, y)
+    Slope,    // gradient magnitude |grad f|
+    Curvature // mean curvature of the height field
+};
+static constexpr size_t SCALAR_CHANNEL_COUNT = 3;
+static constexpr uint32_t ALL_SCALAR_CHANNELS = (1u << SCALAR_CHANNEL_COUNT) - 1;
+
+inline uint32_t channelBit(ScalarChannel channel) { return 1u << static_cast<uint32_t>(channel); }
+
+
+// Min/max over the finite values of a channel; empty (min > max) until something was included
+struct ScalarRange {
+    float min = std::numeric_limits<float>::infinity();
+    float max = -std::numeric_limits<float>::infinity();
+
+    bool isValid() const { return min <= max; }
+    void include(float value) {
+        if (std::isfinite(value)) {
+            min = std::min(min, value);
+            max = std::max(max, value);
+        }
+    }
+    void merge(const ScalarRange& other) {
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
+    }
+    bool operator==(const ScalarRange& other) const { return min == other.min && max == other.max; }
+    bool operator!=(const ScalarRange& other) const { return !(*this == other); }
+};
+
+using ScalarRanges = std::array<ScalarRange, SCALAR_CHANNEL_COUNT>;
+
+
+// CPU side result of sampling z = f(x, y) over a domain.
+// Points are stored as (x, z, y) so that the surface's height maps to the world up axis.
+struct SampleGrid {
+    uint64_t generation = 0; // which rebuild request produced this grid
+    bool preview = false;    // coarse stand-in, replaced once the full resolution grid lands
+    SampleDomain domain;
+    std::vector<glm::vec3> points;
+
+    uint32_t channels = 0;      // ScalarChannel bits present in scalars
+    std::vector<float> scalars; // one block of points.size() values per present channel, in channel order
+    ScalarRanges ranges;        // auto range of every present channel, indexed by ScalarChannel
+
+    bool hasChannel(ScalarChannel channel) const { return (channels & channelBit(channel)) != 0; }
+    // Index of the channel's first value in scalars
+    size_t channelStart(ScalarChannel channel) const {
+        size_t block = 0;
+        for (uint32_t bit = 1; bit < channelBit(channel); bit <<= 1) {
+            block += (channels & bit) != 0 ? 1 : 0;
+        }
+        return block * points.size();
+    }
+    // Allocates the blocks of `present` channels; call once points is sized
+    void resizeChannels(uint32_t present) {
+        channels = present & ALL_SCALAR_CHANNELS;
+        size_t blocks = 0;
+        for (uint32_t bits = channels; bits != 0; bits &= bits - 1) {
+            ++blocks;
+        }
+        scalars.assign(blocks * points.size(), 0.0f);
+        ranges = ScalarRanges();
+    }
+
+    // As uploaded: the points, then the scalar blocks
+    size_t pointBytes() const { return points.size() * sizeof(glm::vec3); }
+    size_t byteSize() const { return pointBytes() + scalars.size() * sizeof(float); }
+    bool empty() const { return points.empty(); }
+};
+
+
+// Writes a grid into a vertex buffer (a GLBuffer; a template so this header stays free of GL)
+// in the layout Equation draws from: the points, then the scalar blocks.
+template<typename Buffer>
+void uploadSampleGrid(Buffer& buffer, const SampleGrid& grid) {
+    if (grid.scalars.empty()) {
+        buffer.setData(grid.points);
+        return;
+    }
+    buffer.resize(grid.byteSize());
+    buffer.updateData(grid.points);
+    buffer.updateData(grid.scalars, grid.pointBytes());
+}
+
+
+// Samples rows [rowBegin, rowEnd) of an already sized grid. Rows never overlap,
+// so disjoint row ranges can be filled from different threads.
+template<typename Fn>
+void sampleSurfaceRows(Fn&& f, SampleGrid& grid, size_t rowBegin, size_t rowEnd) {
+    const SampleDomain& domain = grid.domain;
+    const size_t columns = domain.countY();
+    for (size_t i = rowBegin; i < rowEnd; ++i) {
+        float x = domain.xMin + static_cast<float>(i) * domain.step;
+        glm::vec3* row = grid.points.data() + i * columns;
+        for (size_t j = 0; j < columns; ++j) {
+            float y = domain.yMin + static_cast<float>(j) * domain.step;
+            row[j] = glm::vec3(x, f(x, y), y);
+        }
+    }
+}
+
+// Fills the scalar channels of rows [rowBegin, rowEnd) from already sampled points. The
+// differences reach one row further on each side, so every row has to be sampled first;
+// after that disjoint row ranges can run on different threads. Returns the range of each
+// channel over these rows, for the caller to reduce.
+inline ScalarRanges computeScalarRows(SampleGrid& grid, size_t rowBegin, size_t rowEnd) {
+    ScalarRanges ranges;
+    const size_t rows = grid.domain.countX();
+    const size_t columns = grid.domain.countY();
+    if (grid.channels == 0 || grid.points.size() < rows * columns) {
+        return ranges;
+    }
+    const glm::vec3* points = grid.points.data();
+    float* height = grid.hasChannel(ScalarChannel::Height) ? &grid.scalars[grid.channelStart(ScalarChannel::Height)] : nullptr;
+    float* slope = grid.hasChannel(ScalarChannel::Slope) ? &grid.scalars[grid.channelStart(ScalarChannel::Slope)] : nullptr;
+    float* curvature = grid.hasChannel(ScalarChannel::Curvature) ? &grid.scalars[grid.channelStart(ScalarChannel::Curvature)] : nullptr;
+    const float step = grid.domain.step;
+    for (size_t i = rowBegin; i < rowEnd; ++i) {
+        //central differences, one sided at the edges
+        size_t i0 = i > 0 ? i - 1 : i;
+        size_t i1 = i + 1 < rows ? i + 1 : i;
+        for (size_t j = 0; j < columns; ++j) {
+            size_t j0 = j > 0 ? j - 1 : j;
+            size_t j1 = j + 1 < columns ? j + 1 : j;
+            const size_t k = i * columns + j;
+            const float z = points[k].y;
+            if (height != nullptr) {
+                height[k] = z;
+                ranges[static_cast<size_t>(ScalarChannel::Height)].include(z);
+            }
+            if (slope == nullptr && curvature == nullptr) {
+                continue;
+            }
+            float fx = i1 > i0 ? (points[i1 * columns + j].y - points[i0 * columns + j].y) / (static_cast<float>(i1 - i0) * step) : 0.0f;
+            float fy = j1 > j0 ? (points[i * columns + j1].y - points[i * columns + j0].y) / (static_cast<float>(j1 - j0) * step) : 0.0f;
+            if (slope != nullptr) {
+                slope[k] = std::sqrt(fx * fx + fy * fy);
+                ranges[static_cast<size_t>(ScalarChannel::Slope)].include(slope[k]);
+            }
+            if (curvature != nullptr) {
+                //second derivatives need both neighbours, edges are taken as flat across
+                float fxx = i0 < i && i < i1 ? (points[i1 * columns + j].y - 2.0f * z + points[i0 * columns + j].y) / (step * step) : 0.0f;
+                float fyy = j0 < j && j < j1 ? (points[i * columns + j1].y - 2.0f * z + points[i * columns + j0].y) / (step * step) : 0.0f;
+                float fxy = i1 > i0 && j1 > j0 ?
+                    (points[i1 * columns + j1].y - points[i1 * columns + j0].y - points[i0 * columns + j1].y + points[i0 * columns + j0].y) /
+                    (static_cast<float>((i1 - i0) * (j1 - j0)) * step * step) : 0.0f;
+                float g = 1.0f + fx * fx + fy * fy;
+                curvature[k] = ((1.0f + fy * fy) * fxx - 2.0f * fx * fy * fxy + (1.0f + fx * fx) * fyy) / (2.0f * g * std::sqrt(g));
+                ranges[static_cast<size_t>(ScalarChannel::Curvature)].include(curvature[k]);
+            }
+        }
+    }
+    return ranges;
+}
+
+// Sizes and fills the scalar channels of a sampled grid, with their ranges, on the calling thread
+inline void computeScalarChannels(SampleGrid& grid, uint32_t channels) {
+    grid.resizeChannels(channels);
+    if (grid.channels != 0) {
+        grid.ranges = computeScalarRows(grid, 0, grid.domain.countX());
+    }
+}
+
+// Samples f over the whole domain on the calling thread. Pure CPU work, safe to call from any thread.
+template<typename Fn>
+SampleGrid sampleSurface(Fn&& f, const SampleDomain& domain, uint64_t generation = 0) {
+    SampleGrid grid;
+    grid.generation = generation;
+    grid.domain = domain;
+    grid.points.resize(domain.sampleCount());
+    sampleSurfaceRows(f, grid, 0, domain.countX());
+    return grid;
+}
+
+#endif // SAMPLE_GRID_H
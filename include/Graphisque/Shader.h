@@ -8,14 +8,33 @@ class Shader
 {
 public:
     unsigned int ID;
+    // Self-contained files only; shaders with #include or variants go through ShaderVariants
     Shader(const char *vertexPath, const char *fragmentPath);
     // Shader(const char *vertexPath, const char *includePath, const char *fragmentPath);
+    // Adopts a program linked elsewhere (see ShaderVariants)
+    explicit Shader(unsigned int program);
+
+    // The steps of the constructor, for building many programs without waiting on each.
+    // compileStage doesn't query the result, so the driver is free to compile in the background.
+    static unsigned int compileStage(GLenum type, const char *source);
+    // Print the info log and return false on failure; `label` names the sources in the message
+    static bool checkStage(unsigned int shader, const char *label);
+    static bool checkProgram(unsigned int program, const char *label);
 
     void use();
 
     void setBool(const std::string &name, bool value) const;
     void setFloat(const std::string &name, float value) const;
+    void setVec2(const std::string &name, const glm::vec2 &value) const;
     void setVec3(const std::string &name, const glm::vec3 &value) const;
     void setMat4(const std::string &name, const glm::mat4 &mat) const;
     void setInt(const std::string &name, int value) const;
+
+    // Same as above without building a std::string; use these from per-frame code
+    void setBool(const char *name, bool value) const;
+    void setFloat(const char *name, float value) const;
+    void setVec2(const char *name, const glm::vec2 &value) const;
+    void setVec3(const char *name, const glm::vec3 &value) const;
+    void setMat4(const char *name, const glm::mat4 &mat) const;
+    void setInt(const char *name, int value) const;
 };
\ No newline at end of file
@@ -0,0 +1,71 @@
+#ifndef SHADER_LIBRARY_H
+#define SHADER_LIBRARY_H
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+
+// One file of shaders/, compiled into the binary by cmake/EmbedShaders.cmake
+struct EmbeddedShader {
+    const char* name;
+    const char* source;
+};
+
+#ifdef GRAPHISQUE_EMBED_SHADERS
+extern const EmbeddedShader EMBEDDED_SHADERS[];
+extern const size_t EMBEDDED_SHADER_COUNT;
+#endif
+
+// name, value ("" for a bare #define)
+using ShaderDefines = std::vector<std::pair<std::string, std::string>>;
+
+
+// GLSL sources by name ("vertex.vert", "transform.glsl") and a small preprocessor on top.
+//
+// With GRAPHISQUE_EMBED_SHADERS every file of shaders/ is already in the binary, so looking
+// a shader up never touches the disk; names that aren't embedded (or every name, without
+// the option) are read from the shader directory once and kept.
+//
+// preprocess() expands `#include "name"` (relative to the including file; a file that was
+// already included is skipped, which also breaks cycles) and puts the defines right after
+// #version. #line directives keep compiler messages pointing at the original files: source
+// string 0 is the shader itself, includes are numbered in the order they appear in `files`.
+class ShaderLibrary {
+    public:
+        static ShaderLibrary& instance();
+
+        // Where non-embedded shaders are read from, "./shaders" by default
+        void setDirectory(const std::string& directory);
+        // Adds or replaces a source; wins over the embedded copy (tools, hot reload)
+        void addSource(const std::string& name, std::string source);
+        // False when the shader is neither embedded nor readable
+        bool source(const std::string& name, std::string& out);
+
+        // Throws std::runtime_error for unknown shaders and malformed #includes
+        std::string preprocess(const std::string& name, const ShaderDefines& defines,
+                               std::vector<std::string>* files = nullptr);
+
+        // Stable text form of a define set, for program cache keys
+        static std::string definesKey(const ShaderDefines& defines);
+
+    private:
+        struct Expansion {
+            std::string out;
+            std::vector<std::string> files;
+            size_t versionEnd = std::string::npos; // where the defines go
+            size_t versionLine = 1;                // first line after #version
+        };
+
+        ShaderLibrary();
+        void expand(const std::string& name, Expansion& expansion);
+
+        std::mutex _mutex;
+        std::string _directory = "./shaders";
+        std::unordered_map<std::string, std::string> _sources;
+};
+
+#endif // SHADER_LIBRARY_H
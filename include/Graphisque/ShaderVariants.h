@@ -0,0 +1,93 @@
+#ifndef SHADER_VARIANTS_H
+#define SHADER_VARIANTS_H
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Shader.h"
+#include "ShaderLibrary.h"
+
+
+// Builds the permutations of a vertex/fragment pair from ShaderLibrary sources.
+//
+// request() preprocesses a variant and starts compiling it without waiting for the result,
+// so requesting every variant a scene may need up front lets the driver compile them side
+// by side (with GL_KHR_parallel_shader_compile on its own threads). The program is linked
+// on the first get(), which only blocks if the driver isn't done yet; isReady() tells
+// beforehand when the extension is there. Programs come from ProgramCache when possible,
+// which skips compiling altogether.
+//
+// Owns the GL objects of every variant, so it lives with the context (GL thread only).
+class ShaderVariants {
+    public:
+        // Permutations of the scene shaders; each set bit becomes a #define of the same name
+        enum Feature : uint32_t {
+            Heightfield = 1u << 0, // attribute 0 is a height, x/z come from the grid (see transform.glsl)
+            Lit = 1u << 1,         // diffuse shading from screen space derivative normals
+            Wireframe = 1u << 2,   // flat wireColor, for an overlay pass in line mode
+            Instanced = 1u << 3,   // per instance model matrix in attributes 3-6
+            Colormap = 1u << 4     // attribute 1 is a scalar, colored through a ColormapTexture
+        };
+        static constexpr size_t FEATURE_COUNT = 5;
+
+        using Features = uint32_t;
+        using VariantId = uint32_t;
+
+        static ShaderDefines defines(Features features);
+
+        ShaderVariants() = default;
+        ShaderVariants(const ShaderVariants&) = delete;
+        ShaderVariants& operator=(const ShaderVariants&) = delete;
+
+        // Call with the glad loader once the context is current
+        void loadFunctions(GLADloadproc loader);
+        bool hasParallelCompile() const { return _maxCompilerThreads != nullptr; }
+
+        // The same sources and features always give the same id
+        VariantId request(const std::string& vertex, const std::string& fragment, Features features = 0);
+        // Links on first use; a variant that failed to build has program 0
+        std::shared_ptr<Shader> get(VariantId id);
+        std::shared_ptr<Shader> get(const std::string& vertex, const std::string& fragment, Features features = 0) {
+            return get(request(vertex, fragment, features));
+        }
+        // Whether get() would return without waiting on the driver
+        bool isReady(VariantId id) const;
+
+        size_t variantCount() const { return _variants.size(); }
+        size_t linkedCount() const;
+
+        // Deletes every program and pending shader; the context must still be current
+        void release();
+
+    private:
+        typedef void (APIENTRYP MaxShaderCompilerThreadsProc)(GLuint count);
+
+        enum class State {
+            Compiling,
+            Linked,
+            Failed
+        };
+
+        struct Variant {
+            std::string vertex;
+            std::string fragment;
+            Features features = 0;
+            uint64_t cacheKey = 0;
+            GLuint vertexShader = 0;
+            GLuint fragmentShader = 0;
+            GLuint program = 0;
+            State state = State::Compiling;
+            std::shared_ptr<Shader> shader;
+        };
+
+        void link(Variant& variant);
+        std::string label(const Variant& variant) const;
+
+        std::vector<Variant> _variants;
+        MaxShaderCompilerThreadsProc _maxCompilerThreads = nullptr;
+};
+
+#endif // SHADER_VARIANTS_H
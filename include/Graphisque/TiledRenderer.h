@@ -0,0 +1,68 @@
+#ifndef TILED_RENDERER_H
+#define TILED_RENDERER_H
+
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "FrameScheduler.h"
+#include "GLFramebuffer.h"
+#include "PngWriter.h"
+
+
+// Renders an image far larger than any framebuffer by drawing it tile by tile.
+//
+// Each tile is drawn into the same tileSize x tileSize framebuffer with the scene's
+// projection narrowed to that tile's part of the view (see tileProjection), read back,
+// and copied into a stripe one tile high. Finished stripes go straight into a streaming
+// PNG, so memory stays at one tile plus one stripe whatever the output size.
+//
+// Everything runs on the GL thread. renderNextTile() draws one tile per call so the
+// work fits into FrameScheduler slices.
+class TiledRenderer {
+    public:
+        // Draws the scene with the given projection into the bound framebuffer
+        using DrawFn = std::function<void(const glm::mat4& projection)>;
+
+        TiledRenderer(const std::string& path, int width, int height, int tileSize = 2048);
+        ~TiledRenderer();
+
+        TiledRenderer(const TiledRenderer&) = delete;
+        TiledRenderer& operator=(const TiledRenderer&) = delete;
+
+        // GL thread: clamps the tile size to what the driver supports, creates the tile
+        // framebuffer and opens the output
+        bool begin();
+        TaskStatus renderNextTile(const glm::mat4& projection, const DrawFn& draw);
+
+        bool failed() const { return _failed; }
+        int tilesDone() const { return _nextTile; }
+        int tileCount() const { return _columns * _rows; }
+
+        // Narrows `projection` to the image rectangle [x, x + size) x [y, y + size) of a
+        // width x height image, y measured from the top
+        static glm::mat4 tileProjection(const glm::mat4& projection, int x, int y, int size, int width, int height);
+
+    private:
+        std::string _path;
+        int _width;
+        int _height;
+        int _tileSize;
+        int _columns = 0;
+        int _rows = 0;
+        int _nextTile = 0;
+        bool _failed = false;
+
+        std::unique_ptr<GLFramebuffer> _tile;
+        std::vector<uint8_t> _tilePixels;
+        std::vector<uint8_t> _stripe; // tileSize rows of the full image width
+        FILE* _file = nullptr;
+        PngStreamWriter _png;
+
+        void fail(const std::string& message);
+};
+
+#endif // TILED_RENDERER_H
@@ -0,0 +1,57 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+#include <cstdint>
+
+
+// Single-writer / single-reader mailbox with three slots.
+// The writer always has a private slot to fill, the reader always has a private
+// slot to read, and the third slot is exchanged atomically between them. Neither
+// side ever waits on the other; if the writer publishes faster than the reader
+// consumes, intermediate values are simply overwritten.
+//
+// Slots are reused, so containers inside T keep their capacity between frames.
+template<typename T>
+class TripleBuffer {
+    private:
+        static constexpr uint8_t INDEX_MASK = 0x3;
+        static constexpr uint8_t FRESH_BIT = 0x4; // shared slot holds data the reader hasn't seen
+
+        T _slots[3];
+        std::atomic<uint8_t> _shared;
+        uint8_t _back;  // writer owned
+        uint8_t _front; // reader owned
+
+    public:
+        TripleBuffer() : _shared(1), _back(0), _front(2) {}
+
+        TripleBuffer(const TripleBuffer&) = delete;
+        TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+        // Writer side: fill this slot, then publish() it
+        T& writeBuffer() { return _slots[_back]; }
+
+        void publish() {
+            uint8_t previous = _shared.exchange(static_cast<uint8_t>(_back | FRESH_BIT), std::memory_order_acq_rel);
+            _back = previous & INDEX_MASK;
+        }
+
+        // Reader side: grabs the most recently published slot; returns false if nothing new arrived
+        bool acquire() {
+            if ((_shared.load(std::memory_order_relaxed) & FRESH_BIT) == 0) {
+                return false;
+            }
+            uint8_t previous = _shared.exchange(_front, std::memory_order_acq_rel);
+            _front = previous & INDEX_MASK;
+            return true;
+        }
+
+        bool hasFresh() const {
+            return (_shared.load(std::memory_order_acquire) & FRESH_BIT) != 0;
+        }
+
+        const T& readBuffer() const { return _slots[_front]; }
+};
+
+#endif // TRIPLE_BUFFER_H
@@ -0,0 +1,66 @@
+#ifndef UI_LAYER_H
+#define UI_LAYER_H
+
+#include "imgui/imgui.h"
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+struct GLFWwindow;
+
+
+// Copy of one ImGui frame's output, detached from the ImGui context so another thread can draw it.
+// Storage is kept between frames; copying a frame does not allocate once it has warmed up.
+struct UiDrawData {
+    bool valid = false;
+    ImVec2 displayPos;
+    ImVec2 displaySize;
+    ImVec2 framebufferScale;
+    std::vector<std::unique_ptr<ImDrawList>> lists;
+    int listCount = 0;
+    int totalVtxCount = 0;
+    int totalIdxCount = 0;
+    // Only set when ImGui has texture uploads/destroys for the renderer; see UiLayer::render
+    ImVector<ImTextureData*>* textures = nullptr;
+};
+
+
+// Owns the ImGui context and the GLFW/OpenGL3 backends.
+// The UI is built on the main thread (beginFrame/endFrame) and drawn on whichever thread
+// owns the GL context (render). Texture updates are the one thing the two sides share;
+// when ImGui has any, the main thread waits for the renderer to process them before it
+// starts the next UI frame, however long that takes. That only happens when the font
+// atlas changes. A render thread that stops calls rendererStopped() so the wait ends.
+class UiLayer {
+    private:
+        bool _initialized = false;
+        ImDrawData _renderDrawData; // render thread scratch, reused every frame
+
+        std::mutex _textureMutex;
+        std::condition_variable _textureCv;
+        bool _texturesInFlight = false;
+        bool _rendererStopped = false;
+
+        void releaseTextures(const UiDrawData& data);
+
+    public:
+        // The GL context must be current on the calling thread
+        bool init(GLFWwindow* window, const char* glslVersion = "#version 330");
+        void shutdown();
+
+        // Main thread
+        void beginFrame();
+        void endFrame(UiDrawData& out);
+
+        // GL thread
+        void render(const UiDrawData& data);
+        // GL thread, once it stops rendering frames
+        void rendererStopped();
+
+        bool isInitialized() const { return _initialized; }
+        bool wantsMouse() const { return _initialized && ImGui::GetIO().WantCaptureMouse; }
+        bool wantsKeyboard() const { return _initialized && ImGui::GetIO().WantCaptureKeyboard; }
+};
+
+#endif // UI_LAYER_H
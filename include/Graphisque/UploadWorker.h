@@ -0,0 +1,81 @@
+#ifndef UPLOAD_WORKER_H
+#define UPLOAD_WORKER_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "GLBuffer.h"
+#include "LockFreeQueue.h"
+#include "SampleGrid.h"
+
+
+// A finished upload handed back to the render thread.
+// The grid travels back with the buffer so the owner can keep its CPU copy.
+struct CompletedUpload {
+    SampleGrid grid;
+    std::unique_ptr<VertexBuffer> buffer;
+    GLsync fence = nullptr;
+};
+
+
+// Uploads sample grids into vertex buffers on a second GL context that shares
+// objects with the main window, so glBufferData never runs on the render thread.
+//
+// start() has to be called from the main thread (GLFW only creates windows there).
+// submit() may be called from any thread; pollCompleted() must be called on the
+// thread that owns the main context.
+class UploadWorker {
+    private:
+        GLFWwindow* _sharedWindow;  // main window whose context we share objects with
+        GLFWwindow* _uploadWindow;  // hidden 1x1 window owning the worker context
+
+        LockFreeQueue<SampleGrid> _pending;
+        LockFreeQueue<CompletedUpload> _completed;
+        std::vector<CompletedUpload> _inFlight; // render thread only, waiting on fences
+
+        std::thread _thread;
+        std::atomic<bool> _running;
+        std::mutex _wakeMutex;  // only used to park the worker, never on the data path
+        std::condition_variable _wakeCv;
+        std::function<void()> _onUploaded; // called on the worker thread after each upload is queued
+        std::atomic<uint64_t> _currentGeneration{0}; // queued grids older than this are skipped
+
+        void workerLoop();
+        void releaseUpload(CompletedUpload& upload);
+
+    public:
+        explicit UploadWorker(GLFWwindow* sharedWindow, size_t queueCapacity = 16);
+        ~UploadWorker();
+
+        UploadWorker(const UploadWorker&) = delete;
+        UploadWorker& operator=(const UploadWorker&) = delete;
+
+        bool start();
+        void stop();
+        bool isRunning() const { return _running.load(std::memory_order_acquire); }
+
+        // Set before start(); lets the owner wake its loop when something is ready to poll
+        void setOnUploaded(std::function<void()> callback) { _onUploaded = std::move(callback); }
+
+        // Uploads handed back but whose fence has not signalled yet (render thread only)
+        size_t inFlight() const { return _inFlight.size(); }
+
+        // Returns false if the queue is full, in which case the grid is left untouched
+        bool submit(SampleGrid& grid);
+        // Grids of older rebuilds still in the queue are dropped instead of uploaded; any thread
+        void setCurrentGeneration(uint64_t generation) { _currentGeneration.store(generation, std::memory_order_relaxed); }
+
+        // Non-blocking: checks fences of in-flight uploads and hands every signalled one to onReady.
+        // A failed upload comes back with a null buffer and its grid, to be uploaded some other way.
+        // Returns the number of uploads delivered.
+        size_t pollCompleted(const std::function<void(CompletedUpload&)>& onReady);
+};
+
+#endif // UPLOAD_WORKER_H
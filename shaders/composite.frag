@@ -0,0 +1,41 @@
+#version 330 core
+// Upscales the scene target to the window with contrast adaptive sharpening, which brings
+// back some of the detail bilinear filtering loses when the scene is rendered smaller.
+out vec4 FragColor;
+
+in vec2 screenUv;
+
+uniform sampler2D sceneColor;
+uniform vec2 sourceSize;  // texels of sceneColor the scene was drawn into, from the bottom left
+uniform float sharpness;  // 0 plain bilinear, 1 strongest
+
+
+vec3 sceneAt(vec2 texel, vec2 texelSize)
+{
+    // stay inside the drawn part, the rest of the texture is stale
+    texel = clamp(texel, vec2(0.5f), sourceSize - 0.5f);
+    return texture(sceneColor, texel * texelSize).rgb;
+}
+
+void main()
+{
+    vec2 texelSize = 1.0f / vec2(textureSize(sceneColor, 0));
+    vec2 texel = screenUv * sourceSize;
+    vec3 center = sceneAt(texel, texelSize);
+    if (sharpness <= 0.0f) {
+        FragColor = vec4(center, 1.0f);
+        return;
+    }
+    vec3 north = sceneAt(texel + vec2(0.0f, 1.0f), texelSize);
+    vec3 south = sceneAt(texel - vec2(0.0f, 1.0f), texelSize);
+    vec3 east = sceneAt(texel + vec2(1.0f, 0.0f), texelSize);
+    vec3 west = sceneAt(texel - vec2(1.0f, 0.0f), texelSize);
+
+    // less sharpening where the local contrast is already high, so edges don't ring
+    vec3 low = min(center, min(min(north, south), min(east, west)));
+    vec3 high = max(center, max(max(north, south), max(east, west)));
+    vec3 amount = sqrt(clamp(min(low, 1.0f - high) / max(high, vec3(1e-4f)), 0.0f, 1.0f));
+    vec3 weight = amount * (-1.0f / mix(8.0f, 5.0f, clamp(sharpness, 0.0f, 1.0f)));
+    vec3 color = (center + (north + south + east + west) * weight) / (1.0f + 4.0f * weight);
+    FragColor = vec4(clamp(color, 0.0f, 1.0f), 1.0f);
+}
@@ -0,0 +1,11 @@
+#version 330 core
+// Full screen triangle without vertex data; draw 3 vertices with an empty VAO
+
+out vec2 screenUv;
+
+void main()
+{
+    vec2 corner = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2));
+    screenUv = corner;
+    gl_Position = vec4(corner * 2.0f - 1.0f, 0.0f, 1.0f);
+}
@@ -1,11 +1,48 @@
 #version 330 core
 out vec4 FragColor;
 
+in vec3 worldPosition;
 
 uniform vec3 objectColor;
 
+#ifdef LIT
+uniform vec3 lightDirection = vec3(0.3f, 1.0f, 0.5f);
+#endif
+
+#ifdef WIREFRAME
+uniform vec3 wireColor;
+#endif
+
+#ifdef COLORMAP
+in float scalar;
+uniform sampler1DArray colormap; // one layer per colormap, see ColormapTexture
+uniform float colormapLayer;
+uniform float scalarMin;
+uniform float scalarMax;
+#endif
+
 
 void main()
 {
-    FragColor = vec4(objectColor, 1.0f);
-}
\ No newline at end of file
+#ifdef WIREFRAME
+    // overlay pass, drawn in line mode on top of the filled surface
+    FragColor = vec4(wireColor, 1.0f);
+#else
+    vec3 color = objectColor;
+#ifdef COLORMAP
+    // samples without a value (next to a hole in the domain) keep the flat color
+    if (!isnan(scalar) && !isinf(scalar)) {
+        float t = clamp((scalar - scalarMin) / max(scalarMax - scalarMin, 1e-6f), 0.0f, 1.0f);
+        // texel centres, so both ends of the range hit the ends of the colormap
+        float width = float(textureSize(colormap, 0).x);
+        color = texture(colormap, vec2((t * (width - 1.0f) + 0.5f) / width, colormapLayer)).rgb;
+    }
+#endif
+#ifdef LIT
+    // face normal from the derivatives of the position, no normal attribute needed
+    vec3 normal = normalize(cross(dFdx(worldPosition), dFdy(worldPosition)));
+    color *= 0.3f + 0.7f * abs(dot(normal, normalize(lightDirection)));
+#endif
+    FragColor = vec4(color, 1.0f);
+#endif
+}
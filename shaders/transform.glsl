@@ -0,0 +1,33 @@
+// Where a vertex of the scene ends up; shared by the scene vertex shaders.
+// Included after #version, see ShaderLibrary.
+
+uniform mat4 model; 
+uniform mat4 view; 
+uniform mat4 projection; 
+
+#ifdef INSTANCED
+layout (location = 3) in mat4 instanceModel; // locations 3-6, one per instance
+#endif
+
+#ifdef HEIGHTFIELD
+// Samples in SampleGrid order: row i has x = origin.x + i * step, column j has z = origin.y + j * step
+uniform vec2 gridOrigin;
+uniform float gridStep;
+uniform int gridColumns;
+
+vec3 heightfieldPosition(float height)
+{
+    int row = gl_VertexID / gridColumns;
+    int column = gl_VertexID - row * gridColumns;
+    return vec3(gridOrigin.x + float(row) * gridStep, height, gridOrigin.y + float(column) * gridStep);
+}
+#endif
+
+mat4 modelMatrix()
+{
+#ifdef INSTANCED
+    return model * instanceModel;
+#else
+    return model;
+#endif
+}
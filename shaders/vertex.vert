@@ -1,11 +1,30 @@
 #version 330 core 
+#include "transform.glsl"
+
+#ifdef HEIGHTFIELD
+layout (location = 0) in float aHeight; 
+#else
 layout (location = 0) in vec3 aPos; 
+#endif
+
+#ifdef COLORMAP
+layout (location = 1) in float aScalar; // the displayed channel of SampleGrid::scalars
+out float scalar;
+#endif
 
-uniform mat4 model; 
-uniform mat4 view; 
-uniform mat4 projection; 
+out vec3 worldPosition;
 
 void main() 
 {
-    gl_Position =   projection * view * model *   vec4(aPos, 1.0f);
+#ifdef HEIGHTFIELD
+    vec3 position = heightfieldPosition(aHeight);
+#else
+    vec3 position = aPos;
+#endif
+    vec4 world = modelMatrix() * vec4(position, 1.0f);
+    worldPosition = world.xyz;
+#ifdef COLORMAP
+    scalar = aScalar;
+#endif
+    gl_Position =   projection * view * world;
 }
@@ -0,0 +1,275 @@
+#include "AllocationTracker.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include "Profiler.h"
+
+
+static const char* const NO_SCOPE = "(no scope)";
+static const char* const OTHER_SCOPES = "(other scopes)";
+
+static thread_local int t_forbidden = 0;
+
+
+// One per thread, allocated with malloc and never freed: the hooks cannot call operator new
+// for it, and totals() still has to see the counts of threads that have exited.
+// Only the owning thread writes, anyone may read.
+struct ThreadAllocations {
+    static constexpr size_t SCOPE_SLOTS = 64;
+
+    struct Slot {
+        std::atomic<const char*> name{nullptr};
+        std::atomic<uint64_t> allocations{0};
+        std::atomic<uint64_t> bytes{0};
+    };
+
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> frees{0};
+    std::atomic<uint64_t> bytes{0};
+    Slot scopes[SCOPE_SLOTS];
+    Slot overflow;
+    ThreadAllocations* next = nullptr;
+};
+
+static std::atomic<ThreadAllocations*> g_threads{nullptr};
+
+
+static ThreadAllocations& threadAllocations() {
+    static thread_local ThreadAllocations* block = nullptr;
+    if (block == nullptr) {
+        void* memory = std::malloc(sizeof(ThreadAllocations));
+        if (memory == nullptr) {
+            std::abort();
+        }
+        block = new (memory) ThreadAllocations();
+        block->next = g_threads.load(std::memory_order_relaxed);
+        while (!g_threads.compare_exchange_weak(block->next, block, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+    }
+    return *block;
+}
+
+static void bump(std::atomic<uint64_t>& counter, uint64_t amount) {
+    //single writer, so no read-modify-write needed
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+// Scope names are string literals, so the pointer is the key
+static ThreadAllocations::Slot& scopeSlot(ThreadAllocations& block, const char* name) {
+    size_t start = (reinterpret_cast<uintptr_t>(name) >> 3) % ThreadAllocations::SCOPE_SLOTS;
+    for (size_t i = 0; i < ThreadAllocations::SCOPE_SLOTS; ++i) {
+        ThreadAllocations::Slot& slot = block.scopes[(start + i) % ThreadAllocations::SCOPE_SLOTS];
+        const char* current = slot.name.load(std::memory_order_relaxed);
+        if (current == name) {
+            return slot;
+        }
+        if (current == nullptr) {
+            slot.name.store(name, std::memory_order_release);
+            return slot;
+        }
+    }
+    return block.overflow;
+}
+
+
+void AllocationTracker::recordAllocation(size_t size) {
+    const char* scope = Profiler::threadScope();
+    if (t_forbidden > 0) {
+        t_forbidden = 0; // whatever reports this may allocate itself
+        std::fprintf(stderr, "(AllocationTracker) %zu byte allocation in scope '%s' while allocations are forbidden\n",
+                     size, scope != nullptr ? scope : NO_SCOPE);
+        std::abort();
+    }
+    ThreadAllocations& block = threadAllocations();
+    bump(block.allocations, 1);
+    bump(block.bytes, size);
+    ThreadAllocations::Slot& slot = scopeSlot(block, scope != nullptr ? scope : NO_SCOPE);
+    bump(slot.allocations, 1);
+    bump(slot.bytes, size);
+}
+
+void AllocationTracker::recordFree() {
+    bump(threadAllocations().frees, 1);
+}
+
+AllocationCounts AllocationTracker::totals() {
+    AllocationCounts counts;
+    for (ThreadAllocations* block = g_threads.load(std::memory_order_acquire); block != nullptr; block = block->next) {
+        counts.allocations += block->allocations.load(std::memory_order_relaxed);
+        counts.frees += block->frees.load(std::memory_order_relaxed);
+        counts.bytes += block->bytes.load(std::memory_order_relaxed);
+    }
+    return counts;
+}
+
+AllocationCounts AllocationTracker::threadTotals() {
+    AllocationCounts counts;
+    if (!isEnabled()) {
+        return counts;
+    }
+    ThreadAllocations& block = threadAllocations();
+    counts.allocations = block.allocations.load(std::memory_order_relaxed);
+    counts.frees = block.frees.load(std::memory_order_relaxed);
+    counts.bytes = block.bytes.load(std::memory_order_relaxed);
+    return counts;
+}
+
+std::pmr::vector<AllocationTracker::ScopeEntry> AllocationTracker::scopes(std::pmr::memory_resource* resource) {
+    std::pmr::vector<ScopeEntry> entries(resource);
+    auto add = [&entries](const char* name, const ThreadAllocations::Slot& slot) {
+        uint64_t allocations = slot.allocations.load(std::memory_order_relaxed);
+        if (allocations == 0) {
+            return;
+        }
+        auto it = std::find_if(entries.begin(), entries.end(), [name](const ScopeEntry& e) { return e.name == name; });
+        if (it == entries.end()) {
+            entries.push_back({name, AllocationCounts{}});
+            it = entries.end() - 1;
+        }
+        it->counts.allocations += allocations;
+        it->counts.bytes += slot.bytes.load(std::memory_order_relaxed);
+    };
+    for (ThreadAllocations* block = g_threads.load(std::memory_order_acquire); block != nullptr; block = block->next) {
+        for (const ThreadAllocations::Slot& slot : block->scopes) {
+            const char* name = slot.name.load(std::memory_order_acquire);
+            if (name != nullptr) {
+                add(name, slot);
+            }
+        }
+        add(OTHER_SCOPES, block->overflow);
+    }
+    std::sort(entries.begin(), entries.end(), [](const ScopeEntry& a, const ScopeEntry& b) {
+        return a.counts.allocations > b.counts.allocations;
+    });
+    return entries;
+}
+
+void AllocationTracker::setForbidden(bool forbidden) {
+    t_forbidden = forbidden ? 1 : 0;
+}
+
+bool AllocationTracker::isForbidden() {
+    return t_forbidden > 0;
+}
+
+
+#ifdef GRAPHISQUE_TRACK_ALLOCATIONS
+
+// Replacements for every form of the global allocation functions; the ones not listed
+// (placement new) cannot be replaced.
+
+static void* trackedAllocate(size_t size) {
+    if (size == 0) {
+        size = 1;
+    }
+    for (;;) {
+        if (void* memory = std::malloc(size)) {
+            AllocationTracker::recordAllocation(size);
+            return memory;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+static void* trackedAllocateAligned(size_t size, std::align_val_t alignment) {
+    size_t align = static_cast<size_t>(alignment);
+    //aligned_alloc wants a multiple of the alignment
+    size_t rounded = (std::max<size_t>(size, 1) + align - 1) / align * align;
+    for (;;) {
+#ifdef _WIN32
+        void* memory = _aligned_malloc(rounded, align);
+#else
+        void* memory = std::aligned_alloc(align, rounded);
+#endif
+        if (memory != nullptr) {
+            AllocationTracker::recordAllocation(size);
+            return memory;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+static void trackedFree(void* memory) {
+    if (memory != nullptr) {
+        AllocationTracker::recordFree();
+        std::free(memory);
+    }
+}
+
+static void trackedFreeAligned(void* memory) {
+    if (memory != nullptr) {
+        AllocationTracker::recordFree();
+#ifdef _WIN32
+        _aligned_free(memory);
+#else
+        std::free(memory);
+#endif
+    }
+}
+
+
+void* operator new(size_t size) { return trackedAllocate(size); }
+void* operator new[](size_t size) { return trackedAllocate(size); }
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return trackedAllocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return trackedAllocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new(size_t size, std::align_val_t alignment) { return trackedAllocateAligned(size, alignment); }
+void* operator new[](size_t size, std::align_val_t alignment) { return trackedAllocateAligned(size, alignment); }
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try {
+        return trackedAllocateAligned(size, alignment);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try {
+        return trackedAllocateAligned(size, alignment);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* memory) noexcept { trackedFree(memory); }
+void operator delete[](void* memory) noexcept { trackedFree(memory); }
+void operator delete(void* memory, size_t) noexcept { trackedFree(memory); }
+void operator delete[](void* memory, size_t) noexcept { trackedFree(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { trackedFree(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { trackedFree(memory); }
+
+void operator delete(void* memory, std::align_val_t) noexcept { trackedFreeAligned(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { trackedFreeAligned(memory); }
+void operator delete(void* memory, size_t, std::align_val_t) noexcept { trackedFreeAligned(memory); }
+void operator delete[](void* memory, size_t, std::align_val_t) noexcept { trackedFreeAligned(memory); }
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept { trackedFreeAligned(memory); }
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept { trackedFreeAligned(memory); }
+
+#endif
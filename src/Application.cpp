@@ -1,6 +1,18 @@
 #include "Application.h"
 
 #include "Equations.h"
+#include "AllocationTracker.h"
+#include "Logger.h"
+#include "ResidencyManager.h"
+#include "GLResourceManager.h"
+#include "ProgramCache.h"
+#include "MemoryArena.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <optional>
+#include <glm/gtc/constants.hpp>
 
 
 
@@ -19,14 +31,22 @@ Application* Application::getApplicationPtr(GLFWwindow* window) {
 
 bool Application::init() { 
 
-    //Initialize GLFW and create a window
     std::cout << "Initializing application..." << std::endl; 
-    initGLFW();
-    //Load OpenGL functions using GLAD
-    if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc> (glfwGetProcAddress))) {
-        std::cerr << "Failed to initialize GLAD!" << std::endl; 
-        return false; 
-    } 
+    if(_headless) { 
+        if(!initHeadless()) { 
+            return false;
+        }
+    } else { 
+        //Initialize GLFW and create a window
+        initGLFW();
+        //Load OpenGL functions using GLAD
+        if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc> (glfwGetProcAddress))) {
+            std::cerr << "Failed to initialize GLAD!" << std::endl; 
+            return false; 
+        } 
+        ProgramCache::instance().loadFunctions(reinterpret_cast<GLADloadproc> (glfwGetProcAddress));
+        _shaderVariants.loadFunctions(reinterpret_cast<GLADloadproc> (glfwGetProcAddress));
+    }
     glViewport(0, 0, WIN_WIDTH, WIN_HEIGHT); // Set the viewport to the window size
     glEnable(GL_DEPTH_TEST); // Enable depth testing for 3D rendering
     _isCursorHidden = true;
@@ -36,11 +56,27 @@ bool Application::init() {
 
     activeCamera = orbitCamera;
 
+    _jobs = std::make_unique<JobSystem>();
+
     initShader();
+    if(_headless) { 
+        //no window: no input, no UI, and no second context to upload on
+        GpuProfiler::instance().init();
+        initGrid3D();
+        std::cout << "Application initialized (headless)!" << std::endl;
+        return true;
+    }
     setupCallbacks();
     initImgui();
     std::cout << "Application initialized!" << std::endl;
     initGrid3D();
+
+    _uploadWorker = std::make_unique<UploadWorker>(window);
+    _uploadWorker->setOnUploaded([this]() { markDirty(); });
+    if(!_uploadWorker->start()) { 
+        std::cerr << "Upload worker unavailable, uploading on the main thread" << std::endl;
+        _uploadWorker.reset();
+    }
     return true;
 }
 
@@ -52,7 +88,7 @@ bool Application::initGLFW() {
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE,GLFW_OPENGL_CORE_PROFILE);
-    glfwWindowHint(GLFW_SAMPLES, 4);
+    glfwWindowHint(GLFW_SAMPLES, 0); // the scene target is multisampled, the window doesn't need to be
 
     //create window
     this->window = glfwCreateWindow(WIN_WIDTH, WIN_HEIGHT, title.c_str(), nullptr, nullptr); 
@@ -68,13 +104,61 @@ bool Application::initGLFW() {
     return true;
 }
 
+void Application::setHeadless(int width, int height) { 
+    _headless = true;
+    WIN_WIDTH = width;
+    WIN_HEIGHT = height;
+    _threadedRendering = false;
+    _loopMode = RenderLoopMode::Continuous;
+    _resolutionSettings.dynamic = false; // timing dependent output otherwise
+}
+
+bool Application::initHeadless() { 
+    _headlessContext = std::make_unique<HeadlessContext>();
+    if(!_headlessContext->create(3, 3) || !_headlessContext->makeCurrent()) { 
+        std::cerr << "Failed to create a headless OpenGL context!" << std::endl;
+        return false;
+    }
+    if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc> (HeadlessContext::getProcAddress))) {
+        std::cerr << "Failed to initialize GLAD!" << std::endl; 
+        return false; 
+    } 
+    ProgramCache::instance().loadFunctions(reinterpret_cast<GLADloadproc> (HeadlessContext::getProcAddress));
+    _shaderVariants.loadFunctions(reinterpret_cast<GLADloadproc> (HeadlessContext::getProcAddress));
+    try { 
+        _offscreenTarget = std::make_unique<GLFramebuffer>(WIN_WIDTH, WIN_HEIGHT);
+    } catch (const std::exception& e) { 
+        std::cerr << "Failed to create the offscreen framebuffer: " << e.what() << std::endl;
+        return false;
+    }
+    std::cout << "Headless context: " << _headlessContext->getDescription() << ", "
+              << glGetString(GL_RENDERER) << ", " << WIN_WIDTH << "x" << WIN_HEIGHT << std::endl;
+    return true;
+}
+
+glm::mat4 Application::projectionFor(int width, int height) const { 
+    return glm::perspective(glm::radians(45.0f), (float)width / (float)height, 0.1f, 100.0f);
+}
+
+double Application::elapsedSeconds() const { 
+    if(_headless) { 
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - _startTime).count();
+    }
+    return glfwGetTime();
+}
+
 bool Application::initShader() { 
     try {
-        _mainShader = std::make_shared<Shader>("./shaders/vertex.vert", "./shaders/fragment.frag");
+        //only what the scene draws with: the colormap variant compiles alongside the base, so
+        //turning the colors on later won't stall, but only the base links now
+        _shaderVariants.request("vertex.vert", "fragment.frag");
+        _shaderVariants.request("vertex.vert", "fragment.frag", ShaderVariants::Colormap);
+        _mainShader = _shaderVariants.get("vertex.vert", "fragment.frag");
         glm::mat4 projection = glm::perspective(glm::radians(45.0f),  (float) WIN_WIDTH /  WIN_HEIGHT, 0.1f, 100.0f);
         _mainShader->use();
         _mainShader->setMat4("model", glm::mat4(1.0f));
         _mainShader->setMat4("projection", projection);
+        _colormaps = std::make_unique<ColormapTexture>();
         std::cout << "Shader initialized successfully!" << std::endl;
 
         return true;
@@ -89,91 +173,777 @@ void Application::initGrid3D() {
     // GridConfig config;
     // grid3D = std::make_shared<Grid3D>(config, _mainShader);
 
-    axes = std::make_unique<Axes>(10.0f, 0.1f, 0.8f, 0.4f,true);
-    equation= std::make_unique<Equation>();
+    //scene objects are built a slice per frame so the window shows up before they are done
+    _equationDomain = SampleDomain{-lim, lim, -lim, lim, 0.25f};
+    _frameScheduler.enqueue("axes", [this]() {
+        axes = std::make_unique<Axes>(10.0f, 0.1f, 0.8f, 0.4f,true);
+        return TaskStatus::Done;
+    });
+    //the first surface is sampled a tile of rows per slice, then goes through the chunked upload
+    struct FirstSample { 
+        SampleGrid grid;
+        size_t row = 0;
+        size_t scalarRow = 0;
+    };
+    auto state = std::make_shared<FirstSample>();
+    _frameScheduler.enqueue("equation", [this, state]() {
+        if(!equation) { 
+            equation= std::make_unique<Equation>();
+            //an evicted surface comes back through the normal background rebuild
+            equation->setRegenerator([this]() { requestEquationRebuild(); });
+            SampleGrid& grid = state->grid;
+            grid.generation = equation->nextGeneration();
+            grid.domain = equation->getDomain();
+            grid.points.resize(grid.domain.sampleCount());
+            grid.resizeChannels(equation->getChannels());
+            return TaskStatus::Continue;
+        }
+        SampleGrid& grid = state->grid;
+        if(!equation->accepts(grid)) { 
+            return TaskStatus::Done; // a rebuild was requested meanwhile and replaces this one
+        }
+        const size_t rows = grid.domain.countX();
+        if(state->row < rows) { 
+            size_t end = std::min(state->row + SAMPLE_TILE_ROWS, rows);
+            sampleSurfaceRows(equation->getFunction(), grid, state->row, end);
+            state->row = end;
+            return TaskStatus::Continue;
+        }
+        //scalar differences read neighbouring rows, so they start once every row is sampled
+        if(grid.channels != 0 && state->scalarRow < rows) { 
+            size_t end = std::min(state->scalarRow + SAMPLE_TILE_ROWS, rows);
+            ScalarRanges ranges = computeScalarRows(grid, state->scalarRow, end);
+            for(size_t channel = 0; channel < SCALAR_CHANNEL_COUNT; ++channel) { 
+                grid.ranges[channel].merge(ranges[channel]);
+            }
+            state->scalarRow = end;
+            return TaskStatus::Continue;
+        }
+        scheduleChunkedUpload(std::move(grid));
+        return TaskStatus::Done;
+    });
 }
 
 bool Application::initImgui() {
-    ImGui::CreateContext();
-    ImGui_ImplGlfw_InitForOpenGL(window, true);
+    if(!_ui.init(window, "#version 330")) { 
+        std::cerr << "Failed to initialize ImGui!" << std::endl;
+        return false;
+    }
+    GpuProfiler::instance().init();
     return true;
 }
 
 
 
 void Application::processInput(float deltaTime) { 
-    if (glfwGetKey(this->window, GLFW_KEY_ESCAPE) == GLFW_PRESS) { 
+    GRAPHISQUE_PROFILE_FUNCTION();
+    if (isKeyDown(GLFW_KEY_ESCAPE) && this->window) { 
         glfwSetWindowShouldClose(this->window, true); 
         
     }
+    bool moved = false;
     if(_isDevCamEnabled) { 
-        if(glfwGetKey(this->window, GLFW_KEY_W) == GLFW_PRESS) { 
+        if(isKeyDown(GLFW_KEY_W)) { 
             devCamera->handleCameraMovement(FORWARD, deltaTime);
+            moved = true;
 
         } 
-        if(glfwGetKey(this->window, GLFW_KEY_S) == GLFW_PRESS) { 
+        if(isKeyDown(GLFW_KEY_S)) { 
             devCamera->handleCameraMovement(BACKWARD, deltaTime);
+            moved = true;
         }
-        if(glfwGetKey(this->window, GLFW_KEY_A) == GLFW_PRESS) { 
+        if(isKeyDown(GLFW_KEY_A)) { 
             devCamera->handleCameraMovement(LEFT, deltaTime);
+            moved = true;
         }
-        if(glfwGetKey(this->window, GLFW_KEY_D) == GLFW_PRESS) { 
+        if(isKeyDown(GLFW_KEY_D)) { 
             devCamera->handleCameraMovement(RIGHT, deltaTime);
+            moved = true;
         }   
-        if(glfwGetKey(this->window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS) { 
+        if(isKeyDown(GLFW_KEY_LEFT_SHIFT)) { 
             devCamera->handleCameraMovement(DOWN, deltaTime);
+            moved = true;
         }   
-        if(glfwGetKey(this->window,GLFW_KEY_SPACE ) == GLFW_PRESS) { 
+        if(isKeyDown(GLFW_KEY_SPACE)) { 
             devCamera->handleCameraMovement(UP, deltaTime);
+            moved = true;
         }   
-        if(glfwGetKey(this->window,GLFW_KEY_H) == GLFW_PRESS) { 
+        if(isKeyDown(GLFW_KEY_H)) { 
+        }
+    }
+    if(moved) { 
+        markDirty(); // keeps the loop running for as long as a movement key is held
+    }
+
+}
+
+
+void Application::renderFrame(const FrameSnapshot& snapshot){ 
+    GRAPHISQUE_PROFILE_SCOPE("Frame");
+    GpuProfiler::instance().beginFrame();
+    _capture.poll();
+    if(_offscreenTarget) { 
+        _offscreenTarget->bind();
+    }
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); // Clear the color and depth
+
+    _frameScheduler.runFrame();
+
+    //scene state changes that need GL work happen here, on the context thread
+    if(equation) { 
+        //a colored surface carries every channel, so switching channels later never resamples;
+        //they stay on once used, turning the colors off doesn't rebuild anything
+        uint32_t channels = equation->getChannels() | (snapshot.colorMapping.enabled ? ALL_SCALAR_CHANNELS : 0u);
+        if(snapshot.equationDomain != equation->getDomain() || channels != equation->getChannels()) { 
+            equation->setDomain(snapshot.equationDomain);
+            equation->setChannels(channels);
+            requestEquationRebuild();
         }
     }
+    processCompletedUploads();
+
+    //the newest camera, taken after the frame's GL work and before drawing starts
+    glm::mat4 view = snapshot.view;
+    glm::mat4 projection = snapshot.projection;
+    int frameWidth = snapshot.framebufferWidth, frameHeight = snapshot.framebufferHeight;
+    _frameInputTime = snapshot.inputTime;
+    if(snapshot.lowLatency) { 
+        LatchedCamera latched = latchCamera();
+        view = latched.view;
+        _frameInputTime = latched.inputTime;
+        if(latched.framebufferHeight > 0) { // a minimized window keeps the last projection
+            projection = latched.projection;
+            frameWidth = latched.framebufferWidth;
+            frameHeight = latched.framebufferHeight;
+        }
+    }
+    if(frameWidth != _viewportWidth || frameHeight != _viewportHeight) { 
+        _viewportWidth = frameWidth;
+        _viewportHeight = frameHeight;
+        glViewport(0, 0, _viewportWidth, _viewportHeight);
+    }
+
+    //new work arrives above; from here on a settled frame only draws, which must not allocate
+    _settledFrames = isSceneSettled() ? _settledFrames + 1 : 0;
+    std::optional<NoAllocationScope> noAllocations;
+    if(_assertNoAllocations && _settledFrames > 8) { 
+        noAllocations.emplace();
+    }
+
+    uint32_t turntableFrames = _turntableFrames.load();
+    if(turntableFrames > 0 && !_capture.isActive()) { 
+        turntableFrames = 0; // the recording was stopped before the turn was done
+        _turntableRendered = 0;
+        _turntableFrames = 0;
+    }
+    if(turntableFrames > 0) { 
+        float angle = glm::two_pi<float>() * static_cast<float>(_turntableRendered) / static_cast<float>(turntableFrames);
+        view = view * glm::rotate(glm::mat4(1.0f), angle, glm::vec3(0.0f, 1.0f, 0.0f));
+    }
+    //the scene goes to a scaled target when it can, the UI always to the full size frame
+    bool scaled = _dynamicResolution.begin(frameWidth, frameHeight, snapshot.resolution, _shaderVariants);
+    drawScene(snapshot, view, projection);
+    if(scaled) { 
+        GRAPHISQUE_PROFILE_SCOPE("Composite");
+        _dynamicResolution.composite(_offscreenTarget ? _offscreenTarget->getId() : 0);
+    }
+    ResidencyManager::instance().endFrame();
+    //buffers released this frame (evictions, swapped meshes, the upload thread) go back to the pool
+    GLResourceManager::instance().processDeletions();
+    //captures show the scene without the UI on top
+    bool captured = _capture.readback(frameWidth, frameHeight);
+    //a dropped frame keeps its angle, the next frame tries it again
+    if(turntableFrames > 0 && captured && ++_turntableRendered == turntableFrames) { 
+        _turntableRendered = 0;
+        _turntableFrames = 0;
+        _capture.end();
+    }
+    drawUi(snapshot);
+    GpuProfiler::instance().endFrame();
+    RenderStats::instance().endFrame(snapshot.frameIndex);
+}
+
 
+void Application::drawScene(const FrameSnapshot& snapshot, const glm::mat4& view, const glm::mat4& projection) { 
+    GRAPHISQUE_PROFILE_SCOPE("Scene");
+    GRAPHISQUE_PROFILE_GPU_SCOPE("Scene");
+    _mainShader->use();
+    _mainShader->setMat4("view", view);
+    _mainShader->setMat4("projection", projection);
+    for(const DrawCommand& command : snapshot.drawList) { 
+        switch(command.target) { 
+            case DrawTarget::Axes:
+                if(axes) { 
+                    axes->draw(_mainShader);
+                }
+                break;
+            case DrawTarget::Equation:
+                if(equation) { 
+                    drawEquation(snapshot.colorMapping, view, projection);
+                }
+                break;
+        }
+    }
 }
 
 
-void Application::render(float deltaTime){ 
-    // std::cout << "Rendering..." << std::endl;    
-    // grid3D->render(*devCamera);
-    // cube->render(*devCamera);
-    axes->draw(_mainShader);
-    equation->draw(_mainShader);
+void Application::drawEquation(const ColorMapping& mapping, const glm::mat4& view, const glm::mat4& projection) { 
+    //flat color until the mesh with the channels is in (or when it can't be colored at all)
+    if(!mapping.enabled || !_colormaps || !equation->showChannel(mapping.channel)) { 
+        equation->draw(_mainShader);
+        return;
+    }
+    if(!_colormapShader) { 
+        _colormapShader = _shaderVariants.get("vertex.vert", "fragment.frag", ShaderVariants::Colormap);
+    }
+    if(_colormapShader->ID == 0) { 
+        equation->draw(_mainShader);
+        return;
+    }
+    ScalarRange range = mapping.autoRange ? equation->channelRange(mapping.channel) : mapping.range;
+    _shownRangeMin = range.min;
+    _shownRangeMax = range.max;
+    if(!range.isValid()) { 
+        range = ScalarRange{0.0f, 1.0f}; // nothing finite to map, any range does
+    }
+    //everything the colors depend on is a uniform; the mesh is untouched
+    _colormaps->bind(0);
+    _colormapShader->use();
+    _colormapShader->setMat4("view", view);
+    _colormapShader->setMat4("projection", projection);
+    _colormapShader->setInt("colormap", 0);
+    _colormapShader->setFloat("colormapLayer", static_cast<float>(mapping.colormap));
+    _colormapShader->setFloat("scalarMin", range.min);
+    _colormapShader->setFloat("scalarMax", range.max);
+    equation->draw(_colormapShader);
+    _mainShader->use();
+}
+
 
+void Application::drawUi(const FrameSnapshot& snapshot) { 
+    GRAPHISQUE_PROFILE_SCOPE("UI");
+    GRAPHISQUE_PROFILE_GPU_SCOPE("UI");
+    //ImGui's backend switches to fill mode itself but restores our wireframe state afterwards
+    _ui.render(snapshot.ui);
 }
 
 
+void Application::buildSnapshot(FrameSnapshot& snapshot) { 
+    snapshot.frameIndex = _frameIndex++;
+    snapshot.time = elapsedSeconds();
+    snapshot.framebufferWidth = WIN_WIDTH;
+    snapshot.framebufferHeight = WIN_HEIGHT;
+    if(WIN_HEIGHT > 0) { // minimized windows report a 0x0 framebuffer
+        projection = projectionFor(WIN_WIDTH, WIN_HEIGHT);
+        devCamera->setProjectionMatrix(projection);
+    }
+    snapshot.projection = projection;
+    snapshot.view = activeCamera->getViewMatrix();
+    //low latency frames take their input with the camera when they draw, not here
+    snapshot.lowLatency = _lowLatency && window != nullptr && !_replaying;
+    if(snapshot.lowLatency) { 
+        publishCamera();
+        snapshot.inputTime = 0.0;
+    } else { 
+        snapshot.inputTime = takeInputTime();
+    }
+    snapshot.equationDomain = _equationDomain;
+    snapshot.colorMapping = _colorMapping;
+    snapshot.resolution = _resolutionSettings;
 
-void Application::run() { 
-    std::cout << "Running application..." << std::endl; 
+    snapshot.drawList.clear(); // keeps its capacity, slots are reused
+    snapshot.drawList.push_back({DrawTarget::Axes});
+    snapshot.drawList.push_back({DrawTarget::Equation});
+
+    Profiler::instance().collect();
+    if(_ui.isInitialized()) { 
+        GRAPHISQUE_PROFILE_SCOPE("Build UI");
+        _ui.beginFrame();
+        _profilerOverlay.draw();
+        ResolutionSettings resolution = _resolutionSettings;
+        if(_statsOverlay.draw(resolution, _dynamicResolution.scale(), _dynamicResolution.gpuMs())) { 
+            setResolutionSettings(resolution);
+            snapshot.resolution = _resolutionSettings;
+        }
+        if(_colormapOverlay.draw(_colorMapping, ScalarRange{_shownRangeMin.load(), _shownRangeMax.load()})) { 
+            snapshot.colorMapping = _colorMapping;
+        }
+        _ui.endFrame(snapshot.ui);
+    }
+    if(_profilerOverlay.isVisible() || _statsOverlay.isVisible() || _colormapOverlay.isVisible()) { 
+        markDirty(); // the panels are live while they are open
+    }
+}
+
+
+void Application::publishSnapshot() { 
+    buildSnapshot(_frameMailbox.writeBuffer());
+    _frameMailbox.publish();
+    {
+        std::lock_guard<std::mutex> lock(_frameMutex);
+    }
+    _frameCv.notify_one();
+    //every run loop (windowed, threaded, headless, replay) ends its iteration here, and the
+    //snapshot never points into the frame arena
+    ArenaResource::frame().reset();
+}
+
+
+void Application::setupRenderState() { 
     glEnable(GL_LINE_SMOOTH);
     glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
-
-    lastFrame = static_cast<float>(glfwGetTime());
     glPolygonMode(GL_FRONT_AND_BACK , GL_LINE);
+}
+
+
+void Application::run() { 
+    std::cout << "Running application..." << std::endl; 
+    Profiler::instance().setThreadName("main");
+    lastFrame = static_cast<float>(elapsedSeconds());
+    if(_headless) { 
+        renderOffscreen();
+    } else if(_threadedRendering) { 
+        runThreaded();
+    } else { 
+        runSingleThreaded();
+    }
+}
+
+
+void Application::markDirty() { 
+    if(!_frameDirty.exchange(true) && !_headless) { 
+        glfwPostEmptyEvent();
+    }
+}
+
+
+bool Application::hasPendingRenderWork() const { 
+    return !_frameScheduler.idle() || (_uploadWorker && _uploadWorker->inFlight() > 0) ||
+           _capture.isActive() || _turntableFrames.load() > 0;
+}
+
+
+bool Application::isSceneSettled() const { 
+    return axes && equation && equation->isShowingFinal() && !hasPendingRenderWork() && _readyGrids.empty();
+}
+
+
+int Application::renderOffscreen(int maxFrames) { 
+    if(!_headless) { 
+        std::cerr << "(renderOffscreen) Application is not headless" << std::endl;
+        return 0;
+    }
+    setupRenderState();
+    int frames = 0;
+    while(frames < maxFrames) { 
+        publishSnapshot();
+        _frameMailbox.acquire();
+        renderFrame(_frameMailbox.readBuffer());
+        ++frames;
+        if(isSceneSettled()) { 
+            break;
+        }
+        //let the sampling jobs run instead of spinning on empty frames
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    glFinish();
+    return frames;
+}
+
+
+bool Application::startCapture(const std::string& path, int fps) { 
+    if(!_capture.begin(path, FrameCapture::formatForPath(path), fps)) { 
+        return false;
+    }
+    markDirty();
+    return true;
+}
+
+
+bool Application::captureScreenshot(const std::string& path) { 
+    if(!_capture.begin(path, CaptureFormat::Png, 30, 1)) { 
+        return false;
+    }
+    markDirty();
+    return true;
+}
+
+
+bool Application::recordTurntable(const std::string& path, uint32_t frames, int fps) { 
+    //no frame limit on the session: dropped frames count towards it, the turn ends it instead
+    if(frames == 0 || !_capture.begin(path, FrameCapture::formatForPath(path), fps)) { 
+        return false;
+    }
+    _turntableFrames = frames;
+    markDirty();
+    return true;
+}
+
+
+void Application::requestPoster(const std::string& path, int width, int height, int tileSize) { 
+    //the view is frozen now; tiles are drawn over the next frames on the render side
+    auto renderer = std::make_shared<TiledRenderer>(path, width, height, tileSize);
+    auto frame = std::make_shared<FrameSnapshot>();
+    frame->view = activeCamera->getViewMatrix();
+    frame->projection = projectionFor(width, height);
+    frame->drawList = {{DrawTarget::Axes}, {DrawTarget::Equation}};
+    frame->colorMapping = _colorMapping;
+    auto started = std::make_shared<bool>(false);
+
+    _frameScheduler.enqueue("poster", [this, renderer, frame, started]() {
+        if(!*started) { 
+            *started = true;
+            if(!renderer->begin()) { 
+                return TaskStatus::Done;
+            }
+        }
+        TaskStatus status = renderer->renderNextTile(frame->projection, [this, &frame](const glm::mat4& tileProjection) {
+            drawScene(*frame, frame->view, tileProjection);
+        });
+        //back to the frame's own target
+        glBindFramebuffer(GL_FRAMEBUFFER, _offscreenTarget ? _offscreenTarget->getId() : 0);
+        glViewport(0, 0, _viewportWidth, _viewportHeight);
+        return status;
+    });
+    markDirty();
+}
+
+
+bool Application::readPixels(std::vector<uint8_t>& rgba) const { 
+    if(!_offscreenTarget) { 
+        return false;
+    }
+    _offscreenTarget->readPixels(rgba);
+    return true;
+}
+
+
+bool Application::startInputRecording(const std::string& path) { 
+    return _recorder.begin(path, WIN_WIDTH, WIN_HEIGHT, elapsedSeconds());
+}
+
+
+void Application::recordInput(const InputEvent& event) { 
+    if(_recorder.isActive() && !_replaying) { 
+        _recorder.record(event, elapsedSeconds());
+    }
+}
+
+
+void Application::setSampleStep(float step) { 
+    InputEvent event;
+    event.type = InputEventType::Command;
+    event.code = static_cast<int>(SceneCommand::SampleStep);
+    event.value = step;
+    recordInput(event);
+    _equationDomain.step = std::min(std::max(step, 0.01f), 2.0f);
+    markDirty();
+}
+
+
+void Application::setColorMapping(const ColorMapping& mapping) { 
+    _colorMapping = mapping;
+    markDirty();
+}
+
+
+void Application::setLowLatency(bool enabled, int maxQueuedFrames) { 
+    _lowLatency = enabled;
+    _framePacer.setMaxQueuedFrames(enabled ? maxQueuedFrames : 0);
+    markDirty();
+}
+
+
+void Application::noteInput() { 
+    std::lock_guard<std::mutex> lock(_latchMutex);
+    if(_pendingInputTime == 0.0) { 
+        _pendingInputTime = elapsedSeconds();
+    }
+}
+
+
+void Application::publishCamera() { 
+    std::lock_guard<std::mutex> lock(_latchMutex);
+    _latched.view = activeCamera->getViewMatrix();
+    _latched.projection = projection;
+    _latched.framebufferWidth = WIN_WIDTH;
+    _latched.framebufferHeight = WIN_HEIGHT;
+    if(_latched.inputTime == 0.0) { 
+        _latched.inputTime = _pendingInputTime;
+    }
+    _pendingInputTime = 0.0;
+}
+
+
+double Application::takeInputTime() { 
+    std::lock_guard<std::mutex> lock(_latchMutex);
+    double inputTime = _pendingInputTime;
+    _pendingInputTime = 0.0;
+    return inputTime;
+}
+
+
+Application::LatchedCamera Application::latchCamera() { 
+    if(!_threadedRendering && window) { 
+        //this is the main thread, but no event dispatch here: callbacks could change the scene,
+        //start captures or allocate mid-frame. Only the cursor's latest position moves the
+        //camera (it is recorded with the next cursor event, whose offset is then smaller).
+        double x = 0.0, y = 0.0;
+        glfwGetCursorPos(window, &x, &y);
+        if((_isDevCamEnabled || _isDragging) && !_firstMouse && (static_cast<float>(x) != _lastX || static_cast<float>(y) != _lastY)) { 
+            noteInput();
+            onCursorPos(x, y);
+        }
+        publishCamera();
+    }
+    //the threaded main thread publishes the camera on every snapshot, up to 240 times a second
+    std::lock_guard<std::mutex> lock(_latchMutex);
+    LatchedCamera latched = _latched;
+    _latched.inputTime = 0.0;
+    return latched;
+}
+
+
+void Application::setResolutionSettings(const ResolutionSettings& settings) { 
+    ResolutionSettings& resolution = _resolutionSettings;
+    resolution = settings;
+    resolution.minScale = std::min(std::max(resolution.minScale, 0.1f), 2.0f);
+    resolution.maxScale = std::min(std::max(resolution.maxScale, resolution.minScale), 2.0f);
+    resolution.scale = std::min(std::max(resolution.scale, 0.1f), 2.0f);
+    resolution.targetMs = std::max(resolution.targetMs, 0.5f);
+    resolution.samples = std::min(std::max(resolution.samples, 0), 16);
+    resolution.sharpness = std::min(std::max(resolution.sharpness, 0.0f), 1.0f);
+    markDirty();
+}
+
+
+void Application::applyInputEvent(const InputEvent& event) { 
+    switch(event.type) { 
+        case InputEventType::Key:
+            onKey(event.code, event.action, event.mods);
+            break;
+        case InputEventType::MouseButton:
+            onMouseButton(event.code, event.action, event.mods, event.x, event.y);
+            break;
+        case InputEventType::CursorPos:
+            onCursorPos(event.x, event.y);
+            break;
+        case InputEventType::FramebufferSize:
+            applyReplaySize(static_cast<int>(event.x), static_cast<int>(event.y));
+            break;
+        case InputEventType::Command:
+            if(event.code == static_cast<int>(SceneCommand::SampleStep)) { 
+                setSampleStep(event.value);
+            }
+            break;
+    }
+}
+
+
+void Application::applyReplaySize(int width, int height) { 
+    if(width <= 0 || height <= 0) { 
+        return;
+    }
+    if(_offscreenTarget) { 
+        _offscreenTarget->resize(width, height);
+    } else if(window) { 
+        //the framebuffer size callback follows; on HiDPI screens it may differ from the request
+        glfwSetWindowSize(window, width, height);
+        glfwPollEvents();
+        return;
+    }
+    WIN_WIDTH = width;
+    WIN_HEIGHT = height;
+}
+
+
+void Application::renderReplayFrame() { 
+    publishSnapshot();
+    _frameMailbox.acquire();
+    renderFrame(_frameMailbox.readBuffer());
+    if(window) { 
+        glfwSwapBuffers(window);
+        glfwPollEvents(); // keeps the window responsive; the input itself is ignored
+    }
+    //the frame time includes the GPU work, not just its submission
+    glFinish();
+}
+
+
+FrameTimeSummary Application::replayInput(const std::string& path, double timestep) { 
+    InputReplay replay;
+    if(!replay.load(path) || timestep <= 0.0) { 
+        return {};
+    }
+    Profiler::instance().setThreadName("main");
+    if(window) { 
+        glfwSwapInterval(0); // measure the frame, not the display's refresh rate
+    }
+    _replaying = true;
+    applyReplaySize(replay.getWidth(), replay.getHeight());
+    setupRenderState();
+
+    //start every run from the same, fully built scene
+    for(int i = 0; i < 600 && !isSceneSettled(); ++i) { 
+        renderReplayFrame();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    const std::vector<InputEvent>& events = replay.getEvents();
+    const size_t ticks = static_cast<size_t>(std::ceil(replay.getDuration() / timestep)) + 1;
+    std::vector<double> frameMs;
+    frameMs.reserve(ticks);
+    size_t next = 0;
+    for(size_t tick = 1; tick <= ticks; ++tick) { 
+        if(window && glfwWindowShouldClose(window)) { 
+            break;
+        }
+        auto start = std::chrono::steady_clock::now();
+        //everything that happened before the end of this tick, then one fixed step
+        const double tickEnd = static_cast<double>(tick) * timestep;
+        while(next < events.size() && events[next].time < tickEnd) { 
+            applyInputEvent(events[next++]);
+        }
+        processInput(static_cast<float>(timestep));
+        renderReplayFrame();
+        frameMs.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    _replaying = false;
+    return FrameTimeSummary::from(std::move(frameMs));
+}
+
+
+void Application::runSingleThreaded() { 
+    setupRenderState();
     while(!glfwWindowShouldClose(this->window)) {
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); // Clear the color and depth
+        if(_loopMode == RenderLoopMode::OnDemand && !_frameDirty.exchange(false)) { 
+            glfwWaitEventsTimeout(_idleTimeout);
+            continue;
+        }
+        if(_lowLatency) { 
+            glfwPollEvents(); // this frame shows the input that arrived while the last one was presented
+        }
 
         //Process input
         float currentFrame = static_cast<float>(glfwGetTime());
-        deltaTime = currentFrame - lastFrame;
+        deltaTime = std::min(currentFrame - lastFrame, 0.1f); // don't jump after sleeping
         lastFrame = currentFrame; 
         processInput(deltaTime);
 
-        _mainShader->use();
-        _mainShader->setMat4("view",activeCamera->getViewMatrix());
-        render(deltaTime);
+        publishSnapshot();
+        _frameMailbox.acquire();
+        renderFrame(_frameMailbox.readBuffer());
+        if(hasPendingRenderWork()) { 
+            markDirty();
+        }
+
+        if(!_lowLatency) { 
+            glfwPollEvents();
+        }
+        glfwSwapBuffers(window); // Swap the front and back buffers
+        _framePacer.endFrame(_frameInputTime, elapsedSeconds());
+    }
+}
 
 
-        glfwPollEvents();
+void Application::runThreaded() { 
+    //hand the context over to the render thread
+    glfwMakeContextCurrent(nullptr);
+    _renderRunning = true;
+    _renderThread = std::thread(&Application::renderThreadLoop, this);
+
+    //main thread: events, input and simulation only; never waits on the GPU
+    const double tickInterval = 1.0 / 240.0;
+    while(!glfwWindowShouldClose(this->window)) {
+        bool idle = _loopMode == RenderLoopMode::OnDemand && !_frameDirty.load();
+        glfwWaitEventsTimeout(idle ? _idleTimeout : tickInterval);
+
+        float currentFrame = static_cast<float>(glfwGetTime());
+        deltaTime = std::min(currentFrame - lastFrame, 0.1f); // don't jump after sleeping
+        lastFrame = currentFrame; 
+        processInput(deltaTime);
+
+        if(_loopMode == RenderLoopMode::Continuous || _frameDirty.exchange(false)) { 
+            publishSnapshot();
+        }
+    }
+
+    _renderRunning = false;
+    {
+        std::lock_guard<std::mutex> lock(_frameMutex);
+    }
+    _frameCv.notify_one();
+    _renderThread.join();
+
+    //take the context back so GL objects are released on this thread
+    glfwMakeContextCurrent(window);
+}
+
+
+void Application::renderThreadLoop() { 
+    Profiler::instance().setThreadName("render");
+    glfwMakeContextCurrent(window);
+    setupRenderState();
+    while(_renderRunning) { 
+        {
+            std::unique_lock<std::mutex> lock(_frameMutex);
+            _frameCv.wait_for(lock, std::chrono::milliseconds(100), [this] {
+                return !_renderRunning || _frameMailbox.hasFresh();
+            });
+        }
+        if(!_frameMailbox.acquire()) { 
+            continue;
+        }
+        try { 
+            renderFrame(_frameMailbox.readBuffer());
+            if(hasPendingRenderWork()) { 
+                markDirty(); // ask the main thread for another snapshot
+            }
+        } catch (const std::exception& e) { 
+            std::cerr << "(renderThread) Frame failed: " << e.what() << std::endl;
+            glfwSetWindowShouldClose(window, true);
+            glfwPostEmptyEvent();
+            break;
+        }
         glfwSwapBuffers(window); // Swap the front and back buffers
+        _framePacer.endFrame(_frameInputTime, elapsedSeconds());
     }
+    //a main thread waiting for this thread to upload ImGui's textures would wait forever
+    _ui.rendererStopped();
+    glfwMakeContextCurrent(nullptr);
 }
 
 
 
 
 Application::~Application() { 
+    //workers may still be delivering into the upload worker, stop them first
+    _rebuildToken.cancel();
+    if(_jobs) { 
+        _jobs->shutdown();
+    }
+    if(_uploadWorker) { 
+        _uploadWorker->stop();
+    }
+    _capture.shutdown();
+    if(_capture.framesDropped() > 0) { 
+        std::cerr << "Frame capture dropped " << _capture.framesDropped() << " frames" << std::endl;
+    }
+    GpuProfiler::instance().shutdown();
+    _ui.shutdown();
+    //GL objects go before the context that owns them
+    equation.reset();
+    axes.reset();
+    _colormapShader.reset();
+    _colormaps.reset();
+    _dynamicResolution.release();
+    _framePacer.release();
+    _shaderVariants.release();
+    GLResourceManager::instance().shutdown();
+    if(_headlessContext) { 
+        _offscreenTarget.reset();
+        _headlessContext->destroy();
+    }
     std::cout << "Application stopped!" << std::endl; 
 }
 
@@ -209,6 +979,141 @@ void Application::updateViewMatrix()  const{
 }
 
 
+void Application::requestEquationRebuild() { 
+    GRAPHISQUE_PROFILE_FUNCTION();
+    //whatever is still queued for the previous request is stale now
+    _rebuildToken.cancel();
+    _rebuildToken = CancellationToken();
+    _rebuildGeneration = equation->nextGeneration();
+    if(_uploadWorker) { 
+        _uploadWorker->setCurrentGeneration(_rebuildGeneration);
+    }
+    auto deliver = [this](SampleGrid&& grid) { deliverGrid(std::move(grid)); };
+
+    //dense grids get a coarse preview first so something shows up right away
+    const size_t previewThreshold = 64 * 1024;
+    SampleDomain domain = equation->getDomain();
+    JobPriority fullPriority = JobPriority::VisibleNow;
+    if(domain.sampleCount() > previewThreshold) { 
+        SampleDomain previewDomain = domain;
+        previewDomain.step *= 4.0f;
+        equation->scheduleSample(*_jobs, previewDomain, true, JobPriority::VisibleNow, _rebuildToken, deliver);
+        fullPriority = JobPriority::Refine;
+    }
+    equation->scheduleSample(*_jobs, domain, false, fullPriority, _rebuildToken, deliver);
+}
+
+
+void Application::deliverGrid(SampleGrid&& grid) { 
+    //sampling jobs finish on worker threads; results of an older request aren't worth a queue slot
+    if(grid.generation < _rebuildGeneration.load()) { 
+        return;
+    }
+    if(_uploadWorker && _uploadWorker->submit(grid)) { 
+        return;
+    }
+    if(!_readyGrids.tryPush(grid)) { 
+        //both queues are full of older work; keep the newest grid aside, a full one over its preview
+        std::lock_guard<std::mutex> lock(_overflowMutex);
+        bool newer = !_hasOverflowGrid || grid.generation > _overflowGrid.generation ||
+                     (grid.generation == _overflowGrid.generation && !grid.preview);
+        if(newer) { 
+            _overflowGrid = std::move(grid);
+            _hasOverflowGrid = true;
+        }
+    }
+    markDirty();
+}
+
+
+void Application::processCompletedUploads() { 
+    SampleGrid grid;
+    while(_readyGrids.tryPop(grid)) { 
+        scheduleChunkedUpload(std::move(grid));
+    }
+    bool overflowed = false;
+    {
+        std::lock_guard<std::mutex> lock(_overflowMutex);
+        if(_hasOverflowGrid) { 
+            grid = std::move(_overflowGrid);
+            _overflowGrid = SampleGrid();
+            _hasOverflowGrid = false;
+            overflowed = true;
+        }
+    }
+    if(overflowed && equation->accepts(grid)) { 
+        scheduleChunkedUpload(std::move(grid));
+    }
+    if(!_uploadWorker) { 
+        return;
+    }
+    _uploadWorker->pollCompleted([this](CompletedUpload& upload) {
+        // a newer request superseded this one; the buffer is released with the upload
+        if(!equation->accepts(upload.grid)) { 
+            return;
+        }
+        if(!upload.buffer) { 
+            scheduleChunkedUpload(std::move(upload.grid)); // the worker couldn't upload it
+            return;
+        }
+        equation->swapVertexBuffer(std::move(upload.buffer), std::move(upload.grid));
+        markDirty();
+    });
+}
+
+
+void Application::scheduleChunkedUpload(SampleGrid&& grid) { 
+    //uploads a grid on this thread a slice at a time instead of one big glBufferData
+    struct ChunkedUpload { 
+        SampleGrid grid;
+        std::unique_ptr<VertexBuffer> vbo;
+        size_t offset = 0;
+    };
+    const size_t sliceBytes = 1 << 20;
+    auto state = std::make_shared<ChunkedUpload>();
+    state->grid = std::move(grid);
+
+    _frameScheduler.enqueue("equation upload", [this, state, sliceBytes]() {
+        if(!equation->accepts(state->grid)) { 
+            return TaskStatus::Done; // superseded while waiting
+        }
+        if(state->grid.empty()) { 
+            equation->gridDropped(state->grid.generation);
+            return TaskStatus::Done;
+        }
+        const size_t total = state->grid.byteSize();
+        try { 
+            if(!state->vbo) { 
+                state->vbo = std::make_unique<VertexBuffer>();
+                state->vbo->resize(total);
+            }
+            //the buffer is the points followed by the scalar channels, a slice may cover both
+            const size_t end = std::min(state->offset + sliceBytes, total);
+            const size_t pointBytes = state->grid.pointBytes();
+            if(state->offset < pointBytes) { 
+                const char* points = reinterpret_cast<const char*>(state->grid.points.data());
+                state->vbo->updateData(points + state->offset, std::min(end, pointBytes) - state->offset, state->offset);
+            }
+            if(end > pointBytes) { 
+                size_t begin = std::max(state->offset, pointBytes);
+                const char* scalars = reinterpret_cast<const char*>(state->grid.scalars.data());
+                state->vbo->updateData(scalars + (begin - pointBytes), end - begin, begin);
+            }
+            state->offset = end;
+        } catch(...) { 
+            equation->gridDropped(state->grid.generation); //the scheduler logs it
+            throw;
+        }
+        if(state->offset < total) { 
+            return TaskStatus::Continue;
+        }
+        equation->swapVertexBuffer(std::move(state->vbo), std::move(state->grid));
+        markDirty();
+        return TaskStatus::Done;
+    });
+}
+
+
 void Application::setupCallbacks(){ 
     glfwSetFramebufferSizeCallback(this->window, framebuffer_size_callback);
     glfwSetMouseButtonCallback(this->window, mouseButton_callback);
@@ -220,11 +1125,17 @@ void Application::setupCallbacks(){
 
 
 void Application::framebuffer_size_callback(GLFWwindow* window, int width, int height) {
-            glViewport(0, 0, width, height);
+            // the viewport itself is updated on the context thread from the next snapshot
             Application* app = static_cast<Application*>(glfwGetWindowUserPointer(window));
             if(app) {
+                InputEvent event;
+                event.type = InputEventType::FramebufferSize;
+                event.x = width;
+                event.y = height;
+                app->recordInput(event);
                 app->WIN_WIDTH = width;
                 app->WIN_HEIGHT = height;
+                app->markDirty();
             }
         }   
 
@@ -233,65 +1144,178 @@ void Application::cursor_pos_callback(GLFWwindow* window, double xPosIn, double
 
 
     if(!app ){ 
-        std::cerr<< "(cursor_pos_callback) Failed getting window:" << std::endl;
+        GRAPHISQUE_LOG_ERROR("cursor_pos_callback", "Failed getting window");
+        return;
+    }
+    if(app->_replaying) { 
         return;
     }
+    app->noteInput();
+    InputEvent event;
+    event.type = InputEventType::CursorPos;
+    event.x = xPosIn;
+    event.y = yPosIn;
+    app->recordInput(event);
+    app->onCursorPos(xPosIn, yPosIn);
+}
 
-    if (app-> _isDevCamEnabled || app->_isDragging) {
+void Application::onCursorPos(double xPosIn, double yPosIn) { 
+    if (!_isCursorHidden) { 
+        markDirty(); // the UI may react to hover
+    }
+    if (_isDevCamEnabled || _isDragging) {
         float xpos = static_cast<float>(xPosIn);
         float ypos = static_cast<float>(yPosIn);
-        if(app->_firstMouse) { 
-            app->_lastX = xpos;
-            app-> _lastY = ypos;
-            app->_firstMouse = false;
+        if(_firstMouse) { 
+            _lastX = xpos;
+            _lastY = ypos;
+            _firstMouse = false;
         }
 
-        float xOffset = xpos - app->_lastX;
-        float yOffset = app->_lastY - ypos;
+        float xOffset = xpos - _lastX;
+        float yOffset = _lastY - ypos;
 
-        app->_lastX = xpos;
-        app->_lastY  = ypos;
-        app->activeCamera->handleMouseMovement(xOffset, yOffset, GL_TRUE);
+        _lastX = xpos;
+        _lastY  = ypos;
+        activeCamera->handleMouseMovement(xOffset, yOffset, GL_TRUE);
+        markDirty();
     }
 
 }
 
 
-void Application::key_callback(GLFWwindow* window, int key, int scancode, int action, int mods){ 
+void Application::key_callback(GLFWwindow* window, int key, int /*scancode*/, int action, int mods){ 
     Application* app = getApplicationPtr(window);
+    if(!app || app->_replaying) { 
+        return;
+    }
+    app->noteInput();
+    //captures write files; they aren't recorded, so a replay only measures drawing the scene
+    if(action == GLFW_PRESS && app->onCaptureKey(key)) { 
+        return;
+    }
+    InputEvent event;
+    event.type = InputEventType::Key;
+    event.code = key;
+    event.action = action;
+    event.mods = mods;
+    app->recordInput(event);
+    app->onKey(key, action, mods);
+}
+
+void Application::onKey(int key, int action, int) { 
+    markDirty();
+    if (key >= 0 && key <= GLFW_KEY_LAST && action != GLFW_REPEAT) { 
+        _keysDown[key] = action == GLFW_PRESS;
+    }
     if  (key == GLFW_KEY_H && action == GLFW_PRESS) { 
-        if(app-> _isCursorHidden){
-            glfwSetInputMode(window,GLFW_CURSOR,GLFW_CURSOR_NORMAL);
-            app-> _isCursorHidden= false;
-            GLOBAL::IS_CURSOR_DISABLED = false;
-        }
-        else{
-            glfwSetInputMode(window,GLFW_CURSOR,GLFW_CURSOR_DISABLED);
-            app-> _isCursorHidden=true;
-            GLOBAL::IS_CURSOR_DISABLED = true;
+        _isCursorHidden = !_isCursorHidden;
+        GLOBAL::IS_CURSOR_DISABLED = _isCursorHidden;
+        if(window) { 
+            glfwSetInputMode(window, GLFW_CURSOR, _isCursorHidden ? GLFW_CURSOR_DISABLED : GLFW_CURSOR_NORMAL);
         }
     }
     if (key == GLFW_KEY_C && action == GLFW_PRESS){ 
-        if(app->_isDevCamEnabled){ 
-            app->activeCamera = app->orbitCamera;
-            app-> _isDevCamEnabled = false;
+        if(_isDevCamEnabled){ 
+            activeCamera = orbitCamera;
+            _isDevCamEnabled = false;
         }
         else { 
-            app->activeCamera = app->devCamera;
-            app->_isDevCamEnabled = true;
+            activeCamera = devCamera;
+            _isDevCamEnabled = true;
+        }
+    }
+    if (key == GLFW_KEY_F1 && action == GLFW_PRESS) { 
+        _profilerOverlay.toggle();
+    }
+    if (key == GLFW_KEY_F2 && action == GLFW_PRESS) { 
+        _statsOverlay.toggle();
+    }
+    if (key == GLFW_KEY_F3 && action == GLFW_PRESS) { 
+        _colormapOverlay.toggle();
+    }
+    //M cycles what the surface is colored by (flat, height, slope, curvature), N the colormap
+    if (key == GLFW_KEY_M && action == GLFW_PRESS) { 
+        ColorMapping& mapping = _colorMapping;
+        size_t next = static_cast<size_t>(mapping.channel) + 1;
+        if(!mapping.enabled) { 
+            mapping.enabled = true;
+            mapping.channel = ScalarChannel::Height;
+        } else if(next < SCALAR_CHANNEL_COUNT) { 
+            mapping.channel = static_cast<ScalarChannel>(next);
+        } else { 
+            mapping.enabled = false;
         }
     }
+    if (key == GLFW_KEY_N && action == GLFW_PRESS) { 
+        _colorMapping.colormap = static_cast<Colormap>((static_cast<size_t>(_colorMapping.colormap) + 1) % COLORMAP_COUNT);
+    }
+    //refine / coarsen the sampling of the equation
+    if ((key == GLFW_KEY_EQUAL || key == GLFW_KEY_MINUS) && action == GLFW_PRESS) { 
+        SampleDomain& domain = _equationDomain;
+        domain.step = (key == GLFW_KEY_EQUAL) ? std::max(domain.step * 0.5f, 0.01f) : std::min(domain.step * 2.0f, 2.0f);
+    }
 }
 
 void Application::mouseButton_callback(GLFWwindow* window, int button, int action, int mods) { 
     Application* app = getApplicationPtr(window);
+    if(!app || app->_replaying) { 
+        return;
+    }
+    app->noteInput();
+    app->markDirty();
+    if(app->_ui.wantsMouse() && action == GLFW_PRESS) { 
+        return; // the click belongs to an ImGui window
+    }
+    InputEvent event;
+    event.type = InputEventType::MouseButton;
+    event.code = button;
+    event.action = action;
+    event.mods = mods;
+    glfwGetCursorPos(window, &event.x, &event.y);
+    app->recordInput(event);
+    app->onMouseButton(button, action, mods, event.x, event.y);
+}
+
+bool Application::onCaptureKey(int key) { 
+    //F9 screenshot, F10 start/stop recording, F11 turntable, F12 poster at four times the window resolution
+    switch(key) { 
+        case GLFW_KEY_F9:
+            captureScreenshot("graphisque_screenshot_" + std::to_string(_screenshotCount++) + ".png");
+            break;
+        case GLFW_KEY_F10:
+            if (isCapturing()) { 
+                stopCapture();
+                GRAPHISQUE_LOG_INFO("onCaptureKey", "Recording stopped ({} frames written)", _capture.framesCaptured());
+            } else { 
+                startCapture("graphisque_capture.y4m", 60);
+            }
+            break;
+        case GLFW_KEY_F11:
+            if (!isCapturing()) { 
+                recordTurntable("graphisque_turntable.y4m", 360, 60);
+            }
+            break;
+        case GLFW_KEY_F12:
+            requestPoster("graphisque_poster.png", WIN_WIDTH * 4, WIN_HEIGHT * 4);
+            break;
+        default:
+            return false;
+    }
+    markDirty();
+    return true;
+}
+
+void Application::onMouseButton(int button, int action, int, double xPos, double yPos) { 
+    markDirty();
     if(button == GLFW_MOUSE_BUTTON_LEFT) { 
         if(action == GLFW_PRESS){ 
-            app->_isDragging =  true;
-            glfwGetCursorPos(window,&app->_lastX, &app->_lastY);
+            _isDragging =  true;
+            _lastX = xPos;
+            _lastY = yPos;
         }
         else if (action == GLFW_RELEASE) { 
-            app->_isDragging = false;
+            _isDragging = false;
         }
     }
 
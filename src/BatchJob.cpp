@@ -0,0 +1,122 @@
+#include "BatchJob.h"
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+
+// Splits a line into key=value tokens, honouring double quoted values
+static std::vector<std::pair<std::string, std::string>> tokenize(const std::string& line) {
+    std::vector<std::pair<std::string, std::string>> tokens;
+    size_t pos = 0;
+    while (pos < line.size()) {
+        while (pos < line.size() && (line[pos] == ' ' || line[pos] == '\t')) {
+            ++pos;
+        }
+        if (pos >= line.size()) {
+            break;
+        }
+        size_t keyBegin = pos;
+        while (pos < line.size() && line[pos] != '=' && line[pos] != ' ' && line[pos] != '\t') {
+            ++pos;
+        }
+        std::string key = line.substr(keyBegin, pos - keyBegin);
+        std::string value;
+        if (pos < line.size() && line[pos] == '=') {
+            ++pos;
+            if (pos < line.size() && line[pos] == '"') {
+                size_t close = line.find('"', pos + 1);
+                if (close == std::string::npos) {
+                    throw std::runtime_error("unterminated quote after " + key);
+                }
+                value = line.substr(pos + 1, close - pos - 1);
+                pos = close + 1;
+            } else {
+                size_t valueBegin = pos;
+                while (pos < line.size() && line[pos] != ' ' && line[pos] != '\t') {
+                    ++pos;
+                }
+                value = line.substr(valueBegin, pos - valueBegin);
+            }
+        }
+        tokens.emplace_back(std::move(key), std::move(value));
+    }
+    return tokens;
+}
+
+static void applyToken(BatchJob& job, const std::string& key, const std::string& value) {
+    char tail = 0;
+    if (key == "expr") {
+        job.expression = value;
+    } else if (key == "out") {
+        job.output = value;
+    } else if (key == "domain") {
+        SampleDomain& d = job.domain;
+        if (std::sscanf(value.c_str(), "%f,%f,%f,%f%c", &d.xMin, &d.xMax, &d.yMin, &d.yMax, &tail) != 4 ||
+            d.xMax <= d.xMin || d.yMax <= d.yMin) {
+            throw std::runtime_error("domain must be xMin,xMax,yMin,yMax with min < max");
+        }
+    } else if (key == "step") {
+        if (std::sscanf(value.c_str(), "%f%c", &job.domain.step, &tail) != 1 || job.domain.step <= 0.0f) {
+            throw std::runtime_error("step must be a positive number");
+        }
+    } else if (key == "size") {
+        if (std::sscanf(value.c_str(), "%dx%d%c", &job.width, &job.height, &tail) != 2 ||
+            job.width <= 0 || job.height <= 0) {
+            throw std::runtime_error("size must be WIDTHxHEIGHT");
+        }
+    } else if (key == "camera") {
+        if (std::sscanf(value.c_str(), "%f,%f,%f%c", &job.yaw, &job.pitch, &job.distance, &tail) != 3 ||
+            job.distance <= 0.0f) {
+            throw std::runtime_error("camera must be yaw,pitch,distance");
+        }
+    } else {
+        throw std::runtime_error("unknown key '" + key + "'");
+    }
+}
+
+
+std::vector<BatchJob> loadBatchJobs(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("Cannot open job file " + path);
+    }
+    std::vector<BatchJob> jobs;
+    BatchJob defaults;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        size_t first = line.find_first_not_of(" \t");
+        if (first == std::string::npos || line[first] == '#') {
+            continue;
+        }
+        try {
+            auto tokens = tokenize(line);
+            bool isDefaults = tokens.front().first == "defaults" && tokens.front().second.empty();
+            BatchJob job = defaults;
+            job.output.clear(); // every plot needs its own file
+            for (size_t i = isDefaults ? 1 : 0; i < tokens.size(); ++i) {
+                applyToken(isDefaults ? defaults : job, tokens[i].first, tokens[i].second);
+            }
+            if (isDefaults) {
+                continue;
+            }
+            if (job.expression.empty()) {
+                throw std::runtime_error("missing expr");
+            }
+            if (job.output.empty()) {
+                char name[32];
+                std::snprintf(name, sizeof(name), "plot_%05zu.png", jobs.size());
+                job.output = name;
+            }
+            jobs.push_back(std::move(job));
+        } catch (const std::exception& e) {
+            throw std::runtime_error(path + ":" + std::to_string(lineNumber) + ": " + e.what());
+        }
+    }
+    return jobs;
+}
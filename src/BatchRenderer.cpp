@@ -0,0 +1,187 @@
+#include "BatchRenderer.h"
+
+#include "Expression.h"
+#include "GLResourceManager.h"
+#include "HardwareCounters.h"
+#include "Profiler.h"
+#include "ProgramCache.h"
+#include <chrono>
+#include <iostream>
+#include <glm/gtc/matrix_transform.hpp>
+
+
+// Equation's surface color, so batch plots look like the interactive ones
+static const glm::vec3 SURFACE_COLOR(0.4f, 0.1f, 0.6f);
+
+
+// Same orbit parametrisation as OrbitalCamera
+static glm::mat4 orbitView(float yaw, float pitch, float distance) {
+    glm::vec3 direction;
+    direction.x = cos(glm::radians(pitch)) * sin(glm::radians(yaw));
+    direction.y = sin(glm::radians(pitch));
+    direction.z = cos(glm::radians(pitch)) * cos(glm::radians(yaw));
+    return glm::lookAt(direction * distance, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+
+BatchRenderer::BatchRenderer(unsigned workers) {
+    _jobs = std::make_unique<JobSystem>(workers);
+    _capture = std::make_unique<FrameCapture>(_jobs->workerCount());
+}
+
+BatchRenderer::~BatchRenderer() {
+    _jobs->shutdown();
+    if (_context.isValid()) {
+        _context.makeCurrent();
+        _capture->shutdown();
+        _meshArray.reset();
+        _mesh.reset();
+        _axes.reset();
+        _target.reset();
+        _shader.reset();
+        _shaderVariants.release();
+        GLResourceManager::instance().shutdown();
+        _context.destroy();
+    }
+}
+
+bool BatchRenderer::init() {
+    if (!_context.create(3, 3) || !_context.makeCurrent()) {
+        std::cerr << "(BatchRenderer) No headless OpenGL context" << std::endl;
+        return false;
+    }
+    if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(HeadlessContext::getProcAddress))) {
+        std::cerr << "(BatchRenderer) Failed to initialize GLAD" << std::endl;
+        return false;
+    }
+    ProgramCache::instance().loadFunctions(reinterpret_cast<GLADloadproc>(HeadlessContext::getProcAddress));
+    _shaderVariants.loadFunctions(reinterpret_cast<GLADloadproc>(HeadlessContext::getProcAddress));
+    std::cout << "(BatchRenderer) " << _context.getDescription() << ", " << glGetString(GL_RENDERER) << std::endl;
+    try {
+        _shader = _shaderVariants.get("vertex.vert", "fragment.frag");
+        _axes = std::make_unique<Axes>(10.0f, 0.1f, 0.8f, 0.4f, true);
+    } catch (const std::exception& e) {
+        std::cerr << "(BatchRenderer) Failed to create the scene: " << e.what() << std::endl;
+        return false;
+    }
+    // same state as the interactive renderer
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_LINE_SMOOTH);
+    glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
+    glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+    return true;
+}
+
+BatchRenderer::SampledJob BatchRenderer::startSampling(const BatchJob& job) {
+    SampledJob sampled;
+    std::shared_ptr<Expression> expression;
+    try {
+        expression = std::make_shared<Expression>(job.expression);
+    } catch (const std::exception& e) {
+        sampled.error = e.what();
+        return sampled;
+    }
+    if (job.domain.sampleCount() == 0) {
+        sampled.error = "empty domain";
+        return sampled;
+    }
+    sampled.grid = std::make_shared<SampleGrid>();
+    sampled.grid->domain = job.domain;
+    sampled.grid->points.resize(job.domain.sampleCount());
+    std::shared_ptr<SampleGrid> grid = sampled.grid;
+    sampled.done = _jobs->parallelFor(job.domain.countX(), SAMPLE_TILE_ROWS,
+        [grid, expression](size_t rowBegin, size_t rowEnd) {
+            GRAPHISQUE_PROFILE_SCOPE("Sample tile");
+            GRAPHISQUE_PROFILE_COUNTERS("Sample tile");
+            sampleSurfaceRows(*expression, *grid, rowBegin, rowEnd);
+        }, JobPriority::VisibleNow);
+    return sampled;
+}
+
+bool BatchRenderer::renderJob(const BatchJob& job, const SampleGrid& grid) {
+    GRAPHISQUE_PROFILE_FUNCTION();
+    try {
+        if (!_target) {
+            _target = std::make_unique<GLFramebuffer>(job.width, job.height);
+        } else if (_target->getWidth() != job.width || _target->getHeight() != job.height) {
+            _target->resize(job.width, job.height);
+        }
+        //overwritten in place; only a job with more samples than any before reallocates
+        const size_t bytes = grid.pointBytes();
+        if (!_mesh) {
+            _mesh = std::make_unique<VertexBuffer>();
+            _mesh->resize(bytes);
+            _meshArray = std::make_unique<VerteXArray>();
+            _meshArray->addVertexBuffer(*_mesh, 0, 3, GL_FLOAT);
+        } else if (_mesh->getSize() < bytes) {
+            _mesh->resize(bytes);
+        }
+        _mesh->updateData(grid.points);
+
+        _target->bind();
+        glViewport(0, 0, job.width, job.height);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)job.width / (float)job.height, 0.1f, 100.0f);
+        _shader->use();
+        _shader->setMat4("view", orbitView(job.yaw, job.pitch, job.distance));
+        _shader->setMat4("projection", projection);
+        _axes->draw(_shader);
+        _shader->setMat4("model", glm::mat4(1.0f));
+        _shader->setVec3("objectColor", SURFACE_COLOR);
+        glPointSize(3.0f);
+        _meshArray->drawArrays(GL_POINTS, 0, static_cast<GLsizei>(grid.points.size()));
+
+        //into the PBO ring; waits only when the ring or the encoders are a full ring behind
+        if (!_capture->readback(job.width, job.height, job.output)) {
+            std::cerr << "(BatchRenderer) " << job.output << ": readback failed" << std::endl;
+            return false;
+        }
+        _capture->poll();
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "(BatchRenderer) " << job.output << ": " << e.what() << std::endl;
+        return false;
+    }
+}
+
+BatchResult BatchRenderer::run(const std::vector<BatchJob>& jobs) {
+    BatchResult result;
+    auto start = std::chrono::steady_clock::now();
+    size_t submitted = 0;
+    size_t failed = 0;
+    const uint64_t capturedBefore = _capture->framesCaptured();
+    //every frame names its own file
+    _capture->begin(std::string(), CaptureFormat::Png, 30, 0, true);
+
+    SampledJob next;
+    if (!jobs.empty()) {
+        next = startSampling(jobs[0]);
+    }
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        SampledJob current = std::move(next);
+        // start sampling N+1 before waiting on N so the workers never run dry
+        if (i + 1 < jobs.size()) {
+            next = startSampling(jobs[i + 1]);
+        }
+        if (!current.error.empty()) {
+            std::cerr << "(BatchRenderer) " << jobs[i].output << ": " << current.error << std::endl;
+            ++failed;
+            continue;
+        }
+        _jobs->wait(current.done);
+        if (!renderJob(jobs[i], *current.grid)) {
+            ++failed;
+            continue;
+        }
+        ++submitted;
+    }
+    _capture->flush();
+    _capture->end();
+
+    //an encode that failed to write is the difference
+    result.rendered = static_cast<size_t>(_capture->framesCaptured() - capturedBefore);
+    result.failed = failed + (submitted - result.rendered);
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
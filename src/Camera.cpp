@@ -1,4 +1,5 @@
 #include "Camera.h"
+#include "Logger.h"
 
 
 Camera::Camera(glm::vec3 position, glm::vec3 up, float yaw, float pitch)
@@ -19,10 +20,7 @@ void Camera::setPosition(const glm::vec3& position) {
 }
 
 void Camera::printPosition(){ 
-    std::cout << "Camera Position: " 
-        << _position.x << ", " 
-        << _position.y << ", " 
-        << _position.z << std::endl; 
+    GRAPHISQUE_LOG_DEBUG("Camera", "Camera Position: {}, {}, {}", _position.x, _position.y, _position.z);
 }
 void Camera::handleCameraMovement(CameraMovement direction, float deltaTime) {
     float velocity = _cameraSpeed * deltaTime;
@@ -128,8 +126,7 @@ void OrbitalCamera::update(float deltaX, float deltaY) {
 
 void OrbitalCamera::updateCameraVectors() { 
     glm::vec3 direction; 
-    std::cout<< "Yaw = " << _yaw << std::endl;
-    std::cout<< "Pitch = " << _pitch << std::endl;
+    GRAPHISQUE_LOG_DEBUG("OrbitalCamera", "Yaw = {}, Pitch = {}", _yaw, _pitch);
     direction.x = cos(glm::radians(_pitch)) * sin(glm::radians(_yaw));
     direction.y = sin(glm::radians(_pitch));
     direction.z = cos(glm::radians(_pitch)) * cos(glm::radians(_yaw));
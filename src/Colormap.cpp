@@ -0,0 +1,126 @@
+#include "Colormap.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+
+struct ColorStop {
+    uint8_t r, g, b;
+};
+
+// Evenly spaced stops, interpolated linearly in between
+static const ColorStop VIRIDIS[] = {
+    {0x44, 0x01, 0x54}, {0x47, 0x2d, 0x7b}, {0x3b, 0x52, 0x8b}, {0x2c, 0x72, 0x8e}, {0x21, 0x91, 0x8c},
+    {0x28, 0xae, 0x80}, {0x5e, 0xc9, 0x62}, {0xad, 0xdc, 0x30}, {0xfd, 0xe7, 0x25}
+};
+static const ColorStop COOLWARM[] = {
+    {59, 76, 192}, {141, 176, 254}, {221, 221, 221}, {244, 154, 123}, {180, 4, 38}
+};
+static const ColorStop GRAYSCALE[] = {
+    {0, 0, 0}, {255, 255, 255}
+};
+
+struct ColormapInfo {
+    const char* name;
+    const ColorStop* stops;
+    size_t stopCount;
+};
+
+static const ColormapInfo COLORMAPS[COLORMAP_COUNT] = {
+    {"viridis", VIRIDIS, sizeof(VIRIDIS) / sizeof(VIRIDIS[0])},
+    {"coolwarm", COOLWARM, sizeof(COOLWARM) / sizeof(COOLWARM[0])},
+    {"grayscale", GRAYSCALE, sizeof(GRAYSCALE) / sizeof(GRAYSCALE[0])}
+};
+
+static const char* const CHANNEL_NAMES[SCALAR_CHANNEL_COUNT] = {
+    "height",
+    "slope",
+    "curvature"
+};
+
+
+const char* colormapName(Colormap colormap) {
+    return COLORMAPS[static_cast<size_t>(colormap) % COLORMAP_COUNT].name;
+}
+
+const char* scalarChannelName(ScalarChannel channel) {
+    return CHANNEL_NAMES[static_cast<size_t>(channel) % SCALAR_CHANNEL_COUNT];
+}
+
+bool parseColormap(const std::string& name, Colormap& colormap) {
+    for (size_t i = 0; i < COLORMAP_COUNT; ++i) {
+        if (name == COLORMAPS[i].name) {
+            colormap = static_cast<Colormap>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parseScalarChannel(const std::string& name, ScalarChannel& channel) {
+    for (size_t i = 0; i < SCALAR_CHANNEL_COUNT; ++i) {
+        if (name == CHANNEL_NAMES[i]) {
+            channel = static_cast<ScalarChannel>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+glm::vec3 sampleColormap(Colormap colormap, float t) {
+    const ColormapInfo& info = COLORMAPS[static_cast<size_t>(colormap) % COLORMAP_COUNT];
+    float position = std::min(std::max(t, 0.0f), 1.0f) * static_cast<float>(info.stopCount - 1);
+    size_t index = std::min(static_cast<size_t>(position), info.stopCount - 2);
+    float blend = position - static_cast<float>(index);
+    const ColorStop& a = info.stops[index];
+    const ColorStop& b = info.stops[index + 1];
+    return glm::vec3(a.r + (b.r - a.r) * blend, a.g + (b.g - a.g) * blend, a.b + (b.b - a.b) * blend) / 255.0f;
+}
+
+
+ColormapTexture::ColormapTexture() {
+    std::vector<uint8_t> texels(static_cast<size_t>(WIDTH) * COLORMAP_COUNT * 3);
+    for (size_t layer = 0; layer < COLORMAP_COUNT; ++layer) {
+        for (int i = 0; i < WIDTH; ++i) {
+            glm::vec3 color = sampleColormap(static_cast<Colormap>(layer), static_cast<float>(i) / (WIDTH - 1));
+            uint8_t* texel = &texels[(layer * WIDTH + i) * 3];
+            texel[0] = static_cast<uint8_t>(color.x * 255.0f + 0.5f);
+            texel[1] = static_cast<uint8_t>(color.y * 255.0f + 0.5f);
+            texel[2] = static_cast<uint8_t>(color.z * 255.0f + 0.5f);
+        }
+    }
+
+    glGenTextures(1, &_texture);
+    if (_texture == 0) {
+        throw std::runtime_error("Failed to generate the colormap texture");
+    }
+    glBindTexture(GL_TEXTURE_1D_ARRAY, _texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_1D_ARRAY, 0, GL_RGB8, WIDTH, static_cast<GLsizei>(COLORMAP_COUNT), 0,
+                 GL_RGB, GL_UNSIGNED_BYTE, texels.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(GL_TEXTURE_1D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_1D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_1D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_1D_ARRAY, 0);
+
+    GLenum error = glGetError();
+    if (error != GL_NO_ERROR) {
+        glDeleteTextures(1, &_texture);
+        _texture = 0;
+        throw std::runtime_error("OpenGL error while creating the colormap texture: " + std::to_string(error));
+    }
+}
+
+ColormapTexture::~ColormapTexture() {
+    if (_texture != 0) {
+        glDeleteTextures(1, &_texture);
+    }
+}
+
+void ColormapTexture::bind(GLuint unit) const {
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_1D_ARRAY, _texture);
+    glActiveTexture(GL_TEXTURE0);
+}
@@ -0,0 +1,80 @@
+#include "ColormapOverlay.h"
+
+#include "imgui/imgui.h"
+#include <algorithm>
+
+
+template<typename Enum>
+static bool enumCombo(const char* label, Enum& value, size_t count, const char* (*name)(Enum)) {
+    bool changed = false;
+    if (ImGui::BeginCombo(label, name(value))) {
+        for (size_t i = 0; i < count; ++i) {
+            Enum option = static_cast<Enum>(i);
+            if (ImGui::Selectable(name(option), option == value)) {
+                value = option;
+                changed = true;
+            }
+        }
+        ImGui::EndCombo();
+    }
+    return changed;
+}
+
+// The colormap as a strip across the window
+static void colorBar(Colormap colormap) {
+    const int segments = 64;
+    ImVec2 origin = ImGui::GetCursorScreenPos();
+    float width = std::max(ImGui::GetContentRegionAvail().x, 1.0f);
+    float height = ImGui::GetFrameHeight();
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    for (int i = 0; i < segments; ++i) {
+        glm::vec3 left = sampleColormap(colormap, static_cast<float>(i) / segments);
+        glm::vec3 right = sampleColormap(colormap, static_cast<float>(i + 1) / segments);
+        ImU32 leftColor = ImGui::ColorConvertFloat4ToU32(ImVec4(left.x, left.y, left.z, 1.0f));
+        ImU32 rightColor = ImGui::ColorConvertFloat4ToU32(ImVec4(right.x, right.y, right.z, 1.0f));
+        float x0 = origin.x + width * static_cast<float>(i) / segments;
+        float x1 = origin.x + width * static_cast<float>(i + 1) / segments;
+        drawList->AddRectFilledMultiColor(ImVec2(x0, origin.y), ImVec2(x1, origin.y + height),
+                                          leftColor, rightColor, rightColor, leftColor);
+    }
+    ImGui::Dummy(ImVec2(width, height));
+}
+
+
+bool ColormapOverlay::draw(ColorMapping& mapping, const ScalarRange& shownRange) {
+    if (!_visible) {
+        return false;
+    }
+    ImGui::SetNextWindowSize(ImVec2(300, 200), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Surface colors", &_visible)) {
+        ImGui::End();
+        return false;
+    }
+
+    bool changed = ImGui::Checkbox("Color by channel", &mapping.enabled);
+    ImGui::BeginDisabled(!mapping.enabled);
+    changed |= enumCombo("Channel", mapping.channel, SCALAR_CHANNEL_COUNT, scalarChannelName);
+    changed |= enumCombo("Colormap", mapping.colormap, COLORMAP_COUNT, colormapName);
+    colorBar(mapping.colormap);
+
+    if (ImGui::Checkbox("Auto range", &mapping.autoRange)) {
+        if (!mapping.autoRange && shownRange.isValid()) {
+            mapping.range = shownRange; // start from what is on screen
+        }
+        changed = true;
+    }
+    if (mapping.autoRange) {
+        if (shownRange.isValid()) {
+            ImGui::Text("%.4g .. %.4g", shownRange.min, shownRange.max);
+        } else {
+            ImGui::TextDisabled("no finite samples yet");
+        }
+    } else {
+        float speed = std::max((mapping.range.max - mapping.range.min) * 0.005f, 1e-4f);
+        changed |= ImGui::DragFloatRange2("Range", &mapping.range.min, &mapping.range.max, speed, 0.0f, 0.0f, "%.4g");
+    }
+    ImGui::EndDisabled();
+
+    ImGui::End();
+    return changed;
+}
@@ -0,0 +1,234 @@
+#include "DynamicResolution.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+// Whatever the settings say; below this the scene is unreadable, above it only costs memory
+static const float MIN_SCALE = 0.1f;
+static const float MAX_SCALE = 2.0f;
+
+static float clampScale(float scale) {
+    return std::min(std::max(scale, MIN_SCALE), MAX_SCALE);
+}
+
+
+bool DynamicResolution::begin(int width, int height, const ResolutionSettings& settings, ShaderVariants& variants) {
+    if (_failed || width <= 0 || height <= 0 || settings.samples == _failedSamples) {
+        return false;
+    }
+    if (!_compositeShader) {
+        try {
+            _compositeShader = variants.get("composite.vert", "composite.frag");
+            _emptyVertexArray = std::make_unique<GLVertexArray>();
+        } catch (const std::exception& e) {
+            GRAPHISQUE_LOG_ERROR("DynamicResolution", "Composite pass unavailable, drawing at native resolution: {}", e.what());
+            _failed = true;
+            return false;
+        }
+        if (_compositeShader->ID == 0) {
+            _failed = true;
+            return false;
+        }
+        glGenQueries(FRAME_LATENCY * 2, &_queries[0][0]);
+    }
+    readTimings(settings);
+
+    //storage for the largest scale this frame may use, so dynamic changes never reallocate
+    float largest = clampScale(settings.dynamic ? std::max(settings.maxScale, settings.minScale) : settings.scale);
+    int allocatedWidth = std::max(1, static_cast<int>(std::ceil(width * largest)));
+    int allocatedHeight = std::max(1, static_cast<int>(std::ceil(height * largest)));
+    if (allocatedWidth != _allocatedWidth || allocatedHeight != _allocatedHeight || settings.samples != _requestedSamples) {
+        if (!allocate(allocatedWidth, allocatedHeight, settings.samples)) {
+            _failedSamples = settings.samples;
+            return false;
+        }
+    }
+
+    float drawScale = settings.dynamic ? std::min(std::max(scale(), settings.minScale), settings.maxScale) : settings.scale;
+    drawScale = clampScale(drawScale);
+    _scale = drawScale;
+    _frameWidth = width;
+    _frameHeight = height;
+    _drawWidth = std::min(std::max(1, static_cast<int>(std::lround(width * drawScale))), _allocatedWidth);
+    _drawHeight = std::min(std::max(1, static_cast<int>(std::lround(height * drawScale))), _allocatedHeight);
+    _sharpness = drawScale < 1.0f ? std::min(std::max(settings.sharpness, 0.0f), 1.0f) : 0.0f;
+
+    glQueryCounter(_queries[_frame % FRAME_LATENCY][0], GL_TIMESTAMP);
+    glBindFramebuffer(GL_FRAMEBUFFER, _sceneFramebuffer);
+    glViewport(0, 0, _drawWidth, _drawHeight);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    return true;
+}
+
+void DynamicResolution::composite(GLuint target) {
+    if (_samples > 0) {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, _sceneFramebuffer);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _resolveFramebuffer);
+        glBlitFramebuffer(0, 0, _drawWidth, _drawHeight, 0, 0, _drawWidth, _drawHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, target);
+    glViewport(0, 0, _frameWidth, _frameHeight);
+
+    //a full screen pass: no depth, filled polygons whatever mode the scene draws in
+    GLint polygonMode[2] = {GL_FILL, GL_FILL};
+    glGetIntegerv(GL_POLYGON_MODE, polygonMode);
+    GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    glDisable(GL_DEPTH_TEST);
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, _resolveTexture);
+    _compositeShader->use();
+    _compositeShader->setInt("sceneColor", 0);
+    _compositeShader->setVec2("sourceSize", glm::vec2(static_cast<float>(_drawWidth), static_cast<float>(_drawHeight)));
+    _compositeShader->setFloat("sharpness", _sharpness);
+    _emptyVertexArray->drawArrays(GL_TRIANGLES, 0, 3);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glPolygonMode(GL_FRONT_AND_BACK, static_cast<GLenum>(polygonMode[0]));
+    if (depthTest) {
+        glEnable(GL_DEPTH_TEST);
+    }
+
+    const int slot = _frame % FRAME_LATENCY;
+    glQueryCounter(_queries[slot][1], GL_TIMESTAMP);
+    _issued[slot] = true;
+    ++_frame;
+}
+
+void DynamicResolution::readTimings(const ResolutionSettings& settings) {
+    // This slot was issued FRAME_LATENCY frames ago; its results are normally long available
+    const int slot = _frame % FRAME_LATENCY;
+    if (!_issued[slot]) {
+        return;
+    }
+    _issued[slot] = false;
+    GLint available = 0;
+    glGetQueryObjectiv(_queries[slot][1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) {
+        return; // never wait; this frame goes unmeasured
+    }
+    GLuint64 start = 0, end = 0;
+    glGetQueryObjectui64v(_queries[slot][0], GL_QUERY_RESULT, &start);
+    glGetQueryObjectui64v(_queries[slot][1], GL_QUERY_RESULT, &end);
+    if (end > start) {
+        adjust(static_cast<float>(static_cast<double>(end - start) / 1e6), settings);
+    }
+}
+
+void DynamicResolution::adjust(float measuredMs, const ResolutionSettings& settings) {
+    if (_cooldown > 0) {
+        --_cooldown; // still drawn at the previous scale
+        return;
+    }
+    _smoothedMs = _smoothedMs > 0.0f ? _smoothedMs * 0.75f + measuredMs * 0.25f : measuredMs;
+    _gpuMs = _smoothedMs;
+    if (!settings.dynamic || settings.targetMs <= 0.0f) {
+        return;
+    }
+    //hold anywhere between 80% and 100% of the target instead of chasing noise
+    const float load = _smoothedMs / settings.targetMs;
+    if (load > 0.8f && load <= 1.0f) {
+        return;
+    }
+    //aim at 90%; shrink fast when over, grow carefully when under
+    const float current = scale();
+    float next = current * std::sqrt(0.9f / load);
+    next = std::min(std::max(next, current * 0.75f), current * 1.1f);
+    next = clampScale(std::min(std::max(next, settings.minScale), settings.maxScale));
+    if (std::fabs(next - current) < 0.01f) {
+        return;
+    }
+    _scale = next;
+    _smoothedMs = 0.0f;
+    _cooldown = FRAME_LATENCY - 1;
+}
+
+bool DynamicResolution::allocate(int width, int height, int samples) {
+    releaseTargets();
+    //the completeness checks decide, glGetError isn't read here
+    GLint maxSamples = 0;
+    glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
+    _requestedSamples = samples;
+    _samples = std::min(std::max(samples, 0), static_cast<int>(maxSamples));
+
+    glGenTextures(1, &_resolveTexture);
+    glBindTexture(GL_TEXTURE_2D, _resolveTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenRenderbuffers(1, &_sceneDepth);
+    glBindRenderbuffer(GL_RENDERBUFFER, _sceneDepth);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, _samples, GL_DEPTH24_STENCIL8, width, height);
+
+    glGenFramebuffers(1, &_sceneFramebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, _sceneFramebuffer);
+    if (_samples > 0) {
+        glGenRenderbuffers(1, &_sceneColor);
+        glBindRenderbuffer(GL_RENDERBUFFER, _sceneColor);
+        glRenderbufferStorageMultisample(GL_RENDERBUFFER, _samples, GL_RGBA8, width, height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, _sceneColor);
+    } else {
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _resolveTexture, 0);
+    }
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, _sceneDepth);
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+
+    if (complete && _samples > 0) {
+        glGenFramebuffers(1, &_resolveFramebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, _resolveFramebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _resolveTexture, 0);
+        complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    }
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (!complete) {
+        GRAPHISQUE_LOG_ERROR("DynamicResolution", "Scene target {}x{} with {} samples incomplete, drawing at native resolution",
+                             width, height, _samples);
+        releaseTargets();
+        return false;
+    }
+    _allocatedWidth = width;
+    _allocatedHeight = height;
+    _failedSamples = -1;
+    return true;
+}
+
+void DynamicResolution::releaseTargets() {
+    if (_resolveFramebuffer != 0) {
+        glDeleteFramebuffers(1, &_resolveFramebuffer);
+    }
+    if (_sceneFramebuffer != 0) {
+        glDeleteFramebuffers(1, &_sceneFramebuffer);
+    }
+    if (_sceneColor != 0) {
+        glDeleteRenderbuffers(1, &_sceneColor);
+    }
+    if (_sceneDepth != 0) {
+        glDeleteRenderbuffers(1, &_sceneDepth);
+    }
+    if (_resolveTexture != 0) {
+        glDeleteTextures(1, &_resolveTexture);
+    }
+    _resolveFramebuffer = _sceneFramebuffer = _sceneColor = _sceneDepth = _resolveTexture = 0;
+    _allocatedWidth = _allocatedHeight = 0;
+}
+
+void DynamicResolution::release() {
+    releaseTargets();
+    if (_compositeShader) {
+        glDeleteQueries(FRAME_LATENCY * 2, &_queries[0][0]);
+    }
+    _compositeShader.reset();
+    _emptyVertexArray.reset();
+    for (bool& issued : _issued) {
+        issued = false;
+    }
+}
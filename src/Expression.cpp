@@ -0,0 +1,317 @@
+#include "Expression.h"
+#include "MemoryArena.h"
+
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+
+
+struct FunctionEntry {
+    const char* name;
+    Expression::OpCode op;
+    int arity;
+};
+
+static const FunctionEntry FUNCTIONS[] = {
+    {"sin", Expression::OpCode::Sin, 1},     {"cos", Expression::OpCode::Cos, 1},
+    {"tan", Expression::OpCode::Tan, 1},     {"asin", Expression::OpCode::Asin, 1},
+    {"acos", Expression::OpCode::Acos, 1},   {"atan", Expression::OpCode::Atan, 1},
+    {"sinh", Expression::OpCode::Sinh, 1},   {"cosh", Expression::OpCode::Cosh, 1},
+    {"tanh", Expression::OpCode::Tanh, 1},   {"exp", Expression::OpCode::Exp, 1},
+    {"log", Expression::OpCode::Log, 1},     {"log10", Expression::OpCode::Log10, 1},
+    {"sqrt", Expression::OpCode::Sqrt, 1},   {"abs", Expression::OpCode::Abs, 1},
+    {"floor", Expression::OpCode::Floor, 1}, {"ceil", Expression::OpCode::Ceil, 1},
+    {"atan2", Expression::OpCode::Atan2, 2}, {"pow", Expression::OpCode::Pow, 2},
+    {"min", Expression::OpCode::Min, 2},     {"max", Expression::OpCode::Max, 2},
+};
+
+static int arityOf(Expression::OpCode op) {
+    switch (op) {
+        case Expression::OpCode::Constant:
+        case Expression::OpCode::VariableX:
+        case Expression::OpCode::VariableY:
+            return 0;
+        case Expression::OpCode::Add:
+        case Expression::OpCode::Subtract:
+        case Expression::OpCode::Multiply:
+        case Expression::OpCode::Divide:
+        case Expression::OpCode::Power:
+        case Expression::OpCode::Atan2:
+        case Expression::OpCode::Pow:
+        case Expression::OpCode::Min:
+        case Expression::OpCode::Max:
+            return 2;
+        default:
+            return 1;
+    }
+}
+
+static float applyUnary(Expression::OpCode op, float a) {
+    switch (op) {
+        case Expression::OpCode::Negate: return -a;
+        case Expression::OpCode::Sin:    return std::sin(a);
+        case Expression::OpCode::Cos:    return std::cos(a);
+        case Expression::OpCode::Tan:    return std::tan(a);
+        case Expression::OpCode::Asin:   return std::asin(a);
+        case Expression::OpCode::Acos:   return std::acos(a);
+        case Expression::OpCode::Atan:   return std::atan(a);
+        case Expression::OpCode::Sinh:   return std::sinh(a);
+        case Expression::OpCode::Cosh:   return std::cosh(a);
+        case Expression::OpCode::Tanh:   return std::tanh(a);
+        case Expression::OpCode::Exp:    return std::exp(a);
+        case Expression::OpCode::Log:    return std::log(a);
+        case Expression::OpCode::Log10:  return std::log10(a);
+        case Expression::OpCode::Sqrt:   return std::sqrt(a);
+        case Expression::OpCode::Abs:    return std::fabs(a);
+        case Expression::OpCode::Floor:  return std::floor(a);
+        case Expression::OpCode::Ceil:   return std::ceil(a);
+        default:                         return a;
+    }
+}
+
+static float applyBinary(Expression::OpCode op, float a, float b) {
+    switch (op) {
+        case Expression::OpCode::Add:      return a + b;
+        case Expression::OpCode::Subtract: return a - b;
+        case Expression::OpCode::Multiply: return a * b;
+        case Expression::OpCode::Divide:   return a / b;
+        case Expression::OpCode::Power:
+        case Expression::OpCode::Pow:      return std::pow(a, b);
+        case Expression::OpCode::Atan2:    return std::atan2(a, b);
+        case Expression::OpCode::Min:      return std::fmin(a, b);
+        case Expression::OpCode::Max:      return std::fmax(a, b);
+        default:                           return a;
+    }
+}
+
+
+// Recursive descent parser emitting postfix code:
+//   expr    := term (('+' | '-') term)*
+//   term    := unary (('*' | '/') unary)*
+//   unary   := ('-' | '+') unary | power
+//   power   := primary ('^' unary)?
+//   primary := number | name | name '(' expr (',' expr)* ')' | '(' expr ')'
+class ExpressionParser {
+    private:
+        const std::string& _text;
+        size_t _pos = 0;
+        std::pmr::vector<Expression::Instruction>& _out;
+        int _depth = 0;
+        int _maxDepth = 0;
+
+        [[noreturn]] void fail(const std::string& message) const {
+            throw std::runtime_error("Expression error at column " + std::to_string(_pos + 1) + ": " + message +
+                                     " in \"" + _text + "\"");
+        }
+
+        void skipSpace() {
+            while (_pos < _text.size() && std::isspace(static_cast<unsigned char>(_text[_pos]))) {
+                ++_pos;
+            }
+        }
+
+        bool accept(char c) {
+            skipSpace();
+            if (_pos < _text.size() && _text[_pos] == c) {
+                ++_pos;
+                return true;
+            }
+            return false;
+        }
+
+        void expect(char c) {
+            if (!accept(c)) {
+                fail(std::string("expected '") + c + "'");
+            }
+        }
+
+        // Emits an instruction, folding it right away when all of its operands are constants
+        void emit(Expression::OpCode op, float value = 0.0f) {
+            int arity = arityOf(op);
+            size_t n = _out.size();
+            bool foldable = arity > 0 && n >= static_cast<size_t>(arity);
+            for (int i = 1; foldable && i <= arity; ++i) {
+                foldable = _out[n - i].op == Expression::OpCode::Constant;
+            }
+            if (foldable) {
+                float result = arity == 1 ? applyUnary(op, _out[n - 1].value)
+                                          : applyBinary(op, _out[n - 2].value, _out[n - 1].value);
+                _out.resize(n - arity);
+                _out.push_back({Expression::OpCode::Constant, result});
+                _depth -= arity - 1;
+                return;
+            }
+            _out.push_back({op, value});
+            _depth += 1 - arity;
+            if (_depth > _maxDepth) {
+                _maxDepth = _depth;
+            }
+        }
+
+        void parseExpr() {
+            parseTerm();
+            for (;;) {
+                if (accept('+')) {
+                    parseTerm();
+                    emit(Expression::OpCode::Add);
+                } else if (accept('-')) {
+                    parseTerm();
+                    emit(Expression::OpCode::Subtract);
+                } else {
+                    return;
+                }
+            }
+        }
+
+        void parseTerm() {
+            parseUnary();
+            for (;;) {
+                if (accept('*')) {
+                    parseUnary();
+                    emit(Expression::OpCode::Multiply);
+                } else if (accept('/')) {
+                    parseUnary();
+                    emit(Expression::OpCode::Divide);
+                } else {
+                    return;
+                }
+            }
+        }
+
+        void parseUnary() {
+            if (accept('-')) {
+                parseUnary();
+                emit(Expression::OpCode::Negate);
+            } else if (accept('+')) {
+                parseUnary();
+            } else {
+                parsePower();
+            }
+        }
+
+        void parsePower() {
+            parsePrimary();
+            if (accept('^')) {
+                parseUnary();
+                emit(Expression::OpCode::Power);
+            }
+        }
+
+        void parsePrimary() {
+            skipSpace();
+            if (_pos >= _text.size()) {
+                fail("unexpected end of input");
+            }
+            char c = _text[_pos];
+            if (std::isdigit(static_cast<unsigned char>(c)) || c == '.') {
+                const char* begin = _text.c_str() + _pos;
+                char* end = nullptr;
+                float value = std::strtof(begin, &end);
+                if (end == begin) {
+                    fail("malformed number");
+                }
+                _pos += static_cast<size_t>(end - begin);
+                emit(Expression::OpCode::Constant, value);
+                return;
+            }
+            if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+                size_t start = _pos;
+                while (_pos < _text.size() && (std::isalnum(static_cast<unsigned char>(_text[_pos])) || _text[_pos] == '_')) {
+                    ++_pos;
+                }
+                parseName(std::string_view(_text).substr(start, _pos - start));
+                return;
+            }
+            if (accept('(')) {
+                parseExpr();
+                expect(')');
+                return;
+            }
+            fail(std::string("unexpected '") + c + "'");
+        }
+
+        void parseName(std::string_view name) {
+            if (accept('(')) {
+                for (const FunctionEntry& function : FUNCTIONS) {
+                    if (name != function.name) {
+                        continue;
+                    }
+                    for (int i = 0; i < function.arity; ++i) {
+                        if (i > 0) {
+                            expect(',');
+                        }
+                        parseExpr();
+                    }
+                    expect(')');
+                    emit(function.op);
+                    return;
+                }
+                fail("unknown function '" + std::string(name) + "'");
+            }
+            if (name == "x") {
+                emit(Expression::OpCode::VariableX);
+            } else if (name == "y") {
+                emit(Expression::OpCode::VariableY);
+            } else if (name == "pi") {
+                emit(Expression::OpCode::Constant, 3.14159265358979f);
+            } else if (name == "e") {
+                emit(Expression::OpCode::Constant, 2.71828182845905f);
+            } else {
+                fail("unknown name '" + std::string(name) + "'");
+            }
+        }
+
+    public:
+        ExpressionParser(const std::string& text, std::pmr::vector<Expression::Instruction>& out) : _text(text), _out(out) {}
+
+        void parse() {
+            parseExpr();
+            skipSpace();
+            if (_pos != _text.size()) {
+                fail("unexpected trailing input");
+            }
+            if (_maxDepth > static_cast<int>(Expression::MAX_STACK)) {
+                fail("expression nests too deeply");
+            }
+        }
+};
+
+
+Expression::Expression(const std::string& source) : _source(source) {
+    //the program grows and shrinks (constant folding) while parsing; only the result is kept
+    ScratchScope scratch;
+    std::pmr::vector<Instruction> program(scratch.resource());
+    ExpressionParser(_source, program).parse();
+    _program.assign(program.begin(), program.end());
+}
+
+float Expression::evaluate(float x, float y) const {
+    float stack[MAX_STACK];
+    size_t top = 0;
+    for (const Instruction& instruction : _program) {
+        switch (instruction.op) {
+            case OpCode::Constant:  stack[top++] = instruction.value; break;
+            case OpCode::VariableX: stack[top++] = x; break;
+            case OpCode::VariableY: stack[top++] = y; break;
+            case OpCode::Add:       --top; stack[top - 1] += stack[top]; break;
+            case OpCode::Subtract:  --top; stack[top - 1] -= stack[top]; break;
+            case OpCode::Multiply:  --top; stack[top - 1] *= stack[top]; break;
+            case OpCode::Divide:    --top; stack[top - 1] /= stack[top]; break;
+            case OpCode::Power:
+            case OpCode::Atan2:
+            case OpCode::Pow:
+            case OpCode::Min:
+            case OpCode::Max:
+                --top;
+                stack[top - 1] = applyBinary(instruction.op, stack[top - 1], stack[top]);
+                break;
+            default:
+                stack[top - 1] = applyUnary(instruction.op, stack[top - 1]);
+                break;
+        }
+    }
+    return top > 0 ? stack[top - 1] : 0.0f;
+}
@@ -0,0 +1,364 @@
+#include "FrameCapture.h"
+
+#include "PngWriter.h"
+#include "Profiler.h"
+#include <cstring>
+#include <iostream>
+
+
+// One begin()/end() recording. Shared by every frame that belongs to it, so the stream is
+// closed by whoever drops the last reference.
+struct FrameCapture::Session {
+    std::string path;
+    CaptureFormat format;
+    int fps;
+    uint64_t maxFrames;
+    bool lossless = false;
+    uint64_t nextFrame = 0;    // GL thread: index handed to the next readback, dropped frames included
+    uint64_t nextSequence = 0; // GL thread: position of the next frame that reaches an encoder
+
+    std::mutex writeMutex;     // stream formats: frames are written strictly in sequence order
+    std::condition_variable writeCv;
+    uint64_t nextWrite = 0;
+    int width = 0;             // of the first frame; streams cannot change size
+    int height = 0;
+    FILE* stream = nullptr;
+    bool failed = false;
+
+    ~Session() {
+        if (stream != nullptr && stream != stdout) {
+            std::fclose(stream);
+        }
+    }
+};
+
+
+// BT.709 limited range, 8 bit fixed point
+static void rgbToYuv444(const uint8_t* rgba, int width, int height, std::vector<uint8_t>& out) {
+    const size_t plane = static_cast<size_t>(width) * height;
+    out.resize(plane * 3);
+    uint8_t* yPlane = out.data();
+    uint8_t* uPlane = yPlane + plane;
+    uint8_t* vPlane = uPlane + plane;
+    for (int row = 0; row < height; ++row) {
+        const uint8_t* src = rgba + static_cast<size_t>(height - 1 - row) * width * 4; // bottom-up readback
+        size_t dst = static_cast<size_t>(row) * width;
+        for (int x = 0; x < width; ++x, src += 4, ++dst) {
+            int r = src[0], g = src[1], b = src[2];
+            yPlane[dst] = static_cast<uint8_t>(16 + ((47 * r + 157 * g + 16 * b + 128) >> 8));
+            uPlane[dst] = static_cast<uint8_t>(128 + ((-26 * r - 87 * g + 112 * b + 128) >> 8));
+            vPlane[dst] = static_cast<uint8_t>(128 + ((112 * r - 102 * g - 10 * b + 128) >> 8));
+        }
+    }
+}
+
+static bool endsWith(const std::string& text, const char* suffix) {
+    size_t length = std::strlen(suffix);
+    return text.size() >= length && text.compare(text.size() - length, length, suffix) == 0;
+}
+
+// "{}" becomes the zero padded frame number; without one it goes before the extension
+static std::string framePath(const std::string& pattern, uint64_t frame) {
+    char number[32];
+    std::snprintf(number, sizeof(number), "%05llu", static_cast<unsigned long long>(frame));
+    size_t marker = pattern.find("{}");
+    if (marker != std::string::npos) {
+        return pattern.substr(0, marker) + number + pattern.substr(marker + 2);
+    }
+    size_t dot = pattern.find_last_of('.');
+    size_t slash = pattern.find_last_of('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        dot = pattern.size();
+    }
+    return pattern.substr(0, dot) + "_" + number + pattern.substr(dot);
+}
+
+static void rgbaToRgbFlipped(const uint8_t* rgba, int width, int height, std::vector<uint8_t>& out) {
+    out.resize(static_cast<size_t>(width) * height * 3);
+    uint8_t* dst = out.data();
+    for (int row = height - 1; row >= 0; --row) {
+        const uint8_t* src = rgba + static_cast<size_t>(row) * width * 4;
+        for (int x = 0; x < width; ++x, src += 4, dst += 3) {
+            dst[0] = src[0];
+            dst[1] = src[1];
+            dst[2] = src[2];
+        }
+    }
+}
+
+
+FrameCapture::FrameCapture(unsigned encoderThreads) {
+    if (encoderThreads == 0) {
+        encoderThreads = 1;
+    }
+    for (unsigned i = 0; i < encoderThreads; ++i) {
+        _encoders.emplace_back(&FrameCapture::encoderLoop, this);
+    }
+}
+
+FrameCapture::~FrameCapture() {
+    {
+        std::lock_guard<std::mutex> lock(_queueMutex);
+        _stopping = true;
+    }
+    _queueCv.notify_all();
+    for (auto& encoder : _encoders) {
+        encoder.join();
+    }
+    // GL resources must have been released through shutdown() on the GL thread
+}
+
+CaptureFormat FrameCapture::formatForPath(const std::string& path) {
+    if (path == "-" || endsWith(path, ".y4m")) {
+        return CaptureFormat::Y4m;
+    }
+    if (endsWith(path, ".ppm")) {
+        return CaptureFormat::PpmStream;
+    }
+    return CaptureFormat::Png;
+}
+
+bool FrameCapture::begin(const std::string& path, CaptureFormat format, int fps, uint64_t maxFrames, bool lossless) {
+    auto session = std::make_shared<Session>();
+    session->path = path;
+    session->format = format;
+    session->fps = fps > 0 ? fps : 30;
+    session->maxFrames = maxFrames;
+    session->lossless = lossless;
+    if (format != CaptureFormat::Png) {
+        session->stream = path == "-" ? stdout : std::fopen(path.c_str(), "wb");
+        if (session->stream == nullptr) {
+            std::cerr << "(FrameCapture) Cannot open " << path << std::endl;
+            return false;
+        }
+    }
+    std::lock_guard<std::mutex> lock(_sessionMutex);
+    _session = std::move(session);
+    return true;
+}
+
+void FrameCapture::end() {
+    std::lock_guard<std::mutex> lock(_sessionMutex);
+    _session.reset();
+}
+
+bool FrameCapture::isActive() const {
+    std::lock_guard<std::mutex> lock(_sessionMutex);
+    return _session != nullptr;
+}
+
+bool FrameCapture::readback(int width, int height, const std::string& path) {
+    std::shared_ptr<Session> session;
+    {
+        std::lock_guard<std::mutex> lock(_sessionMutex);
+        session = _session;
+    }
+    if (!session || width <= 0 || height <= 0) {
+        return false;
+    }
+    if (session->maxFrames != 0 && session->nextFrame >= session->maxFrames) {
+        end();
+        return false;
+    }
+    while (_slotsInUse == RING_SIZE && session->lossless) {
+        // the oldest readback has to land before its slot can take this one
+        glClientWaitSync(_ring[_oldestSlot].fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+        poll();
+    }
+    if (_slotsInUse == RING_SIZE) {
+        // the GPU is more than RING_SIZE frames behind; skip this capture instead of waiting
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        session->nextFrame++;
+        return false;
+    }
+    GRAPHISQUE_PROFILE_SCOPE("Capture readback");
+
+    Slot& slot = _ring[_nextSlot];
+    const size_t bytes = static_cast<size_t>(width) * height * 4;
+    if (!slot.buffer) {
+        slot.buffer = std::make_unique<GLBuffer>(GL_PIXEL_PACK_BUFFER, GL_STREAM_READ);
+    }
+    if (slot.buffer->getSize() != bytes) {
+        slot.buffer->resize(bytes);
+    }
+    slot.buffer->bind();
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr); // into the buffer, returns at once
+    slot.buffer->unbind(); // later glReadPixels calls must not land in the PBO
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.session = std::move(session);
+    slot.frame = slot.session->nextFrame++;
+    slot.width = width;
+    slot.height = height;
+    slot.path = path;
+
+    _nextSlot = (_nextSlot + 1) % RING_SIZE;
+    ++_slotsInUse;
+    return true;
+}
+
+void FrameCapture::poll() {
+    // slots complete in submission order, so stop at the first one still in flight
+    while (_slotsInUse > 0) {
+        Slot& slot = _ring[_oldestSlot];
+        GLenum status = glClientWaitSync(slot.fence, 0, 0);
+        if (status == GL_TIMEOUT_EXPIRED) {
+            return;
+        }
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+        if (status == GL_WAIT_FAILED || !mapSlot(slot)) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        slot.session.reset();
+        _oldestSlot = (_oldestSlot + 1) % RING_SIZE;
+        --_slotsInUse;
+    }
+}
+
+bool FrameCapture::mapSlot(Slot& slot) {
+    GRAPHISQUE_PROFILE_SCOPE("Capture map");
+    std::unique_ptr<std::vector<uint8_t>> pixels;
+    {
+        std::unique_lock<std::mutex> lock(_queueMutex);
+        if (slot.session->lossless) {
+            _roomCv.wait(lock, [this] { return _queue.size() < MAX_QUEUED_FRAMES; });
+        } else if (_queue.size() >= MAX_QUEUED_FRAMES) {
+            return false; // encoders are behind
+        }
+        if (!_pixelPool.empty()) {
+            pixels = std::move(_pixelPool.back());
+            _pixelPool.pop_back();
+        }
+    }
+    if (!pixels) {
+        pixels = std::make_unique<std::vector<uint8_t>>();
+    }
+
+    const size_t bytes = slot.buffer->getSize();
+    pixels->resize(bytes);
+    try {
+        const void* mapped = slot.buffer->mapRange(0, bytes, GL_MAP_READ_BIT);
+        std::memcpy(pixels->data(), mapped, bytes);
+        slot.buffer->unmap();
+        slot.buffer->unbind();
+    } catch (const std::exception& e) {
+        std::cerr << "(FrameCapture) " << e.what() << std::endl;
+        slot.buffer->unbind();
+        return false;
+    }
+
+    EncodeTask task;
+    task.session = slot.session;
+    task.frame = slot.frame;
+    task.sequence = slot.session->nextSequence++;
+    task.width = slot.width;
+    task.height = slot.height;
+    task.path = std::move(slot.path);
+    task.pixels = std::move(pixels);
+    {
+        std::lock_guard<std::mutex> lock(_queueMutex);
+        _queue.push_back(std::move(task));
+    }
+    _queueCv.notify_one();
+    return true;
+}
+
+void FrameCapture::flush() {
+    for (size_t i = 0; i < _slotsInUse; ++i) {
+        Slot& slot = _ring[(_oldestSlot + i) % RING_SIZE];
+        glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+    }
+    poll();
+    std::unique_lock<std::mutex> lock(_queueMutex);
+    _roomCv.wait(lock, [this] { return _queue.empty() && _encoding == 0; });
+}
+
+void FrameCapture::shutdown() {
+    end();
+    for (size_t i = 0; i < _slotsInUse; ++i) {
+        Slot& slot = _ring[(_oldestSlot + i) % RING_SIZE];
+        glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+    }
+    poll();
+    for (Slot& slot : _ring) {
+        slot.buffer.reset();
+    }
+}
+
+void FrameCapture::encoderLoop() {
+    Profiler::instance().setThreadName("capture encoder");
+    for (;;) {
+        EncodeTask task;
+        {
+            std::unique_lock<std::mutex> lock(_queueMutex);
+            _queueCv.wait(lock, [this] { return _stopping || !_queue.empty(); });
+            if (_queue.empty()) {
+                return; // stopping, and everything queued has been written
+            }
+            task = std::move(_queue.front());
+            _queue.pop_front();
+            ++_encoding;
+        }
+        _roomCv.notify_all();
+        encode(task);
+        {
+            std::lock_guard<std::mutex> lock(_queueMutex);
+            _pixelPool.push_back(std::move(task.pixels));
+            --_encoding;
+        }
+        _roomCv.notify_all();
+    }
+}
+
+void FrameCapture::encode(EncodeTask& task) {
+    GRAPHISQUE_PROFILE_SCOPE("Capture encode");
+    Session& session = *task.session;
+    const uint8_t* rgba = task.pixels->data();
+
+    if (session.format == CaptureFormat::Png) {
+        // a single shot keeps its name as given
+        bool single = session.maxFrames == 1 && session.path.find("{}") == std::string::npos;
+        std::string path = !task.path.empty() ? std::move(task.path) : single ? session.path : framePath(session.path, task.frame);
+        if (PngWriter::write(path, task.width, task.height, rgba, true)) {
+            _captured.fetch_add(1, std::memory_order_relaxed);
+        }
+        return;
+    }
+
+    // conversion runs in parallel, only the write itself is serialised
+    thread_local std::vector<uint8_t> converted;
+    if (session.format == CaptureFormat::Y4m) {
+        rgbToYuv444(rgba, task.width, task.height, converted);
+    } else {
+        rgbaToRgbFlipped(rgba, task.width, task.height, converted);
+    }
+
+    std::unique_lock<std::mutex> lock(session.writeMutex);
+    session.writeCv.wait(lock, [&] { return session.nextWrite == task.sequence; });
+    if (session.nextWrite == 0) {
+        session.width = task.width;
+        session.height = task.height;
+        if (session.format == CaptureFormat::Y4m) {
+            std::fprintf(session.stream, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C444\n", task.width, task.height, session.fps);
+        }
+    }
+    if (task.width != session.width || task.height != session.height) {
+        _dropped.fetch_add(1, std::memory_order_relaxed); // resized mid recording
+    } else if (!session.failed) {
+        if (session.format == CaptureFormat::Y4m) {
+            std::fputs("FRAME\n", session.stream);
+        } else {
+            std::fprintf(session.stream, "P6\n%d %d\n255\n", task.width, task.height);
+        }
+        if (std::fwrite(converted.data(), 1, converted.size(), session.stream) == converted.size()) {
+            _captured.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            std::cerr << "(FrameCapture) Write to " << session.path << " failed, stopping the stream" << std::endl;
+            session.failed = true;
+        }
+    }
+    session.nextWrite++;
+    lock.unlock();
+    session.writeCv.notify_all();
+}
@@ -0,0 +1,84 @@
+#include "FramePacer.h"
+#include "RenderStats.h"
+
+#include <algorithm>
+
+
+// Longest wait for a queued frame; a GPU that takes longer than this is hung, not busy
+static const GLuint64 FENCE_TIMEOUT_NS = 250000000;
+
+
+void FramePacer::setMaxQueuedFrames(int frames) {
+    _maxQueued = std::min(std::max(frames, 0), MAX_QUEUED_FRAMES);
+}
+
+void FramePacer::endFrame(double inputTime, double now) {
+    if (_slots[0].query == 0) {
+        for (Slot& slot : _slots) {
+            glGenQueries(1, &slot.query);
+        }
+    }
+    //earlier frames' results, whichever are in by now
+    for (Slot& slot : _slots) {
+        readLatency(slot);
+    }
+
+    Slot& slot = _slots[_next];
+    if (slot.fence != nullptr) {
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+    }
+    //a slot still waiting for its result after SLOT_COUNT frames is dropped unmeasured
+    slot.inputTime = 0.0;
+    if (inputTime > 0.0) {
+        glQueryCounter(slot.query, GL_TIMESTAMP);
+        glGetInteger64v(GL_TIMESTAMP, &slot.gpuTime);
+        slot.cpuTime = now;
+        slot.inputTime = inputTime;
+    }
+
+    const int maxQueued = _maxQueued.load(std::memory_order_relaxed);
+    if (maxQueued > 0) {
+        slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        //the frame maxQueued frames back has to be done before the next one starts
+        Slot& queued = _slots[(_next + SLOT_COUNT - maxQueued) % SLOT_COUNT];
+        if (queued.fence != nullptr) {
+            glClientWaitSync(queued.fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT_NS);
+            glDeleteSync(queued.fence);
+            queued.fence = nullptr;
+        }
+    }
+    _next = (_next + 1) % SLOT_COUNT;
+}
+
+void FramePacer::readLatency(Slot& slot) {
+    if (slot.inputTime <= 0.0) {
+        return;
+    }
+    GLint available = 0;
+    glGetQueryObjectiv(slot.query, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) {
+        return;
+    }
+    GLuint64 done = 0;
+    glGetQueryObjectui64v(slot.query, GL_QUERY_RESULT, &done);
+    double gpuSeconds = std::max(static_cast<double>(static_cast<GLint64>(done) - slot.gpuTime), 0.0) / 1e9;
+    double latencyMs = (slot.cpuTime + gpuSeconds - slot.inputTime) * 1000.0;
+    slot.inputTime = 0.0;
+
+    _smoothedMs = _smoothedMs > 0.0 ? _smoothedMs * 0.75 + latencyMs * 0.25 : latencyMs;
+    RenderStats::setInputLatency(_smoothedMs);
+}
+
+void FramePacer::release() {
+    for (Slot& slot : _slots) {
+        if (slot.fence != nullptr) {
+            glDeleteSync(slot.fence);
+        }
+        if (slot.query != 0) {
+            glDeleteQueries(1, &slot.query);
+        }
+        slot = Slot();
+    }
+    _next = 0;
+}
@@ -0,0 +1,54 @@
+#include "FrameScheduler.h"
+#include "Logger.h"
+#include "Profiler.h"
+
+#include <chrono>
+
+
+void FrameScheduler::enqueue(std::string name, ResumableTask task) {
+    std::lock_guard<std::mutex> lock(_incomingMutex);
+    _incoming.push_back({std::move(name), std::move(task)});
+    _pending.fetch_add(1, std::memory_order_release);
+}
+
+size_t FrameScheduler::runFrame() {
+    GRAPHISQUE_PROFILE_FUNCTION();
+    using Clock = std::chrono::steady_clock;
+    {
+        std::lock_guard<std::mutex> lock(_incomingMutex);
+        while (!_incoming.empty()) {
+            _tasks.push_back(std::move(_incoming.front()));
+            _incoming.pop_front();
+        }
+    }
+
+    const auto start = Clock::now();
+    const auto deadline = start + std::chrono::duration_cast<Clock::duration>(
+                                      std::chrono::duration<double, std::milli>(_budgetMs));
+    size_t slices = 0;
+    while (!_tasks.empty()) {
+        // always run one slice so a task that overshoots the budget still finishes eventually
+        if (slices > 0 && Clock::now() >= deadline) {
+            break;
+        }
+        Entry& entry = _tasks.front();
+        TaskStatus status;
+        try {
+            status = entry.task();
+        } catch (const std::exception& e) {
+            GRAPHISQUE_LOG_ERROR("FrameScheduler", "Task '{}' failed: {}", entry.name, e.what());
+            status = TaskStatus::Done;
+        }
+        ++slices;
+        if (status == TaskStatus::Continue && _tasks.size() > 1) {
+            // round robin, so one long task (a poster) doesn't hold up the rest for its whole run
+            _tasks.push_back(std::move(_tasks.front()));
+            _tasks.pop_front();
+        } else if (status == TaskStatus::Done) {
+            _tasks.pop_front();
+            _pending.fetch_sub(1, std::memory_order_release);
+        }
+    }
+    _lastFrameMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    return slices;
+}
@@ -0,0 +1,288 @@
+#include "GLResourceManager.h"
+
+
+// Enabled arrays a recycled VAO could still have from its previous owner (GL guarantees 16)
+static const GLuint RECYCLED_ATTRIBUTES = 16;
+
+
+GLResourceManager& GLResourceManager::instance() {
+    static GLResourceManager manager;
+    return manager;
+}
+
+GLResourceManager::GLResourceManager() {
+    //releases happen from destructors, keep them from allocating in steady state
+    _pending.reserve(256);
+    _processing.reserve(256);
+    for (RetiringBuffers& batch : _retiring) {
+        batch.names.reserve(64);
+    }
+}
+
+GLResourceManager::Slot* GLResourceManager::find(GLHandle handle) {
+    if (handle.index == 0 || handle.index > _slots.size()) {
+        return nullptr;
+    }
+    Slot& slot = _slots[handle.index - 1];
+    return slot.alive && slot.generation == handle.generation ? &slot : nullptr;
+}
+
+const GLResourceManager::Slot* GLResourceManager::find(GLHandle handle) const {
+    return const_cast<GLResourceManager*>(this)->find(handle);
+}
+
+GLHandle GLResourceManager::create(GLResourceType type, GLuint& name) {
+    name = 0;
+    bool recycled = false;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::vector<GLuint>& pool = type == GLResourceType::Buffer ? _bufferPool : _vertexArrayPool;
+        if (!pool.empty()) {
+            name = pool.back();
+            pool.pop_back();
+            recycled = true;
+        }
+    }
+    if (!recycled) {
+        if (type == GLResourceType::Buffer) {
+            glGenBuffers(1, &name);
+        } else {
+            glGenVertexArrays(1, &name);
+        }
+        if (name == 0) {
+            return GLHandle();
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    uint32_t index;
+    if (!_freeSlots.empty()) {
+        index = _freeSlots.back();
+        _freeSlots.pop_back();
+    } else {
+        _slots.emplace_back();
+        index = static_cast<uint32_t>(_slots.size());
+    }
+    Slot& slot = _slots[index - 1];
+    slot.name = name;
+    slot.size = 0;
+    slot.type = type;
+    slot.alive = true;
+    if (recycled) {
+        ++_namesRecycled;
+    } else {
+        ++_namesGenerated;
+    }
+    ++(type == GLResourceType::Buffer ? _liveBuffers : _liveVertexArrays);
+
+    GLHandle handle;
+    handle.index = index;
+    handle.generation = slot.generation;
+    return handle;
+}
+
+void GLResourceManager::release(GLHandle handle) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    Slot* slot = find(handle);
+    if (slot == nullptr) {
+        return;
+    }
+    if (!_shutDown) {
+        _pending.push_back({slot->name, slot->type});
+    }
+    --(slot->type == GLResourceType::Buffer ? _liveBuffers : _liveVertexArrays);
+    slot->name = 0;
+    slot->size = 0;
+    slot->alive = false;
+    ++slot->generation; // outstanding handles go stale
+    _freeSlots.push_back(handle.index);
+}
+
+GLuint GLResourceManager::name(GLHandle handle) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const Slot* slot = find(handle);
+    return slot != nullptr ? slot->name : 0;
+}
+
+bool GLResourceManager::isAlive(GLHandle handle) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return find(handle) != nullptr;
+}
+
+void GLResourceManager::setSize(GLHandle handle, size_t bytes) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (Slot* slot = find(handle)) {
+        slot->size = bytes;
+    }
+}
+
+size_t GLResourceManager::size(GLHandle handle) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const Slot* slot = find(handle);
+    return slot != nullptr ? slot->size : 0;
+}
+
+void GLResourceManager::reclaimRetired() {
+    while (_retiringBatches > 0) {
+        RetiringBuffers& batch = _retiring[_retiringHead];
+        GLenum status = glClientWaitSync(batch.fence, 0, 0);
+        if (status == GL_TIMEOUT_EXPIRED) {
+            return; // later batches were fenced after this one, they aren't done either
+        }
+        glDeleteSync(batch.fence);
+        batch.fence = nullptr;
+        if (status == GL_WAIT_FAILED) {
+            deleteNames(GLResourceType::Buffer, batch.names);
+        }
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (status != GL_WAIT_FAILED) {
+                _bufferPool.insert(_bufferPool.end(), batch.names.begin(), batch.names.end());
+            }
+            _retiringNames -= batch.names.size();
+        }
+        batch.names.clear();
+        _retiringHead = (_retiringHead + 1) % RETIRING_BATCHES;
+        --_retiringBatches;
+    }
+}
+
+size_t GLResourceManager::processDeletions() {
+    //names orphaned on earlier frames whose orphan the GPU has finished become reusable
+    reclaimRetired();
+
+    size_t bufferRoom, vertexArrayRoom;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_pending.empty()) {
+            return 0;
+        }
+        _processing.swap(_pending);
+        //the pools only shrink until we add to them below, so this room is still there then
+        size_t bufferHeld = _bufferPool.size() + _retiringNames;
+        bufferRoom = _poolLimit > bufferHeld ? _poolLimit - bufferHeld : 0;
+        //with every batch still waiting there is nowhere to fence new names; delete them
+        if (_retiringBatches == RETIRING_BATCHES) {
+            bufferRoom = 0;
+        }
+        vertexArrayRoom = _poolLimit > _vertexArrayPool.size() ? _poolLimit - _vertexArrayPool.size() : 0;
+    }
+
+    //GL calls happen outside the lock so releasing threads never wait on the driver
+    bool touchedBuffers = false, touchedVertexArrays = false;
+    for (PendingDelete& pending : _processing) {
+        if (pending.type == GLResourceType::Buffer) {
+            if (bufferRoom == 0) {
+                glDeleteBuffers(1, &pending.name);
+                pending.name = 0;
+                continue;
+            }
+            --bufferRoom;
+            //orphan the store so pooled names hold no memory
+            glBindBuffer(GL_COPY_WRITE_BUFFER, pending.name);
+            glBufferData(GL_COPY_WRITE_BUFFER, 0, nullptr, GL_STATIC_DRAW);
+            touchedBuffers = true;
+        } else {
+            if (vertexArrayRoom == 0) {
+                glDeleteVertexArrays(1, &pending.name);
+                pending.name = 0;
+                continue;
+            }
+            --vertexArrayRoom;
+            glBindVertexArray(pending.name);
+            for (GLuint attribute = 0; attribute < RECYCLED_ATTRIBUTES; ++attribute) {
+                glDisableVertexAttribArray(attribute);
+            }
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+            touchedVertexArrays = true;
+        }
+    }
+    if (touchedVertexArrays) {
+        glBindVertexArray(0);
+    }
+    if (touchedBuffers) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+
+    //VAOs stay on this context and go straight back; buffers wait for the orphan to finish
+    //on the GPU, or the upload context could write a name before its orphan lands
+    RetiringBuffers* batch = nullptr;
+    if (touchedBuffers) {
+        batch = &_retiring[(_retiringHead + _retiringBatches) % RETIRING_BATCHES];
+        batch->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glFlush();
+        ++_retiringBatches;
+    }
+    size_t processed = _processing.size();
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (const PendingDelete& pending : _processing) {
+            if (pending.name == 0) {
+                continue;
+            }
+            if (pending.type == GLResourceType::Buffer) {
+                batch->names.push_back(pending.name);
+                ++_retiringNames;
+            } else {
+                _vertexArrayPool.push_back(pending.name);
+            }
+        }
+    }
+    _processing.clear();
+    return processed;
+}
+
+void GLResourceManager::deleteNames(GLResourceType type, const std::vector<GLuint>& names) {
+    if (names.empty()) {
+        return;
+    }
+    if (type == GLResourceType::Buffer) {
+        glDeleteBuffers(static_cast<GLsizei>(names.size()), names.data());
+    } else {
+        glDeleteVertexArrays(static_cast<GLsizei>(names.size()), names.data());
+    }
+}
+
+void GLResourceManager::shutdown() {
+    std::vector<GLuint> buffers, vertexArrays;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        buffers.swap(_bufferPool);
+        vertexArrays.swap(_vertexArrayPool);
+        for (const PendingDelete& pending : _pending) {
+            (pending.type == GLResourceType::Buffer ? buffers : vertexArrays).push_back(pending.name);
+        }
+        _pending.clear();
+        _shutDown = true;
+        //deleting a name needs no wait on its orphan
+        for (; _retiringBatches > 0; --_retiringBatches) {
+            RetiringBuffers& batch = _retiring[_retiringHead];
+            glDeleteSync(batch.fence);
+            batch.fence = nullptr;
+            buffers.insert(buffers.end(), batch.names.begin(), batch.names.end());
+            batch.names.clear();
+            _retiringHead = (_retiringHead + 1) % RETIRING_BATCHES;
+        }
+        _retiringNames = 0;
+    }
+    deleteNames(GLResourceType::Buffer, buffers);
+    deleteNames(GLResourceType::VertexArray, vertexArrays);
+}
+
+void GLResourceManager::setPoolLimit(size_t names) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _poolLimit = names;
+}
+
+GLResourceManager::Stats GLResourceManager::stats() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    Stats stats;
+    stats.liveBuffers = _liveBuffers;
+    stats.liveVertexArrays = _liveVertexArrays;
+    stats.pooledBuffers = _bufferPool.size();
+    stats.pooledVertexArrays = _vertexArrayPool.size();
+    stats.pendingDeletes = _pending.size() + _retiringNames;
+    stats.namesGenerated = _namesGenerated;
+    stats.namesRecycled = _namesRecycled;
+    return stats;
+}
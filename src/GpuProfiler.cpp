@@ -0,0 +1,85 @@
+#include "GpuProfiler.h"
+
+
+GpuProfiler& GpuProfiler::instance() {
+    static GpuProfiler profiler;
+    return profiler;
+}
+
+bool GpuProfiler::init() {
+    if (_initialized) {
+        return true;
+    }
+    for (int frame = 0; frame < FRAME_LATENCY; ++frame) {
+        glGenQueries(MAX_SCOPES_PER_FRAME, _queries[frame]);
+        _pending[frame].reserve(MAX_SCOPES_PER_FRAME);
+    }
+    _initialized = glGetError() == GL_NO_ERROR;
+    return _initialized;
+}
+
+void GpuProfiler::shutdown() {
+    if (!_initialized) {
+        return;
+    }
+    for (int frame = 0; frame < FRAME_LATENCY; ++frame) {
+        glDeleteQueries(MAX_SCOPES_PER_FRAME, _queries[frame]);
+        _pending[frame].clear();
+    }
+    _initialized = false;
+}
+
+void GpuProfiler::beginFrame() {
+    if (!_initialized) {
+        return;
+    }
+    // This slot was filled FRAME_LATENCY frames ago; its results are normally long available
+    std::vector<PendingQuery>& pending = _pending[_frame % FRAME_LATENCY];
+    double frameMs = 0.0;
+    bool complete = true;
+    for (const PendingQuery& entry : pending) {
+        GLint available = 0;
+        glGetQueryObjectiv(entry.query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            // never wait; drop the sample instead
+            ++_skippedReadbacks;
+            complete = false;
+            continue;
+        }
+        GLuint64 elapsedNs = 0;
+        glGetQueryObjectui64v(entry.query, GL_QUERY_RESULT, &elapsedNs);
+        frameMs += static_cast<double>(elapsedNs) / 1e6;
+        Profiler::instance().record(entry.name, entry.issuedNs, entry.issuedNs + elapsedNs, 0, true);
+    }
+    if (!pending.empty() && complete) {
+        _lastFrameGpuMs = frameMs;
+    }
+    pending.clear();
+}
+
+void GpuProfiler::endFrame() {
+    if (_scopeOpen) {
+        endScope();
+    }
+    ++_frame;
+}
+
+bool GpuProfiler::beginScope(const char* name) {
+    std::vector<PendingQuery>& pending = _pending[_frame % FRAME_LATENCY];
+    if (!_initialized || _scopeOpen || pending.size() >= MAX_SCOPES_PER_FRAME) {
+        return false;
+    }
+    GLuint query = _queries[_frame % FRAME_LATENCY][pending.size()];
+    pending.push_back({name, Profiler::nowNs(), query});
+    glBeginQuery(GL_TIME_ELAPSED, query);
+    _scopeOpen = true;
+    return true;
+}
+
+void GpuProfiler::endScope() {
+    if (!_scopeOpen) {
+        return;
+    }
+    glEndQuery(GL_TIME_ELAPSED);
+    _scopeOpen = false;
+}
@@ -0,0 +1,231 @@
+#include "HardwareCounters.h"
+
+#include <atomic>
+#include <cstring>
+#include <iostream>
+
+#ifdef __linux__
+#include <cerrno>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+static std::atomic<bool> g_scopesEnabled{false};
+
+
+const char* hardwareCounterName(HardwareCounter counter) {
+    switch (counter) {
+        case HardwareCounter::Cycles:          return "cycles";
+        case HardwareCounter::Instructions:    return "instructions";
+        case HardwareCounter::BranchMisses:    return "branch-misses";
+        case HardwareCounter::L1DataMisses:    return "L1d-misses";
+        case HardwareCounter::LastLevelMisses: return "LLC-misses";
+        default:                               return "";
+    }
+}
+
+
+bool CounterValues::any() const {
+    for (bool v : valid) {
+        if (v) {
+            return true;
+        }
+    }
+    return false;
+}
+
+double CounterValues::ipc() const {
+    if (!has(HardwareCounter::Cycles) || !has(HardwareCounter::Instructions) || get(HardwareCounter::Cycles) == 0) {
+        return 0.0;
+    }
+    return static_cast<double>(get(HardwareCounter::Instructions)) / static_cast<double>(get(HardwareCounter::Cycles));
+}
+
+CounterValues& CounterValues::operator+=(const CounterValues& other) {
+    for (size_t i = 0; i < COUNT; ++i) {
+        values[i] += other.values[i];
+        valid[i] = valid[i] || other.valid[i];
+    }
+    return *this;
+}
+
+
+#ifdef __linux__
+
+static int openCounter(HardwareCounter counter) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    const uint64_t readMiss = (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    switch (counter) {
+        case HardwareCounter::Cycles:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case HardwareCounter::Instructions:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case HardwareCounter::BranchMisses:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        case HardwareCounter::L1DataMisses:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_L1D | readMiss;
+            break;
+        case HardwareCounter::LastLevelMisses:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_LL | readMiss;
+            break;
+        default:
+            return -1;
+    }
+    //this thread, any CPU
+    return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+HardwareCounters::HardwareCounters() {
+    static std::atomic<bool> reported{false};
+    int firstError = 0;
+    for (size_t i = 0; i < CounterValues::COUNT; ++i) {
+        _fds[i] = openCounter(static_cast<HardwareCounter>(i));
+        if (_fds[i] < 0 && firstError == 0) {
+            firstError = errno;
+        }
+    }
+    if (!isAvailable() && !reported.exchange(true)) {
+        std::cerr << "(HardwareCounters) perf_event_open unavailable: " << std::strerror(firstError)
+                  << " (see /proc/sys/kernel/perf_event_paranoid); counters are disabled" << std::endl;
+    }
+}
+
+HardwareCounters::~HardwareCounters() {
+    for (int fd : _fds) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+}
+
+HardwareCounters::Readings HardwareCounters::sample() const {
+    Readings readings;
+    for (size_t i = 0; i < CounterValues::COUNT; ++i) {
+        if (_fds[i] < 0) {
+            continue;
+        }
+        uint64_t data[3];
+        if (read(_fds[i], data, sizeof(data)) == static_cast<ssize_t>(sizeof(data))) {
+            readings.counters[i] = {data[0], data[1], data[2]};
+        }
+    }
+    return readings;
+}
+
+#else
+
+HardwareCounters::HardwareCounters() {
+    for (int& fd : _fds) {
+        fd = -1;
+    }
+}
+
+HardwareCounters::~HardwareCounters() = default;
+
+HardwareCounters::Readings HardwareCounters::sample() const {
+    return Readings();
+}
+
+#endif
+
+
+bool HardwareCounters::isAvailable() const {
+    for (int fd : _fds) {
+        if (fd >= 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+CounterValues HardwareCounters::difference(const Readings& from, const Readings& to) const {
+    CounterValues values;
+    for (size_t i = 0; i < CounterValues::COUNT; ++i) {
+        const Reading& a = from.counters[i];
+        const Reading& b = to.counters[i];
+        uint64_t running = b.runningNs - a.runningNs;
+        if (_fds[i] < 0 || running == 0) {
+            continue; // never scheduled onto the PMU during the interval
+        }
+        //the kernel time-slices counters when there are more than the PMU has
+        double scale = static_cast<double>(b.enabledNs - a.enabledNs) / static_cast<double>(running);
+        values.values[i] = static_cast<uint64_t>(static_cast<double>(b.value - a.value) * scale);
+        values.valid[i] = true;
+    }
+    return values;
+}
+
+HardwareCounters& HardwareCounters::forThisThread() {
+    thread_local HardwareCounters counters;
+    return counters;
+}
+
+void HardwareCounters::setScopesEnabled(bool enabled) {
+    g_scopesEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool HardwareCounters::scopesEnabled() {
+    return g_scopesEnabled.load(std::memory_order_relaxed);
+}
+
+
+CounterScopeStats& CounterScopeStats::instance() {
+    static CounterScopeStats stats;
+    return stats;
+}
+
+void CounterScopeStats::add(const char* name, const CounterValues& values) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    Entry& entry = _entries[name];
+    ++entry.calls;
+    entry.totals += values;
+}
+
+std::map<std::string, CounterScopeStats::Entry> CounterScopeStats::entries() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _entries;
+}
+
+void CounterScopeStats::print(std::FILE* out) const {
+    std::map<std::string, Entry> snapshot = entries();
+    if (snapshot.empty()) {
+        return;
+    }
+    std::fprintf(out, "%-24s %10s %14s %6s %12s %12s %12s\n", "scope", "calls", "instructions", "IPC",
+                 "L1d MPKI", "LLC MPKI", "branch MPKI");
+    for (const auto& [name, entry] : snapshot) {
+        const CounterValues& t = entry.totals;
+        //misses per thousand instructions, "-" where a counter is missing
+        auto mpki = [&t](HardwareCounter counter) {
+            if (!t.has(counter) || !t.has(HardwareCounter::Instructions) || t.get(HardwareCounter::Instructions) == 0) {
+                return std::string("-");
+            }
+            char text[32];
+            std::snprintf(text, sizeof(text), "%.3f",
+                          1000.0 * static_cast<double>(t.get(counter)) / static_cast<double>(t.get(HardwareCounter::Instructions)));
+            return std::string(text);
+        };
+        std::fprintf(out, "%-24s %10llu %14llu %6.2f %12s %12s %12s\n", name.c_str(),
+                     static_cast<unsigned long long>(entry.calls),
+                     static_cast<unsigned long long>(t.get(HardwareCounter::Instructions)), t.ipc(),
+                     mpki(HardwareCounter::L1DataMisses).c_str(), mpki(HardwareCounter::LastLevelMisses).c_str(),
+                     mpki(HardwareCounter::BranchMisses).c_str());
+    }
+}
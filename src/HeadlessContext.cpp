@@ -0,0 +1,165 @@
+#include "HeadlessContext.h"
+
+#include <iostream>
+
+#ifdef GRAPHISQUE_HAVE_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <cstring>
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+
+static bool hasExtension(const char* extensions, const char* name) {
+    if (extensions == nullptr) {
+        return false;
+    }
+    size_t length = std::strlen(name);
+    for (const char* p = std::strstr(extensions, name); p != nullptr; p = std::strstr(p + length, name)) {
+        if ((p == extensions || p[-1] == ' ') && (p[length] == ' ' || p[length] == '\0')) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static EGLDisplay openDisplay() {
+    const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (hasExtension(clientExtensions, "EGL_MESA_platform_surfaceless")) {
+        auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+            eglGetProcAddress("eglGetPlatformDisplayEXT"));
+        if (getPlatformDisplay != nullptr) {
+            EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+            if (display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr)) {
+                return display;
+            }
+        }
+    }
+    EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr)) {
+        return display;
+    }
+    return EGL_NO_DISPLAY;
+}
+
+
+HeadlessContext::~HeadlessContext() {
+    destroy();
+}
+
+bool HeadlessContext::create(int major, int minor) {
+    destroy();
+    EGLDisplay display = openDisplay();
+    if (display == EGL_NO_DISPLAY) {
+        std::cerr << "(HeadlessContext) No EGL display available" << std::endl;
+        return false;
+    }
+    _display = display;
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        std::cerr << "(HeadlessContext) EGL implementation has no desktop OpenGL" << std::endl;
+        destroy();
+        return false;
+    }
+
+    bool surfaceless = hasExtension(eglQueryString(display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context");
+    const EGLint configAttributes[] = {
+        EGL_SURFACE_TYPE, surfaceless ? 0 : EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_NONE
+    };
+    EGLConfig config = nullptr;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0) {
+        std::cerr << "(HeadlessContext) No suitable EGL config" << std::endl;
+        destroy();
+        return false;
+    }
+
+    const EGLint contextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, major,
+        EGL_CONTEXT_MINOR_VERSION, minor,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    _context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+    if (_context == EGL_NO_CONTEXT) {
+        _context = nullptr;
+        std::cerr << "(HeadlessContext) Failed to create an OpenGL " << major << "." << minor
+                  << " core context (EGL error 0x" << std::hex << eglGetError() << std::dec << ")" << std::endl;
+        destroy();
+        return false;
+    }
+
+    if (!surfaceless) {
+        const EGLint pbufferAttributes[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+        _surface = eglCreatePbufferSurface(display, config, pbufferAttributes);
+        if (_surface == EGL_NO_SURFACE) {
+            _surface = nullptr;
+            std::cerr << "(HeadlessContext) Failed to create a pbuffer surface" << std::endl;
+            destroy();
+            return false;
+        }
+    }
+
+    const char* vendor = eglQueryString(display, EGL_VENDOR);
+    _description = std::string("EGL ") + eglQueryString(display, EGL_VERSION) + " (" + (vendor ? vendor : "unknown")
+                 + (surfaceless ? ", surfaceless)" : ", pbuffer)");
+    return true;
+}
+
+void HeadlessContext::destroy() {
+    if (_display == nullptr) {
+        return;
+    }
+    EGLDisplay display = static_cast<EGLDisplay>(_display);
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (_surface != nullptr) {
+        eglDestroySurface(display, static_cast<EGLSurface>(_surface));
+        _surface = nullptr;
+    }
+    if (_context != nullptr) {
+        eglDestroyContext(display, static_cast<EGLContext>(_context));
+        _context = nullptr;
+    }
+    eglTerminate(display);
+    _display = nullptr;
+}
+
+bool HeadlessContext::makeCurrent() {
+    if (!isValid()) {
+        return false;
+    }
+    EGLSurface surface = _surface != nullptr ? static_cast<EGLSurface>(_surface) : EGL_NO_SURFACE;
+    return eglMakeCurrent(static_cast<EGLDisplay>(_display), surface, surface, static_cast<EGLContext>(_context)) == EGL_TRUE;
+}
+
+void HeadlessContext::release() {
+    if (_display != nullptr) {
+        eglMakeCurrent(static_cast<EGLDisplay>(_display), EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    }
+}
+
+void* HeadlessContext::getProcAddress(const char* name) {
+    return reinterpret_cast<void*>(eglGetProcAddress(name));
+}
+
+#else // no EGL in this build
+
+HeadlessContext::~HeadlessContext() = default;
+
+bool HeadlessContext::create(int, int) {
+    std::cerr << "(HeadlessContext) Built without EGL support, headless rendering is unavailable" << std::endl;
+    return false;
+}
+
+void HeadlessContext::destroy() {}
+bool HeadlessContext::makeCurrent() { return false; }
+void HeadlessContext::release() {}
+void* HeadlessContext::getProcAddress(const char*) { return nullptr; }
+
+#endif // GRAPHISQUE_HAVE_EGL
@@ -0,0 +1,276 @@
+#include "InputRecording.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+
+static void putU16(std::vector<uint8_t>& out, uint16_t v) {
+    out.push_back(static_cast<uint8_t>(v));
+    out.push_back(static_cast<uint8_t>(v >> 8));
+}
+
+static void putU32(std::vector<uint8_t>& out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+}
+
+static void putU64(std::vector<uint8_t>& out, uint64_t v) {
+    for (int i = 0; i < 8; ++i) {
+        out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+}
+
+static void putF32(std::vector<uint8_t>& out, float v) {
+    uint32_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    putU32(out, bits);
+}
+
+static void putF64(std::vector<uint8_t>& out, double v) {
+    uint64_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    putU64(out, bits);
+}
+
+
+// Bounds checked little endian reads over the loaded file
+class RecordingReader {
+    private:
+        const std::vector<uint8_t>& _data;
+        size_t _pos = 0;
+
+    public:
+        explicit RecordingReader(const std::vector<uint8_t>& data) : _data(data) {}
+
+        bool atEnd() const { return _pos >= _data.size(); }
+        bool has(size_t bytes) const { return _data.size() - _pos >= bytes; }
+
+        uint64_t readUnsigned(int bytes) {
+            uint64_t v = 0;
+            for (int i = 0; i < bytes; ++i) {
+                v |= static_cast<uint64_t>(_data[_pos++]) << (8 * i);
+            }
+            return v;
+        }
+
+        float readF32() {
+            uint32_t bits = static_cast<uint32_t>(readUnsigned(4));
+            float v;
+            std::memcpy(&v, &bits, sizeof(v));
+            return v;
+        }
+
+        double readF64() {
+            uint64_t bits = readUnsigned(8);
+            double v;
+            std::memcpy(&v, &bits, sizeof(v));
+            return v;
+        }
+};
+
+static size_t payloadSize(InputEventType type) {
+    switch (type) {
+        case InputEventType::Key:             return 4;
+        case InputEventType::MouseButton:     return 3 + 16;
+        case InputEventType::CursorPos:       return 16;
+        case InputEventType::FramebufferSize: return 8;
+        case InputEventType::Command:         return 6;
+    }
+    return 0;
+}
+
+
+InputRecorder::~InputRecorder() {
+    end();
+}
+
+bool InputRecorder::begin(const std::string& path, int width, int height, double now) {
+    end();
+    _file = std::fopen(path.c_str(), "wb");
+    if (_file == nullptr) {
+        std::cerr << "(InputRecorder) Failed to open " << path << std::endl;
+        return false;
+    }
+    _path = path;
+    _startTime = now;
+    _lastMicros = 0;
+    _events = 0;
+
+    std::vector<uint8_t> header = {'G', 'Q', 'I', 'R'};
+    putU16(header, VERSION);
+    putU16(header, 0);
+    putU32(header, static_cast<uint32_t>(width));
+    putU32(header, static_cast<uint32_t>(height));
+    std::fwrite(header.data(), 1, header.size(), _file);
+    return true;
+}
+
+void InputRecorder::end() {
+    if (_file == nullptr) {
+        return;
+    }
+    std::fclose(_file);
+    _file = nullptr;
+    std::cout << "(InputRecorder) Wrote " << _events << " events to " << _path << std::endl;
+}
+
+void InputRecorder::record(const InputEvent& event, double now) {
+    if (_file == nullptr) {
+        return;
+    }
+    //deltas keep the records small; a gap longer than ~71 minutes is clamped
+    uint64_t micros = static_cast<uint64_t>(std::max(0.0, now - _startTime) * 1e6);
+    micros = std::max(micros, _lastMicros);
+    uint64_t delta = std::min<uint64_t>(micros - _lastMicros, UINT32_MAX);
+    _lastMicros += delta;
+
+    std::vector<uint8_t> out;
+    out.reserve(5 + payloadSize(event.type));
+    out.push_back(static_cast<uint8_t>(event.type));
+    putU32(out, static_cast<uint32_t>(delta));
+    switch (event.type) {
+        case InputEventType::Key:
+            putU16(out, static_cast<uint16_t>(event.code));
+            out.push_back(static_cast<uint8_t>(event.action));
+            out.push_back(static_cast<uint8_t>(event.mods));
+            break;
+        case InputEventType::MouseButton:
+            out.push_back(static_cast<uint8_t>(event.code));
+            out.push_back(static_cast<uint8_t>(event.action));
+            out.push_back(static_cast<uint8_t>(event.mods));
+            putF64(out, event.x);
+            putF64(out, event.y);
+            break;
+        case InputEventType::CursorPos:
+            putF64(out, event.x);
+            putF64(out, event.y);
+            break;
+        case InputEventType::FramebufferSize:
+            putU32(out, static_cast<uint32_t>(static_cast<int32_t>(event.x)));
+            putU32(out, static_cast<uint32_t>(static_cast<int32_t>(event.y)));
+            break;
+        case InputEventType::Command:
+            putU16(out, static_cast<uint16_t>(event.code));
+            putF32(out, event.value);
+            break;
+    }
+    std::fwrite(out.data(), 1, out.size(), _file);
+    ++_events;
+}
+
+
+bool InputReplay::load(const std::string& path) {
+    _events.clear();
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        std::cerr << "(InputReplay) Failed to open " << path << std::endl;
+        return false;
+    }
+    std::vector<uint8_t> data;
+    uint8_t buffer[64 * 1024];
+    size_t n;
+    while ((n = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        data.insert(data.end(), buffer, buffer + n);
+    }
+    std::fclose(file);
+
+    RecordingReader reader(data);
+    if (!reader.has(16) || std::memcmp(data.data(), "GQIR", 4) != 0) {
+        std::cerr << "(InputReplay) " << path << " is not an input recording" << std::endl;
+        return false;
+    }
+    reader.readUnsigned(4);
+    uint16_t version = static_cast<uint16_t>(reader.readUnsigned(2));
+    if (version != InputRecorder::VERSION) {
+        std::cerr << "(InputReplay) " << path << ": unsupported version " << version << std::endl;
+        return false;
+    }
+    reader.readUnsigned(2);
+    _width = static_cast<int32_t>(reader.readUnsigned(4));
+    _height = static_cast<int32_t>(reader.readUnsigned(4));
+
+    uint64_t micros = 0;
+    while (!reader.atEnd()) {
+        if (!reader.has(5)) {
+            break;
+        }
+        InputEvent event;
+        uint8_t type = static_cast<uint8_t>(reader.readUnsigned(1));
+        event.type = static_cast<InputEventType>(type);
+        micros += reader.readUnsigned(4);
+        event.time = static_cast<double>(micros) / 1e6;
+        size_t size = payloadSize(event.type);
+        if (size == 0) {
+            std::cerr << "(InputReplay) " << path << ": unknown event type " << int(type) << std::endl;
+            return false;
+        }
+        if (!reader.has(size)) {
+            break;
+        }
+        switch (event.type) {
+            case InputEventType::Key:
+                event.code = static_cast<int16_t>(reader.readUnsigned(2));
+                event.action = static_cast<int>(reader.readUnsigned(1));
+                event.mods = static_cast<int>(reader.readUnsigned(1));
+                break;
+            case InputEventType::MouseButton:
+                event.code = static_cast<int>(reader.readUnsigned(1));
+                event.action = static_cast<int>(reader.readUnsigned(1));
+                event.mods = static_cast<int>(reader.readUnsigned(1));
+                event.x = reader.readF64();
+                event.y = reader.readF64();
+                break;
+            case InputEventType::CursorPos:
+                event.x = reader.readF64();
+                event.y = reader.readF64();
+                break;
+            case InputEventType::FramebufferSize:
+                event.x = static_cast<int32_t>(reader.readUnsigned(4));
+                event.y = static_cast<int32_t>(reader.readUnsigned(4));
+                break;
+            case InputEventType::Command:
+                event.code = static_cast<int>(reader.readUnsigned(2));
+                event.value = reader.readF32();
+                break;
+        }
+        _events.push_back(event);
+    }
+    if (!reader.atEnd()) {
+        //a recording cut short by a crash is still usable up to the last whole event
+        std::cerr << "(InputReplay) " << path << " is truncated, using the first "
+                  << _events.size() << " events" << std::endl;
+    }
+    return true;
+}
+
+
+FrameTimeSummary FrameTimeSummary::from(std::vector<double> frameMs) {
+    FrameTimeSummary summary;
+    summary.frames = frameMs.size();
+    if (frameMs.empty()) {
+        return summary;
+    }
+    std::sort(frameMs.begin(), frameMs.end());
+    double total = 0.0;
+    for (double ms : frameMs) {
+        total += ms;
+    }
+    //nearest rank percentiles
+    auto percentile = [&frameMs](double p) {
+        size_t rank = static_cast<size_t>(std::ceil(p * static_cast<double>(frameMs.size())));
+        return frameMs[std::min(std::max<size_t>(rank, 1), frameMs.size()) - 1];
+    };
+    summary.meanMs = total / static_cast<double>(frameMs.size());
+    summary.p50Ms = percentile(0.50);
+    summary.p99Ms = percentile(0.99);
+    summary.maxMs = frameMs.back();
+    return summary;
+}
+
+void FrameTimeSummary::print(std::FILE* out) const {
+    std::fprintf(out, "frames %zu  mean %.3f ms  p50 %.3f ms  p99 %.3f ms  max %.3f ms\n",
+                 frames, meanMs, p50Ms, p99Ms, maxMs);
+}
@@ -0,0 +1,190 @@
+#include "JobSystem.h"
+#include "Logger.h"
+#include "MemoryArena.h"
+#include "Profiler.h"
+
+#include <algorithm>
+
+
+JobSystem::JobSystem(unsigned workerCount) {
+    if (workerCount == 0) {
+        unsigned hardware = std::thread::hardware_concurrency();
+        workerCount = hardware > 2 ? hardware - 2 : 1;
+    }
+    _workers.reserve(workerCount);
+    for (unsigned i = 0; i < workerCount; ++i) {
+        _workers.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    shutdown();
+}
+
+void JobSystem::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(_queueMutex);
+        if (_stopping) {
+            return;
+        }
+        _stopping = true;
+    }
+    _queueCv.notify_all();
+    for (auto& worker : _workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    _workers.clear();
+
+    //whatever never ran still finishes, so waiters return and dependents are released
+    std::vector<JobHandle> dropped;
+    {
+        std::lock_guard<std::mutex> lock(_queueMutex);
+        for (auto& queue : _queues) {
+            dropped.insert(dropped.end(), queue.begin(), queue.end());
+            queue.clear();
+        }
+    }
+    for (const auto& job : dropped) {
+        drop(job);
+    }
+}
+
+// Jobs (with their shared_ptr control block) come and go by the thousand during a rebuild.
+// Never destroyed: handles may outlive any JobSystem, and the pool has to outlive them.
+static PoolResource& jobPool() {
+    static PoolResource* pool = new PoolResource(sizeof(Job) + 64);
+    return *pool;
+}
+
+JobHandle JobSystem::createJob(std::function<void()> work, JobPriority priority, const CancellationToken& token) {
+    auto job = std::allocate_shared<Job>(std::pmr::polymorphic_allocator<Job>(&jobPool()));
+    job->work = std::move(work);
+    job->priority = priority;
+    job->token = token;
+    return job;
+}
+
+void JobSystem::addDependency(const JobHandle& job, const JobHandle& dependsOn) {
+    std::lock_guard<std::mutex> lock(dependsOn->mutex);
+    if (dependsOn->finished) {
+        return;
+    }
+    job->pending.fetch_add(1, std::memory_order_relaxed);
+    dependsOn->dependents.push_back(job);
+}
+
+void JobSystem::submit(const JobHandle& job) {
+    release(job);
+}
+
+JobHandle JobSystem::schedule(std::function<void()> work, JobPriority priority, const CancellationToken& token,
+                              const std::vector<JobHandle>& dependencies) {
+    JobHandle job = createJob(std::move(work), priority, token);
+    for (const auto& dependency : dependencies) {
+        addDependency(job, dependency);
+    }
+    submit(job);
+    return job;
+}
+
+JobHandle JobSystem::parallelFor(size_t count, size_t grain, std::function<void(size_t, size_t)> body,
+                                 JobPriority priority, const CancellationToken& token,
+                                 const std::vector<JobHandle>& dependencies) {
+    grain = std::max<size_t>(grain, 1);
+    auto sharedBody = std::make_shared<std::function<void(size_t, size_t)>>(std::move(body));
+    JobHandle join = createJob([] {}, priority, token);
+    for (size_t begin = 0; begin < count; begin += grain) {
+        size_t end = std::min(begin + grain, count);
+        JobHandle chunk = createJob([sharedBody, begin, end] { (*sharedBody)(begin, end); }, priority, token);
+        for (const auto& dependency : dependencies) {
+            addDependency(chunk, dependency);
+        }
+        addDependency(join, chunk);
+        submit(chunk);
+    }
+    submit(join);
+    return join;
+}
+
+void JobSystem::wait(const JobHandle& job) {
+    std::unique_lock<std::mutex> lock(job->mutex);
+    job->finishedCv.wait(lock, [&job] { return job->finished; });
+}
+
+void JobSystem::release(const JobHandle& job) {
+    if (job->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        enqueue(job);
+    }
+}
+
+void JobSystem::enqueue(const JobHandle& job) {
+    bool stopping;
+    {
+        std::lock_guard<std::mutex> lock(_queueMutex);
+        stopping = _stopping;
+        if (!stopping) {
+            _queues[static_cast<int>(job->priority)].push_back(job);
+        }
+    }
+    if (stopping) {
+        drop(job);
+        return;
+    }
+    _queueCv.notify_one();
+}
+
+void JobSystem::drop(const JobHandle& job) {
+    job->work = nullptr;
+    finish(job);
+}
+
+void JobSystem::finish(const JobHandle& job) {
+    std::vector<JobHandle> dependents;
+    {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        job->finished = true;
+        dependents.swap(job->dependents);
+    }
+    job->finishedCv.notify_all();
+    for (const auto& dependent : dependents) {
+        release(dependent);
+    }
+}
+
+void JobSystem::workerLoop(unsigned index) {
+    Profiler::instance().setThreadName("worker " + std::to_string(index));
+    for (;;) {
+        JobHandle job;
+        {
+            std::unique_lock<std::mutex> lock(_queueMutex);
+            _queueCv.wait(lock, [this] {
+                return _stopping || std::any_of(std::begin(_queues), std::end(_queues),
+                                                [](const std::deque<JobHandle>& queue) { return !queue.empty(); });
+            });
+            if (_stopping) {
+                return;
+            }
+            for (auto& queue : _queues) {
+                if (!queue.empty()) {
+                    job = std::move(queue.front());
+                    queue.pop_front();
+                    break;
+                }
+            }
+        }
+
+        if (!job->token.isCancelled()) {
+            try {
+                GRAPHISQUE_PROFILE_SCOPE("Job");
+                job->work();
+            } catch (const std::exception& e) {
+                GRAPHISQUE_LOG_ERROR("JobSystem", "Job failed: {}", e.what());
+            }
+        }
+        // release the closure (and whatever it captured) before waking dependents
+        job->work = nullptr;
+        finish(job);
+    }
+}
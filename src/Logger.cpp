@@ -0,0 +1,215 @@
+#include "Logger.h"
+
+#include <cctype>
+#include <chrono>
+
+
+static const uint64_t g_startNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count());
+
+
+Logger& Logger::instance() {
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger() {
+    _thread = std::thread(&Logger::drainLoop, this);
+}
+
+Logger::~Logger() {
+    {
+        std::lock_guard<std::mutex> lock(_wakeMutex);
+        _running.store(false, std::memory_order_release);
+    }
+    _wakeCv.notify_one();
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+uint64_t Logger::nowNs() {
+    using namespace std::chrono;
+    return static_cast<uint64_t>(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+}
+
+uint32_t Logger::threadId() {
+    static std::atomic<uint32_t> next{1};
+    static thread_local uint32_t id = next.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+void Logger::flush() {
+    uint64_t target = _queued.load(std::memory_order_acquire);
+    {
+        std::lock_guard<std::mutex> lock(_wakeMutex);
+        _wakeRequested = true;
+    }
+    _wakeCv.notify_one();
+    while (_written.load(std::memory_order_acquire) < target && _thread.joinable()) {
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+}
+
+void Logger::drainLoop() {
+    //poll every 2 ms while messages come in, backing off to 100 ms when nothing does, so an
+    //idle application doesn't wake up hundreds of times a second for its logger
+    const auto busyInterval = std::chrono::milliseconds(2);
+    const auto idleInterval = std::chrono::milliseconds(100);
+    auto interval = busyInterval;
+    while (_running.load(std::memory_order_acquire)) {
+        if (drain() > 0) {
+            interval = busyInterval;
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(_wakeMutex);
+        _wakeCv.wait_for(lock, interval, [this] {
+            return _wakeRequested || !_running.load(std::memory_order_acquire);
+        });
+        _wakeRequested = false;
+        interval = std::min(interval * 2, idleInterval);
+    }
+    drain();
+}
+
+size_t Logger::drain() {
+    size_t count = 0;
+    bool wroteErrors = false, wroteOutput = false;
+    LogRecord record;
+    char line[512];
+    while (_queue.tryPop(record)) {
+        size_t length = format(record, line, sizeof(line));
+        bool error = record.level >= LogLevel::Warning;
+        std::fwrite(line, 1, length, error ? stderr : stdout);
+        wroteErrors = wroteErrors || error;
+        wroteOutput = wroteOutput || !error;
+        ++count;
+    }
+    //one flush per batch instead of one per message
+    if (wroteOutput) {
+        std::fflush(stdout);
+    }
+    if (wroteErrors) {
+        std::fflush(stderr);
+    }
+    _written.fetch_add(count, std::memory_order_release);
+    return count;
+}
+
+
+// Appends one argument, printed with `spec` (the part of a printf conversion after the %,
+// without a length modifier) or a default conversion when the spec is empty
+static int formatArgument(const unsigned char*& cursor, const unsigned char* end, const char* spec, size_t specLength,
+                          char* out, size_t capacity) {
+    if (cursor >= end) {
+        return std::snprintf(out, capacity, "{?}");
+    }
+    char conversion[24] = "%";
+    size_t prefix = std::min(specLength, sizeof(conversion) - 5);
+    char type = prefix > 0 ? spec[prefix - 1] : '\0';
+    if (std::isdigit(static_cast<unsigned char>(type)) || type == '.') {
+        type = '\0'; // width/precision only, keep the default conversion
+        ++prefix;
+    }
+    if (prefix > 0) {
+        std::memcpy(conversion + 1, spec, prefix - 1); // flags, width, precision
+        conversion[prefix] = '\0';
+    }
+
+    LogRecord::ArgType argType = static_cast<LogRecord::ArgType>(*cursor++);
+    switch (argType) {
+        case LogRecord::Signed:
+        case LogRecord::Unsigned: {
+            uint64_t raw;
+            std::memcpy(&raw, cursor, sizeof(raw));
+            cursor += sizeof(raw);
+            if (type == 'f' || type == 'g' || type == 'e') {
+                const char suffix[2] = {type, '\0'};
+                std::strcat(conversion, suffix);
+                return std::snprintf(out, capacity, conversion, argType == LogRecord::Signed
+                                     ? static_cast<double>(static_cast<int64_t>(raw)) : static_cast<double>(raw));
+            }
+            std::strcat(conversion, "ll");
+            const char letter[2] = {(type == 'x' || type == 'X' || type == 'o') ? type : (argType == LogRecord::Signed ? 'd' : 'u'), '\0'};
+            std::strcat(conversion, letter);
+            if (argType == LogRecord::Signed) {
+                return std::snprintf(out, capacity, conversion, static_cast<long long>(static_cast<int64_t>(raw)));
+            }
+            return std::snprintf(out, capacity, conversion, static_cast<unsigned long long>(raw));
+        }
+        case LogRecord::Float: {
+            double value;
+            std::memcpy(&value, cursor, sizeof(value));
+            cursor += sizeof(value);
+            const char letter[2] = {(type == 'f' || type == 'e' || type == 'g') ? type : 'g', '\0'};
+            std::strcat(conversion, letter);
+            return std::snprintf(out, capacity, conversion, value);
+        }
+        case LogRecord::Char: {
+            char value = static_cast<char>(*cursor++);
+            std::strcat(conversion, "c");
+            return std::snprintf(out, capacity, conversion, value);
+        }
+        case LogRecord::String: {
+            int length = *cursor++;
+            const char* text = reinterpret_cast<const char*>(cursor);
+            cursor += length;
+            std::strcat(conversion, ".*s");
+            return std::snprintf(out, capacity, conversion, length, text);
+        }
+        case LogRecord::Pointer: {
+            const void* value;
+            std::memcpy(&value, cursor, sizeof(value));
+            cursor += sizeof(value);
+            return std::snprintf(out, capacity, "%p", value);
+        }
+    }
+    return 0;
+}
+
+size_t Logger::format(const LogRecord& record, char* out, size_t capacity) {
+    static const char LEVELS[] = {'T', 'D', 'I', 'W', 'E', '-'};
+    if (capacity < 2) {
+        return 0;
+    }
+    //leave room for the newline
+    const size_t limit = capacity - 1;
+    double seconds = record.timeNs > g_startNs ? static_cast<double>(record.timeNs - g_startNs) / 1e9 : 0.0;
+    int written = std::snprintf(out, limit, "%10.4f %c [%u] (%s) ", seconds, LEVELS[static_cast<int>(record.level)],
+                                record.threadId, record.tag != nullptr ? record.tag : "");
+    size_t length = written > 0 ? std::min(static_cast<size_t>(written), limit - 1) : 0;
+
+    const unsigned char* cursor = record.payload;
+    const unsigned char* end = record.payload + record.size;
+    for (const char* f = record.format; *f != '\0' && length + 1 < limit; ++f) {
+        if (f[0] == '{' && f[1] == '{') {
+            out[length++] = '{';
+            ++f;
+            continue;
+        }
+        if (f[0] == '}' && f[1] == '}') {
+            out[length++] = '}';
+            ++f;
+            continue;
+        }
+        const char* close = f[0] == '{' ? std::strchr(f, '}') : nullptr;
+        if (close == nullptr) {
+            out[length++] = *f;
+            continue;
+        }
+        const char* spec = f[1] == ':' ? f + 2 : close;
+        int n = formatArgument(cursor, end, spec, static_cast<size_t>(close - spec), out + length, limit - length);
+        if (n > 0) {
+            length = std::min(length + static_cast<size_t>(n), limit - 1);
+        }
+        f = close;
+    }
+    if (record.truncated) {
+        static const char MARKER[] = " [truncated]";
+        size_t n = std::min(sizeof(MARKER) - 1, limit - 1 - length);
+        std::memcpy(out + length, MARKER, n);
+        length += n;
+    }
+    out[length++] = '\n';
+    return length;
+}
@@ -0,0 +1,155 @@
+#include "MemoryArena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+
+static constexpr size_t CHUNK_ALIGNMENT = alignof(std::max_align_t);
+
+
+ArenaResource::ArenaResource(size_t initialBytes, std::pmr::memory_resource* upstream)
+    : _initialBytes(std::max<size_t>(initialBytes, 256)), _upstream(upstream) {
+}
+
+ArenaResource::~ArenaResource() {
+    for (const Chunk& chunk : _chunks) {
+        _upstream->deallocate(chunk.data, chunk.size, CHUNK_ALIGNMENT);
+    }
+}
+
+ArenaResource::Chunk ArenaResource::allocateChunk(size_t size) {
+    return {static_cast<std::byte*>(_upstream->allocate(size, CHUNK_ALIGNMENT)), size};
+}
+
+void* ArenaResource::do_allocate(size_t bytes, size_t alignment) {
+    for (;;) {
+        if (_current < _chunks.size()) {
+            const Chunk& chunk = _chunks[_current];
+            uintptr_t base = reinterpret_cast<uintptr_t>(chunk.data);
+            size_t aligned = static_cast<size_t>(((base + _offset + alignment - 1) & ~(uintptr_t(alignment) - 1)) - base);
+            if (aligned <= chunk.size && bytes <= chunk.size - aligned) {
+                _offset = aligned + bytes;
+                _peak = std::max(_peak, bytesUsed());
+                return chunk.data + aligned;
+            }
+            if (_current + 1 < _chunks.size()) {
+                //a chunk kept from before a rewind; the tail of this one stays unused until then
+                ++_current;
+                _offset = 0;
+                continue;
+            }
+        }
+        size_t size = _chunks.empty() ? _initialBytes : _chunks.back().size * 2;
+        _chunks.push_back(allocateChunk(std::max(size, bytes + alignment)));
+        _current = _chunks.size() - 1;
+        _offset = 0;
+    }
+}
+
+void ArenaResource::rewind(const Marker& marker) {
+    _current = marker.chunk;
+    _offset = marker.offset;
+}
+
+void ArenaResource::reset() {
+    if (_chunks.size() > 1) {
+        //the last round needed more than one chunk; next time it fits in one
+        size_t total = capacity();
+        for (const Chunk& chunk : _chunks) {
+            _upstream->deallocate(chunk.data, chunk.size, CHUNK_ALIGNMENT);
+        }
+        _chunks.clear();
+        _chunks.push_back(allocateChunk(total));
+    }
+    _current = 0;
+    _offset = 0;
+}
+
+size_t ArenaResource::bytesUsed() const {
+    size_t used = _offset;
+    for (size_t i = 0; i < _current && i < _chunks.size(); ++i) {
+        used += _chunks[i].size;
+    }
+    return used;
+}
+
+size_t ArenaResource::capacity() const {
+    size_t total = 0;
+    for (const Chunk& chunk : _chunks) {
+        total += chunk.size;
+    }
+    return total;
+}
+
+ArenaResource& ArenaResource::frame() {
+    static ArenaResource arena(256 * 1024);
+    return arena;
+}
+
+ArenaResource& ArenaResource::scratch() {
+    thread_local ArenaResource arena;
+    return arena;
+}
+
+
+PoolResource::PoolResource(size_t blockSize, size_t blocksPerChunk, std::pmr::memory_resource* upstream)
+    : _blockSize((std::max(blockSize, sizeof(FreeBlock)) + CHUNK_ALIGNMENT - 1) / CHUNK_ALIGNMENT * CHUNK_ALIGNMENT),
+      _blocksPerChunk(std::max<size_t>(blocksPerChunk, 1)), _upstream(upstream) {
+}
+
+PoolResource::~PoolResource() {
+    for (std::byte* chunk : _chunks) {
+        _upstream->deallocate(chunk, _blockSize * _blocksPerChunk, CHUNK_ALIGNMENT);
+    }
+}
+
+void* PoolResource::do_allocate(size_t bytes, size_t alignment) {
+    if (bytes > _blockSize || alignment > CHUNK_ALIGNMENT) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            ++_oversized;
+        }
+        return _upstream->allocate(bytes, alignment);
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_free == nullptr) {
+        std::byte* chunk = static_cast<std::byte*>(_upstream->allocate(_blockSize * _blocksPerChunk, CHUNK_ALIGNMENT));
+        _chunks.push_back(chunk);
+        for (size_t i = _blocksPerChunk; i-- > 0;) {
+            FreeBlock* block = reinterpret_cast<FreeBlock*>(chunk + i * _blockSize);
+            block->next = _free;
+            _free = block;
+        }
+    }
+    FreeBlock* block = _free;
+    _free = block->next;
+    ++_inUse;
+    return block;
+}
+
+void PoolResource::do_deallocate(void* p, size_t bytes, size_t alignment) {
+    if (bytes > _blockSize || alignment > CHUNK_ALIGNMENT) {
+        _upstream->deallocate(p, bytes, alignment);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    FreeBlock* block = static_cast<FreeBlock*>(p);
+    block->next = _free;
+    _free = block;
+    --_inUse;
+}
+
+size_t PoolResource::blocksInUse() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _inUse;
+}
+
+size_t PoolResource::blocksAllocated() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _chunks.size() * _blocksPerChunk;
+}
+
+size_t PoolResource::oversizedRequests() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _oversized;
+}
@@ -0,0 +1,194 @@
+#include "PngWriter.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+
+static const uint32_t* crcTable() {
+    static uint32_t table[256];
+    static bool initialized = [] {
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[n] = c;
+        }
+        return true;
+    }();
+    (void)initialized;
+    return table;
+}
+
+static void storeU32(uint8_t* out, uint32_t value) {
+    out[0] = static_cast<uint8_t>(value >> 24);
+    out[1] = static_cast<uint8_t>(value >> 16);
+    out[2] = static_cast<uint8_t>(value >> 8);
+    out[3] = static_cast<uint8_t>(value);
+}
+
+
+uint32_t PngWriter::crc32(const uint8_t* data, size_t size, uint32_t crc) {
+    const uint32_t* table = crcTable();
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+void PngWriter::encode(int width, int height, const uint8_t* rgba, bool flipVertically, std::vector<uint8_t>& out) {
+    out.clear();
+    PngStreamWriter writer;
+    auto sink = [&out](const uint8_t* data, size_t size) {
+        out.insert(out.end(), data, data + size);
+        return true;
+    };
+    const size_t rowBytes = static_cast<size_t>(width) * 4;
+    writer.begin(sink, width, height);
+    for (int row = 0; row < height; ++row) {
+        int source = flipVertically ? height - 1 - row : row;
+        writer.writeRow(rgba + static_cast<size_t>(source) * rowBytes);
+    }
+    writer.finish();
+}
+
+bool PngWriter::write(const std::string& path, int width, int height, const uint8_t* rgba, bool flipVertically) {
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        std::cerr << "(PngWriter) Cannot open " << path << std::endl;
+        return false;
+    }
+    PngStreamWriter writer;
+    auto sink = [file](const uint8_t* data, size_t size) {
+        return std::fwrite(data, 1, size, file) == size;
+    };
+    const size_t rowBytes = static_cast<size_t>(width) * 4;
+    bool ok = writer.begin(sink, width, height);
+    for (int row = 0; ok && row < height; ++row) {
+        int source = flipVertically ? height - 1 - row : row;
+        ok = writer.writeRow(rgba + static_cast<size_t>(source) * rowBytes);
+    }
+    ok = ok && writer.finish();
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok) {
+        std::cerr << "(PngWriter) Failed to write " << path << std::endl;
+    }
+    return ok;
+}
+
+
+bool PngStreamWriter::begin(Sink sink, int width, int height) {
+    _sink = std::move(sink);
+    _width = width;
+    _height = height;
+    _rowsWritten = 0;
+    _ok = width > 0 && height > 0;
+    if (!_ok) {
+        return false;
+    }
+    _rawRemaining = (static_cast<uint64_t>(width) * 4 + 1) * static_cast<uint64_t>(height); // filter byte per row
+    _blockRemaining = 0;
+    _adlerA = 1;
+    _adlerB = 0;
+    _chunk.clear();
+    _chunk.reserve(CHUNK_BYTES + 5);
+
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    _ok = _sink(signature, 8);
+
+    // IHDR: 8 bit RGBA, no interlacing
+    uint8_t header[13];
+    storeU32(header, static_cast<uint32_t>(width));
+    storeU32(header + 4, static_cast<uint32_t>(height));
+    header[8] = 8;
+    header[9] = 6;
+    header[10] = header[11] = header[12] = 0;
+    _ok = _ok && writeChunk("IHDR", header, sizeof(header));
+
+    _chunk.push_back(0x78); // deflate, 32K window
+    _chunk.push_back(0x01); // no preset dictionary, fastest level; 0x7801 is a multiple of 31
+    return _ok;
+}
+
+bool PngStreamWriter::writeRow(const uint8_t* rgba) {
+    if (!_ok || _rowsWritten >= _height) {
+        return false;
+    }
+    const uint8_t filter = 0;
+    putData(&filter, 1);
+    putData(rgba, static_cast<size_t>(_width) * 4);
+    ++_rowsWritten;
+    return _ok;
+}
+
+bool PngStreamWriter::finish() {
+    if (!_ok || _rowsWritten != _height) {
+        _ok = false;
+        return false;
+    }
+    uint8_t adler[4];
+    storeU32(adler, (_adlerB << 16) | _adlerA);
+    _chunk.insert(_chunk.end(), adler, adler + 4);
+    _ok = flushChunk() && writeChunk("IEND", nullptr, 0);
+    return _ok;
+}
+
+void PngStreamWriter::putData(const uint8_t* data, size_t size) {
+    while (size > 0 && _ok) {
+        if (_blockRemaining == 0) {
+            // stored block header: BFINAL, BTYPE = 00, LEN, NLEN
+            size_t length = _rawRemaining < 65535 ? static_cast<size_t>(_rawRemaining) : 65535;
+            _chunk.push_back(length == _rawRemaining ? 1 : 0);
+            _chunk.push_back(static_cast<uint8_t>(length));
+            _chunk.push_back(static_cast<uint8_t>(length >> 8));
+            _chunk.push_back(static_cast<uint8_t>(~length));
+            _chunk.push_back(static_cast<uint8_t>(~length >> 8));
+            _blockRemaining = length;
+        }
+        size_t take = size < _blockRemaining ? size : _blockRemaining;
+        _chunk.insert(_chunk.end(), data, data + take);
+        for (size_t i = 0; i < take; ++i) {
+            _adlerA += data[i];
+            _adlerB += _adlerA;
+            // reducing every 4096 bytes keeps both sums below 2^32 (zlib's bound is 5552)
+            if ((i & 4095) == 4095) {
+                _adlerA %= 65521;
+                _adlerB %= 65521;
+            }
+        }
+        _adlerA %= 65521;
+        _adlerB %= 65521;
+
+        data += take;
+        size -= take;
+        _blockRemaining -= take;
+        _rawRemaining -= take;
+        if (_chunk.size() >= CHUNK_BYTES) {
+            _ok = flushChunk();
+        }
+    }
+}
+
+bool PngStreamWriter::flushChunk() {
+    if (_chunk.empty()) {
+        return true;
+    }
+    bool ok = writeChunk("IDAT", _chunk.data(), _chunk.size());
+    _chunk.clear();
+    return ok;
+}
+
+bool PngStreamWriter::writeChunk(const char type[4], const uint8_t* data, size_t size) {
+    uint8_t prefix[8];
+    storeU32(prefix, static_cast<uint32_t>(size));
+    std::memcpy(prefix + 4, type, 4);
+    uint32_t crc = PngWriter::crc32(prefix + 4, 4);
+    if (size > 0) {
+        crc = PngWriter::crc32(data, size, crc);
+    }
+    uint8_t suffix[4];
+    storeU32(suffix, crc);
+    return _sink(prefix, 8) && (size == 0 || _sink(data, size)) && _sink(suffix, 4);
+}
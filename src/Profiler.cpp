@@ -0,0 +1,187 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+
+// Writes `text` as the inside of a JSON string; scope and thread names are free text
+static void writeJsonString(std::ostream& out, const char* text) {
+    static const char HEX[] = "0123456789abcdef";
+    for (const char* c = text != nullptr ? text : ""; *c != '\0'; ++c) {
+        unsigned char byte = static_cast<unsigned char>(*c);
+        switch (byte) {
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\r': out << "\\r"; break;
+            case '\t': out << "\\t"; break;
+            default:
+                if (byte < 0x20) {
+                    out << "\\u00" << HEX[byte >> 4] << HEX[byte & 0xF];
+                } else {
+                    out << *c;
+                }
+        }
+    }
+}
+
+
+// Single producer (the owning thread) / single consumer (collect()) ring
+struct Profiler::ThreadBuffer {
+    static constexpr size_t CAPACITY = 1 << 14;
+
+    uint32_t id = 0;
+    std::string name;
+    std::unique_ptr<ProfileEvent[]> events{new ProfileEvent[CAPACITY]};
+    alignas(64) std::atomic<size_t> head{0}; // written by the producer
+    alignas(64) std::atomic<size_t> tail{0}; // written by the consumer
+};
+
+
+Profiler& Profiler::instance() {
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::Profiler() {
+}
+
+uint64_t Profiler::nowNs() {
+    using namespace std::chrono;
+    return static_cast<uint64_t>(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+}
+
+uint16_t& Profiler::threadDepth() {
+    static thread_local uint16_t depth = 0;
+    return depth;
+}
+
+const char*& Profiler::threadScope() {
+    static thread_local const char* scope = nullptr;
+    return scope;
+}
+
+Profiler::ThreadBuffer& Profiler::threadBuffer() {
+    static thread_local ThreadBuffer* buffer = nullptr;
+    if (buffer == nullptr) {
+        auto created = std::make_shared<ThreadBuffer>();
+        std::lock_guard<std::mutex> lock(_registryMutex);
+        created->id = static_cast<uint32_t>(_buffers.size() + 1);
+        created->name = "thread " + std::to_string(created->id);
+        _buffers.push_back(created);
+        buffer = created.get(); // the registry keeps it alive past thread exit so collect() can drain it
+    }
+    return *buffer;
+}
+
+void Profiler::setThreadName(const std::string& name) {
+    ThreadBuffer& buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(_registryMutex);
+    buffer.name = name;
+}
+
+std::vector<Profiler::ThreadInfo> Profiler::threads() const {
+    std::lock_guard<std::mutex> lock(_registryMutex);
+    std::vector<ThreadInfo> infos;
+    infos.reserve(_buffers.size());
+    for (const auto& buffer : _buffers) {
+        infos.push_back({buffer->id, buffer->name});
+    }
+    return infos;
+}
+
+void Profiler::record(const char* name, uint64_t startNs, uint64_t endNs, uint16_t depth, bool gpu) {
+    ThreadBuffer& buffer = threadBuffer();
+    size_t head = buffer.head.load(std::memory_order_relaxed);
+    if (head - buffer.tail.load(std::memory_order_acquire) >= ThreadBuffer::CAPACITY) {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    ProfileEvent& event = buffer.events[head & (ThreadBuffer::CAPACITY - 1)];
+    event.name = name;
+    event.startNs = startNs;
+    event.endNs = endNs;
+    event.threadId = gpu ? GPU_THREAD_ID : buffer.id;
+    event.depth = depth;
+    event.gpu = gpu;
+    buffer.head.store(head + 1, std::memory_order_release);
+}
+
+void Profiler::collect() {
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(_registryMutex);
+        buffers = _buffers;
+    }
+
+    const size_t previousSize = _history.size();
+    for (const auto& buffer : buffers) {
+        size_t tail = buffer->tail.load(std::memory_order_relaxed);
+        size_t head = buffer->head.load(std::memory_order_acquire);
+        for (; tail != head; ++tail) {
+            const ProfileEvent& event = buffer->events[tail & (ThreadBuffer::CAPACITY - 1)];
+            _history.push_back(event);
+            if (_capturing) {
+                _capture.push_back(event);
+            }
+        }
+        buffer->tail.store(tail, std::memory_order_release);
+    }
+
+    // Only the new events need sorting; merging keeps the whole history ordered for the timeline
+    auto byStart = [](const ProfileEvent& a, const ProfileEvent& b) { return a.startNs < b.startNs; };
+    auto middle = _history.begin() + static_cast<std::ptrdiff_t>(previousSize);
+    std::sort(middle, _history.end(), byStart);
+    std::inplace_merge(_history.begin(), middle, _history.end(), byStart);
+
+    uint64_t now = nowNs();
+    uint64_t cutoff = now > _historyNs ? now - _historyNs : 0;
+    while (!_history.empty() && _history.front().endNs < cutoff) {
+        _history.pop_front();
+    }
+}
+
+void Profiler::beginCapture() {
+    _capture.clear();
+    _capturing = true;
+}
+
+bool Profiler::endCapture(const std::string& path) {
+    _capturing = false;
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "(Profiler) Could not write trace to " << path << std::endl;
+        return false;
+    }
+
+    uint64_t origin = _capture.empty() ? 0 : _capture.front().startNs;
+    for (const auto& event : _capture) {
+        origin = std::min(origin, event.startNs);
+    }
+
+    out << "{\"traceEvents\":[\n";
+    bool first = true;
+    for (const auto& thread : threads()) {
+        out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread.id
+            << ",\"args\":{\"name\":\"";
+        writeJsonString(out, thread.name.c_str());
+        out << "\"}}";
+        first = false;
+    }
+    out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << GPU_THREAD_ID
+        << ",\"args\":{\"name\":\"GPU\"}}";
+    for (const auto& event : _capture) {
+        out << ",\n{\"name\":\"";
+        writeJsonString(out, event.name);
+        out << "\",\"cat\":\"" << (event.gpu ? "gpu" : "cpu")
+            << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.threadId
+            << ",\"ts\":" << static_cast<double>(event.startNs - origin) / 1000.0
+            << ",\"dur\":" << static_cast<double>(event.endNs - event.startNs) / 1000.0 << "}";
+    }
+    out << "\n]}\n";
+    std::cout << "(Profiler) Wrote " << _capture.size() << " events to " << path << std::endl;
+    _capture.clear();
+    return true;
+}
@@ -0,0 +1,124 @@
+#include "ProfilerOverlay.h"
+
+#include "imgui/imgui.h"
+#include "Profiler.h"
+#include "GpuProfiler.h"
+#include <algorithm>
+#include <cstring>
+
+
+// Stable colour per scope name so the same scope looks the same in every frame
+static ImU32 scopeColor(const char* name, bool gpu) {
+    uint32_t hash = 2166136261u;
+    for (const char* c = name; *c; ++c) {
+        hash = (hash ^ static_cast<uint8_t>(*c)) * 16777619u;
+    }
+    float hue = static_cast<float>(hash % 360) / 360.0f;
+    float r, g, b;
+    ImGui::ColorConvertHSVtoRGB(hue, gpu ? 0.45f : 0.6f, gpu ? 0.7f : 0.85f, r, g, b);
+    return IM_COL32(static_cast<int>(r * 255), static_cast<int>(g * 255), static_cast<int>(b * 255), 255);
+}
+
+
+void ProfilerOverlay::draw() {
+    if (!_visible) {
+        return;
+    }
+    const Profiler& profiler = Profiler::instance();
+
+    // Frame times come from the render thread's "Frame" scopes
+    _frameTimes.clear();
+    for (const ProfileEvent& event : profiler.history()) {
+        if (!event.gpu && std::strcmp(event.name, "Frame") == 0) {
+            _frameTimes.push_back(static_cast<float>(event.endNs - event.startNs) / 1e6f);
+        }
+    }
+
+    ImGui::SetNextWindowSize(ImVec2(720, 360), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Profiler", &_visible)) {
+        ImGui::End();
+        return;
+    }
+
+    float average = 0.0f, worst = 0.0f;
+    for (float ms : _frameTimes) {
+        average += ms;
+        worst = std::max(worst, ms);
+    }
+    average = _frameTimes.empty() ? 0.0f : average / static_cast<float>(_frameTimes.size());
+    ImGui::Text("CPU frame: %.2f ms avg, %.2f ms max | GPU frame: %.2f ms | dropped events: %llu",
+                average, worst, GpuProfiler::instance().lastFrameGpuMs(),
+                static_cast<unsigned long long>(profiler.droppedEvents()));
+    if (!_frameTimes.empty()) {
+        ImGui::PlotLines("##frametimes", _frameTimes.data(), static_cast<int>(_frameTimes.size()), 0,
+                         "frame ms", 0.0f, std::max(33.3f, worst), ImVec2(-1, 60));
+    }
+
+    ImGui::SliderFloat("window (ms)", &_timelineMs, 5.0f, 500.0f, "%.0f", ImGuiSliderFlags_Logarithmic);
+    ImGui::SameLine();
+    Profiler& mutableProfiler = Profiler::instance();
+    if (!mutableProfiler.isCapturing()) {
+        if (ImGui::Button("Start trace capture")) {
+            mutableProfiler.beginCapture();
+        }
+    } else if (ImGui::Button("Stop and save trace")) {
+        mutableProfiler.endCapture("graphisque_trace_" + std::to_string(_captureCount++) + ".json");
+    }
+
+    drawTimeline();
+    ImGui::End();
+}
+
+void ProfilerOverlay::drawTimeline() {
+    const Profiler& profiler = Profiler::instance();
+    std::vector<Profiler::ThreadInfo> threads = profiler.threads();
+    threads.push_back({Profiler::GPU_THREAD_ID, "GPU"});
+
+    const float rowHeight = 18.0f;
+    const float rowGap = 6.0f;
+    const int maxDepth = 6;
+    const float labelWidth = 90.0f;
+
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    ImVec2 origin = ImGui::GetCursorScreenPos();
+    float width = std::max(ImGui::GetContentRegionAvail().x - labelWidth, 50.0f);
+    float left = origin.x + labelWidth;
+
+    uint64_t end = Profiler::nowNs();
+    uint64_t span = static_cast<uint64_t>(_timelineMs * 1e6f);
+    uint64_t start = end > span ? end - span : 0;
+    auto toX = [&](uint64_t ns) {
+        double t = static_cast<double>(std::min(std::max(ns, start), end) - start) / static_cast<double>(span);
+        return left + static_cast<float>(t) * width;
+    };
+
+    float y = origin.y;
+    for (const auto& thread : threads) {
+        int rowDepth = 1;
+        for (const ProfileEvent& event : profiler.history()) {
+            if (event.threadId == thread.id && event.endNs >= start) {
+                rowDepth = std::max(rowDepth, std::min<int>(event.depth + 1, maxDepth));
+            }
+        }
+        drawList->AddText(ImVec2(origin.x, y), IM_COL32(200, 200, 200, 255), thread.name.c_str());
+
+        for (const ProfileEvent& event : profiler.history()) {
+            if (event.threadId != thread.id || event.endNs < start || event.startNs > end || event.depth >= maxDepth) {
+                continue;
+            }
+            ImVec2 a(toX(event.startNs), y + event.depth * rowHeight);
+            ImVec2 b(std::max(toX(event.endNs), a.x + 1.0f), a.y + rowHeight - 1.0f);
+            drawList->AddRectFilled(a, b, scopeColor(event.name, event.gpu));
+            if (b.x - a.x > 40.0f) {
+                drawList->PushClipRect(a, b, true);
+                drawList->AddText(ImVec2(a.x + 2.0f, a.y + 1.0f), IM_COL32(0, 0, 0, 255), event.name);
+                drawList->PopClipRect();
+            }
+            if (ImGui::IsMouseHoveringRect(a, b)) {
+                ImGui::SetTooltip("%s\n%.3f ms", event.name, static_cast<double>(event.endNs - event.startNs) / 1e6);
+            }
+        }
+        y += rowDepth * rowHeight + rowGap;
+    }
+    ImGui::Dummy(ImVec2(labelWidth + width, y - origin.y));
+}
@@ -0,0 +1,228 @@
+#include "ProgramCache.h"
+#include "Logger.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+#ifdef _WIN32
+    #include <process.h>
+    #define GRAPHISQUE_GETPID _getpid
+#else
+    #include <unistd.h>
+    #define GRAPHISQUE_GETPID getpid
+#endif
+
+
+// Not in our GL 4.0 glad header
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+    #define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+    #define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+    #define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+static const uint16_t CACHE_VERSION = 1;
+static const int MAX_DRAINED_ERRORS = 8;
+
+// Written in native byte order; the binaries only ever load on the machine that made them
+struct CacheHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t reserved;
+    uint64_t key;
+    uint32_t format;
+    uint32_t length;
+};
+
+
+static uint64_t fnv1a(uint64_t hash, const std::string& text) {
+    for (char c : text) {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 1099511628211ull;
+    }
+    //length as a separator, so ("ab", "c") and ("a", "bc") differ
+    return (hash ^ text.size()) * 1099511628211ull;
+}
+
+static std::string glString(GLenum name) {
+    const GLubyte* value = glGetString(name);
+    return value != nullptr ? std::string(reinterpret_cast<const char*>(value)) : std::string();
+}
+
+
+ProgramCache& ProgramCache::instance() {
+    static ProgramCache cache;
+    return cache;
+}
+
+void ProgramCache::loadFunctions(GLADloadproc loader) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _getProgramBinary = reinterpret_cast<GetProgramBinaryProc>(loader("glGetProgramBinary"));
+    _programBinary = reinterpret_cast<ProgramBinaryProc>(loader("glProgramBinary"));
+    _programParameteri = reinterpret_cast<ProgramParameteriProc>(loader("glProgramParameteri"));
+    GLint formats = 0;
+    if (_getProgramBinary != nullptr && _programBinary != nullptr) {
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        glGetError(); // GL_INVALID_ENUM before 4.1 without the extension
+    }
+    _available = formats > 0;
+    _driver = glString(GL_VENDOR) + '\n' + glString(GL_RENDERER) + '\n' + glString(GL_VERSION);
+    if (!_available) {
+        GRAPHISQUE_LOG_INFO("ProgramCache", "Program binaries unsupported by the driver, shaders compile every launch");
+    }
+}
+
+bool ProgramCache::isAvailable() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _available && !_directory.empty();
+}
+
+void ProgramCache::setDirectory(const std::string& directory) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _directory = directory;
+}
+
+uint64_t ProgramCache::makeKey(const std::string& vertexSource, const std::string& fragmentSource,
+                               const std::string& defines) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    uint64_t hash = 14695981039346656037ull;
+    hash = fnv1a(hash, _driver);
+    hash = fnv1a(hash, defines);
+    hash = fnv1a(hash, vertexSource);
+    hash = fnv1a(hash, fragmentSource);
+    return hash;
+}
+
+std::string ProgramCache::pathFor(uint64_t key) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "/%016llx.bin", static_cast<unsigned long long>(key));
+    return _directory + name;
+}
+
+GLuint ProgramCache::load(uint64_t key) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_available || _directory.empty()) {
+        return 0;
+    }
+    std::string path = pathFor(key);
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        ++_stats.misses;
+        return 0;
+    }
+    CacheHeader header;
+    std::vector<char> binary;
+    bool valid = std::fread(&header, sizeof(header), 1, file) == 1 && std::memcmp(header.magic, "GQPB", 4) == 0 &&
+                 header.version == CACHE_VERSION && header.key == key && header.length > 0;
+    if (valid) {
+        //the length comes from disk; a file cut short or padded is rejected before allocating for it
+        std::error_code error;
+        std::uintmax_t fileSize = std::filesystem::file_size(path, error);
+        valid = !error && fileSize >= sizeof(header) && fileSize - sizeof(header) == header.length;
+    }
+    if (valid) {
+        binary.resize(header.length);
+        valid = std::fread(binary.data(), 1, binary.size(), file) == binary.size();
+    }
+    std::fclose(file);
+
+    GLuint program = 0;
+    if (valid) {
+        program = glCreateProgram();
+        _programBinary(program, header.format, binary.data(), static_cast<GLsizei>(binary.size()));
+        //a format the driver dropped is GL_INVALID_ENUM; a rejected binary is a miss, not an error
+        //the next checked GL call should trip over. GL keeps one flag per error kind, so a few
+        //reads clear them all; a context that keeps reporting errors (lost) isn't spun on.
+        for (int i = 0; i < MAX_DRAINED_ERRORS; ++i) {
+            GLenum error = glGetError();
+            if (error == GL_NO_ERROR) {
+                break;
+            }
+            GRAPHISQUE_LOG_WARN("ProgramCache", "glProgramBinary for {} raised GL error {:#x}", path, error);
+        }
+        GLint linked = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (linked != GL_TRUE) {
+            glDeleteProgram(program);
+            program = 0;
+        }
+    }
+    if (program == 0) {
+        //stale after a driver change that kept the version string, or truncated; rebuild it
+        GRAPHISQUE_LOG_WARN("ProgramCache", "Rejected cached program {}, compiling from source", path);
+        std::error_code error;
+        std::filesystem::remove(path, error);
+        ++_stats.rejected;
+        ++_stats.misses;
+        return 0;
+    }
+    ++_stats.hits;
+    return program;
+}
+
+void ProgramCache::prepare(GLuint program) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_available && _programParameteri != nullptr) {
+        _programParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+}
+
+bool ProgramCache::store(uint64_t key, GLuint program) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_available || _directory.empty()) {
+        return false;
+    }
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return false;
+    }
+    std::vector<char> binary(static_cast<size_t>(length));
+    GLenum format = 0;
+    GLsizei written = 0;
+    _getProgramBinary(program, length, &written, &format, binary.data());
+    if (written <= 0) {
+        return false;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(_directory, error);
+    //write next to it and rename, so a concurrent launch never reads half a file; the
+    //temporary is per process so two launches storing the same program don't share one
+    std::string path = pathFor(key);
+    std::string temporary = path + "." + std::to_string(static_cast<long>(GRAPHISQUE_GETPID())) + ".tmp";
+    std::FILE* file = std::fopen(temporary.c_str(), "wb");
+    if (file == nullptr) {
+        GRAPHISQUE_LOG_WARN("ProgramCache", "Failed to write {}", temporary);
+        return false;
+    }
+    CacheHeader header;
+    std::memcpy(header.magic, "GQPB", 4);
+    header.version = CACHE_VERSION;
+    header.reserved = 0;
+    header.key = key;
+    header.format = format;
+    header.length = static_cast<uint32_t>(written);
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              std::fwrite(binary.data(), 1, static_cast<size_t>(written), file) == static_cast<size_t>(written);
+    ok = std::fclose(file) == 0 && ok;
+    if (ok) {
+        std::filesystem::rename(temporary, path, error);
+        ok = !error;
+    }
+    if (!ok) {
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+    ++_stats.stored;
+    return true;
+}
+
+ProgramCache::Stats ProgramCache::stats() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+}
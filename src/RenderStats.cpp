@@ -0,0 +1,150 @@
+#include "RenderStats.h"
+#include "AllocationTracker.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+
+RenderStats& RenderStats::instance() {
+    static RenderStats stats;
+    return stats;
+}
+
+void RenderStats::countDraw(GLenum mode, GLsizei count) {
+    add(Counter::DrawCalls);
+    if (count <= 0) {
+        return;
+    }
+    uint64_t n = static_cast<uint64_t>(count);
+    switch (mode) {
+        case GL_TRIANGLES:      add(Counter::Triangles, n / 3); break;
+        case GL_TRIANGLE_STRIP:
+        case GL_TRIANGLE_FAN:   add(Counter::Triangles, n > 2 ? n - 2 : 0); break;
+        case GL_LINES:          add(Counter::Lines, n / 2); break;
+        case GL_LINE_STRIP:     add(Counter::Lines, n > 1 ? n - 1 : 0); break;
+        case GL_LINE_LOOP:      add(Counter::Lines, n); break;
+        case GL_POINTS:         add(Counter::Points, n); break;
+        default: break;
+    }
+}
+
+void RenderStats::endFrame(uint64_t frameIndex) {
+    uint64_t now = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+
+    RenderFrameStats frame;
+    frame.frameIndex = frameIndex;
+    frame.timeMs = _lastFrameNs == 0 ? 0.0 : static_cast<double>(now - _lastFrameNs) / 1e6;
+    _lastFrameNs = now;
+
+    auto take = [this](Counter counter) {
+        return _counters[static_cast<size_t>(counter)].exchange(0, std::memory_order_relaxed);
+    };
+    frame.drawCalls = take(Counter::DrawCalls);
+    frame.triangles = take(Counter::Triangles);
+    frame.lines = take(Counter::Lines);
+    frame.points = take(Counter::Points);
+    frame.programBinds = take(Counter::ProgramBinds);
+    frame.vertexArrayBinds = take(Counter::VertexArrayBinds);
+    frame.bufferBinds = take(Counter::BufferBinds);
+    frame.uniformUploads = take(Counter::UniformUploads);
+    frame.bytesUploaded = take(Counter::BytesUploaded);
+    frame.liveBuffers = _liveBuffers.load(std::memory_order_relaxed);
+    frame.liveBufferBytes = _liveBufferBytes.load(std::memory_order_relaxed);
+    frame.inputLatencyMs = _inputLatencyMs.load(std::memory_order_relaxed);
+
+    AllocationCounts allocations = AllocationTracker::totals();
+    frame.allocations = allocations.allocations - _lastAllocations;
+    frame.allocatedBytes = allocations.bytes - _lastAllocatedBytes;
+    _lastAllocations = allocations.allocations;
+    _lastAllocatedBytes = allocations.bytes;
+
+    {
+        std::lock_guard<std::mutex> lock(_historyMutex);
+        _history[_historyNext] = frame;
+        _historyNext = (_historyNext + 1) % HISTORY_FRAMES;
+        _historyCount = std::min(_historyCount + 1, HISTORY_FRAMES);
+    }
+    writeDump(frame);
+}
+
+RenderFrameStats RenderStats::lastFrame() const {
+    std::lock_guard<std::mutex> lock(_historyMutex);
+    if (_historyCount == 0) {
+        return RenderFrameStats{};
+    }
+    return _history[(_historyNext + HISTORY_FRAMES - 1) % HISTORY_FRAMES];
+}
+
+std::pmr::vector<RenderFrameStats> RenderStats::history(std::pmr::memory_resource* resource) const {
+    std::lock_guard<std::mutex> lock(_historyMutex);
+    std::pmr::vector<RenderFrameStats> frames(resource);
+    frames.reserve(_historyCount);
+    size_t first = (_historyNext + HISTORY_FRAMES - _historyCount) % HISTORY_FRAMES;
+    for (size_t i = 0; i < _historyCount; ++i) {
+        frames.push_back(_history[(first + i) % HISTORY_FRAMES]);
+    }
+    return frames;
+}
+
+bool RenderStats::setDumpFile(const std::string& path, unsigned interval) {
+    bool csv = path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+    return setDumpFile(path, csv ? DumpFormat::Csv : DumpFormat::JsonLines, interval);
+}
+
+bool RenderStats::setDumpFile(const std::string& path, DumpFormat format, unsigned interval) {
+    std::lock_guard<std::mutex> lock(_dumpMutex);
+    if (_dump.is_open()) {
+        _dump.close();
+    }
+    if (path.empty()) {
+        return true;
+    }
+    _dump.open(path, std::ios::out | std::ios::trunc);
+    if (!_dump) {
+        std::cerr << "(RenderStats) Cannot open " << path << std::endl;
+        return false;
+    }
+    _dumpFormat = format;
+    _dumpInterval = interval == 0 ? 1 : interval;
+    if (_dumpFormat == DumpFormat::Csv) {
+        _dump << "frame,time_ms,draw_calls,triangles,lines,points,program_binds,vao_binds,buffer_binds,"
+                 "uniform_uploads,bytes_uploaded,live_buffers,live_buffer_bytes,allocations,allocated_bytes,input_latency_ms\n";
+    }
+    return true;
+}
+
+void RenderStats::writeDump(const RenderFrameStats& frame) {
+    std::lock_guard<std::mutex> lock(_dumpMutex);
+    if (!_dump.is_open() || frame.frameIndex % _dumpInterval != 0) {
+        return;
+    }
+    if (_dumpFormat == DumpFormat::Csv) {
+        _dump << frame.frameIndex << ',' << frame.timeMs << ',' << frame.drawCalls << ','
+              << frame.triangles << ',' << frame.lines << ',' << frame.points << ','
+              << frame.programBinds << ',' << frame.vertexArrayBinds << ',' << frame.bufferBinds << ','
+              << frame.uniformUploads << ',' << frame.bytesUploaded << ','
+              << frame.liveBuffers << ',' << frame.liveBufferBytes << ','
+              << frame.allocations << ',' << frame.allocatedBytes << ',' << frame.inputLatencyMs << '\n';
+    } else {
+        _dump << "{\"frame\":" << frame.frameIndex
+              << ",\"time_ms\":" << frame.timeMs
+              << ",\"draw_calls\":" << frame.drawCalls
+              << ",\"triangles\":" << frame.triangles
+              << ",\"lines\":" << frame.lines
+              << ",\"points\":" << frame.points
+              << ",\"program_binds\":" << frame.programBinds
+              << ",\"vao_binds\":" << frame.vertexArrayBinds
+              << ",\"buffer_binds\":" << frame.bufferBinds
+              << ",\"uniform_uploads\":" << frame.uniformUploads
+              << ",\"bytes_uploaded\":" << frame.bytesUploaded
+              << ",\"live_buffers\":" << frame.liveBuffers
+              << ",\"live_buffer_bytes\":" << frame.liveBufferBytes
+              << ",\"allocations\":" << frame.allocations
+              << ",\"allocated_bytes\":" << frame.allocatedBytes
+              << ",\"input_latency_ms\":" << frame.inputLatencyMs << "}\n";
+    }
+    // flushed per line so a dashboard tailing the file sees complete records
+    _dump.flush();
+}
@@ -0,0 +1,140 @@
+#include "RenderStatsOverlay.h"
+#include "AllocationTracker.h"
+#include "MemoryArena.h"
+#include "ResidencyManager.h"
+#include "GLResourceManager.h"
+
+#include "imgui/imgui.h"
+#include <algorithm>
+
+
+static void statRow(const char* label, unsigned long long value) {
+    ImGui::TableNextRow();
+    ImGui::TableSetColumnIndex(0);
+    ImGui::TextUnformatted(label);
+    ImGui::TableSetColumnIndex(1);
+    ImGui::Text("%llu", value);
+}
+
+
+// Scale, MSAA and sharpening of the scene target
+static bool resolutionSection(ResolutionSettings& resolution, float scale, float gpuMs) {
+    static const int SAMPLE_OPTIONS[] = {0, 2, 4, 8};
+    static const char* const SAMPLE_NAMES[] = {"off", "2x", "4x", "8x"};
+
+    if (!ImGui::CollapsingHeader("Resolution", ImGuiTreeNodeFlags_DefaultOpen)) {
+        return false;
+    }
+    if (gpuMs > 0.0f) {
+        ImGui::Text("scale %.0f%%  scene %.2f ms on the GPU", scale * 100.0f, gpuMs);
+    } else {
+        ImGui::Text("scale %.0f%%", scale * 100.0f);
+    }
+    bool changed = ImGui::Checkbox("Dynamic", &resolution.dynamic);
+    if (resolution.dynamic) {
+        changed |= ImGui::SliderFloat("Target ms", &resolution.targetMs, 2.0f, 50.0f, "%.1f");
+        changed |= ImGui::DragFloatRange2("Scale range", &resolution.minScale, &resolution.maxScale, 0.005f, 0.25f, 2.0f, "%.2f");
+    } else {
+        changed |= ImGui::SliderFloat("Scale", &resolution.scale, 0.25f, 2.0f, "%.2f");
+    }
+
+    int selected = 0;
+    for (int i = 0; i < 4; ++i) {
+        selected = SAMPLE_OPTIONS[i] <= resolution.samples ? i : selected;
+    }
+    if (ImGui::Combo("MSAA", &selected, SAMPLE_NAMES, 4)) {
+        resolution.samples = SAMPLE_OPTIONS[selected];
+        changed = true;
+    }
+    changed |= ImGui::SliderFloat("Sharpness", &resolution.sharpness, 0.0f, 1.0f, "%.2f");
+    return changed;
+}
+
+
+bool RenderStatsOverlay::draw(ResolutionSettings& resolution, float scale, float gpuMs) {
+    if (!_visible) {
+        return false;
+    }
+    RenderStats& stats = RenderStats::instance();
+    RenderFrameStats frame = stats.lastFrame();
+
+    ImGui::SetNextWindowSize(ImVec2(320, 380), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Render stats", &_visible)) {
+        ImGui::End();
+        return false;
+    }
+
+    ImGui::Text("frame %llu  (%.2f ms)", static_cast<unsigned long long>(frame.frameIndex), frame.timeMs);
+    if (frame.inputLatencyMs > 0.0) {
+        ImGui::Text("input to present %.1f ms", frame.inputLatencyMs);
+    }
+    if (ImGui::BeginTable("##renderstats", 2, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV)) {
+        statRow("draw calls", frame.drawCalls);
+        statRow("triangles", frame.triangles);
+        statRow("lines", frame.lines);
+        statRow("points", frame.points);
+        statRow("program binds", frame.programBinds);
+        statRow("VAO binds", frame.vertexArrayBinds);
+        statRow("buffer binds", frame.bufferBinds);
+        statRow("uniform uploads", frame.uniformUploads);
+        statRow("bytes uploaded", frame.bytesUploaded);
+        statRow("live buffers", static_cast<unsigned long long>(std::max<int64_t>(frame.liveBuffers, 0)));
+        statRow("live buffer KiB", static_cast<unsigned long long>(std::max<int64_t>(frame.liveBufferBytes, 0) / 1024));
+        if (AllocationTracker::isEnabled()) {
+            statRow("allocations", frame.allocations);
+            statRow("allocated KiB", frame.allocatedBytes / 1024);
+        }
+        statRow("frame arena peak KiB", ArenaResource::frame().peakBytes() / 1024);
+        ImGui::EndTable();
+    }
+
+    ResidencyManager::Totals residency = ResidencyManager::instance().totals();
+    ImGui::Text("samples %.1f / %.0f MiB  meshes %.1f / %.0f MiB", residency.cpuBytes / 1048576.0,
+                residency.cpuBudget / 1048576.0, residency.gpuBytes / 1048576.0, residency.gpuBudget / 1048576.0);
+    ImGui::Text("%zu of %zu meshes resident, %llu evicted", residency.residentMeshes, residency.objects,
+                static_cast<unsigned long long>(residency.evictions));
+    GLResourceManager::Stats resources = GLResourceManager::instance().stats();
+    ImGui::Text("GL names %zu live, %zu pooled, %llu reused / %llu generated", resources.liveBuffers + resources.liveVertexArrays,
+                resources.pooledBuffers + resources.pooledVertexArrays, static_cast<unsigned long long>(resources.namesRecycled),
+                static_cast<unsigned long long>(resources.namesGenerated));
+
+    if (AllocationTracker::isEnabled() && ImGui::CollapsingHeader("Allocations by scope")) {
+        //totals since startup; the top few are enough to find the culprit
+        std::pmr::vector<AllocationTracker::ScopeEntry> scopes = AllocationTracker::scopes(&ArenaResource::frame());
+        if (ImGui::BeginTable("##allocscopes", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV)) {
+            for (size_t i = 0; i < scopes.size() && i < 8; ++i) {
+                ImGui::TableNextRow();
+                ImGui::TableSetColumnIndex(0);
+                ImGui::TextUnformatted(scopes[i].name);
+                ImGui::TableSetColumnIndex(1);
+                ImGui::Text("%llu", static_cast<unsigned long long>(scopes[i].counts.allocations));
+                ImGui::TableSetColumnIndex(2);
+                ImGui::Text("%llu KiB", static_cast<unsigned long long>(scopes[i].counts.bytes / 1024));
+            }
+            ImGui::EndTable();
+        }
+    }
+
+    _drawCalls.clear();
+    for (const RenderFrameStats& past : stats.history(&ArenaResource::frame())) {
+        _drawCalls.push_back(static_cast<float>(past.drawCalls));
+    }
+    if (!_drawCalls.empty()) {
+        float peak = *std::max_element(_drawCalls.begin(), _drawCalls.end());
+        ImGui::PlotLines("##drawcalls", _drawCalls.data(), static_cast<int>(_drawCalls.size()), 0,
+                         "draw calls", 0.0f, std::max(peak, 1.0f) * 1.2f, ImVec2(-1, 50));
+    }
+
+    if (ImGui::Checkbox("Dump every 60 frames", &_dumping)) {
+        if (!stats.setDumpFile(_dumping ? _dumpPath : std::string())) {
+            _dumping = false;
+        }
+    }
+    if (_dumping) {
+        ImGui::TextDisabled("%s", _dumpPath.c_str());
+    }
+
+    bool changed = resolutionSection(resolution, scale, gpuMs);
+    ImGui::End();
+    return changed;
+}
@@ -0,0 +1,165 @@
+#include "ResidencyManager.h"
+#include "Logger.h"
+
+#include <algorithm>
+
+
+ResidencyManager& ResidencyManager::instance() {
+    static ResidencyManager manager;
+    return manager;
+}
+
+ResidencyManager::Entry* ResidencyManager::find(ResidencyId id) {
+    if (id == 0 || id > _entries.size() || !_entries[id - 1].active) {
+        return nullptr;
+    }
+    return &_entries[id - 1];
+}
+
+const ResidencyManager::Entry* ResidencyManager::find(ResidencyId id) const {
+    return const_cast<ResidencyManager*>(this)->find(id);
+}
+
+ResidencyId ResidencyManager::registerObject(const std::string& name, std::function<void()> evictGpu) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    ResidencyId id;
+    if (!_freeIds.empty()) {
+        id = _freeIds.back();
+        _freeIds.pop_back();
+    } else {
+        _entries.emplace_back();
+        id = static_cast<ResidencyId>(_entries.size());
+    }
+    Entry& entry = _entries[id - 1];
+    entry = Entry();
+    entry.name = name;
+    entry.evictGpu = std::move(evictGpu);
+    entry.lastVisibleFrame = _frame;
+    entry.active = true;
+    return id;
+}
+
+void ResidencyManager::unregisterObject(ResidencyId id) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    Entry* entry = find(id);
+    if (entry == nullptr) {
+        return;
+    }
+    _cpuBytes -= entry->cpuBytes;
+    _gpuBytes -= entry->gpuBytes;
+    *entry = Entry();
+    _freeIds.push_back(id);
+}
+
+void ResidencyManager::setCpuBytes(ResidencyId id, size_t bytes) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    Entry* entry = find(id);
+    if (entry == nullptr) {
+        return;
+    }
+    _cpuBytes = _cpuBytes - entry->cpuBytes + bytes;
+    entry->cpuBytes = bytes;
+    if (_cpuBytes > _cpuBudget && !_cpuOverBudgetReported) {
+        GRAPHISQUE_LOG_WARN("ResidencyManager", "Pinned samples use {} MiB, over the {} MiB CPU budget",
+                            _cpuBytes >> 20, _cpuBudget >> 20);
+        _cpuOverBudgetReported = true;
+    } else if (_cpuBytes <= _cpuBudget) {
+        _cpuOverBudgetReported = false;
+    }
+}
+
+void ResidencyManager::setGpuBytes(ResidencyId id, size_t bytes) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    Entry* entry = find(id);
+    if (entry == nullptr) {
+        return;
+    }
+    _gpuBytes = _gpuBytes - entry->gpuBytes + bytes;
+    entry->gpuBytes = bytes;
+    if (bytes > 0) {
+        entry->lastVisibleFrame = _frame; // not evicted before it had a chance to be drawn
+    }
+}
+
+void ResidencyManager::markVisible(ResidencyId id) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (Entry* entry = find(id)) {
+        entry->lastVisibleFrame = _frame;
+    }
+}
+
+void ResidencyManager::setPinned(ResidencyId id, bool pinned) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (Entry* entry = find(id)) {
+        entry->pinned = pinned;
+    }
+}
+
+bool ResidencyManager::isPinned(ResidencyId id) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const Entry* entry = find(id);
+    return entry != nullptr && entry->pinned;
+}
+
+void ResidencyManager::setCpuBudget(size_t bytes) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _cpuBudget = bytes;
+    _cpuOverBudgetReported = false;
+}
+
+void ResidencyManager::setGpuBudget(size_t bytes) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _gpuBudget = bytes;
+}
+
+size_t ResidencyManager::endFrame() {
+    std::vector<std::function<void()>> evictions;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        uint64_t frame = _frame++;
+        if (_gpuBytes <= _gpuBudget) {
+            return 0;
+        }
+        //meshes drawn this frame stay, everything else goes oldest first
+        std::vector<Entry*> candidates;
+        for (Entry& entry : _entries) {
+            if (entry.active && entry.gpuBytes > 0 && entry.lastVisibleFrame < frame && entry.evictGpu) {
+                candidates.push_back(&entry);
+            }
+        }
+        std::sort(candidates.begin(), candidates.end(), [](const Entry* a, const Entry* b) {
+            return a->lastVisibleFrame < b->lastVisibleFrame;
+        });
+        size_t projected = _gpuBytes;
+        for (Entry* entry : candidates) {
+            if (projected <= _gpuBudget) {
+                break;
+            }
+            projected -= entry->gpuBytes;
+            evictions.push_back(entry->evictGpu);
+        }
+        _evictions += evictions.size();
+    }
+    //the callbacks release their buffers and report the new sizes back through setGpuBytes
+    for (const auto& evict : evictions) {
+        evict();
+    }
+    return evictions.size();
+}
+
+ResidencyManager::Totals ResidencyManager::totals() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    Totals totals;
+    totals.cpuBytes = _cpuBytes;
+    totals.gpuBytes = _gpuBytes;
+    totals.cpuBudget = _cpuBudget;
+    totals.gpuBudget = _gpuBudget;
+    totals.evictions = _evictions;
+    for (const Entry& entry : _entries) {
+        if (entry.active) {
+            ++totals.objects;
+            totals.residentMeshes += entry.gpuBytes > 0 ? 1 : 0;
+        }
+    }
+    return totals;
+}
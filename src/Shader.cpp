@@ -1,4 +1,6 @@
 #include "Shader.h"
+#include "RenderStats.h"
+#include "ProgramCache.h"
 #include <fstream>
 #include <sstream>
 #include <iostream>
@@ -35,83 +37,147 @@ Shader::Shader(const char *vertexPath, const char *fragmentPath)
     {
         std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << vertexPath << fragmentPath << std::endl;
     }
+    // a program linked on a previous launch skips compiling entirely
+    ProgramCache &cache = ProgramCache::instance();
+    uint64_t cacheKey = cache.makeKey(vertexCode, fragmentCode);
+    ID = cache.load(cacheKey);
+    if (ID != 0)
+    {
+        return;
+    }
+
     const char *vShaderCode = vertexCode.c_str();
     const char *fShaderCode = fragmentCode.c_str();
 
     // 2. compile shaders
-    unsigned int vertex, fragment;
-    int success;
-    char infoLog[512];
-
-    // vertex Shader
-    vertex = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex, 1, &vShaderCode, NULL);
-    glCompileShader(vertex);
-    // print compile errors if any
-    glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
-    if (!success)
-    {
-        glGetShaderInfoLog(vertex, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n"
-                  << vertexPath << infoLog << std::endl;
-    };
-
-    // fragment Shader
-    fragment = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment, 1, &fShaderCode, NULL);
-    glCompileShader(fragment);
-    // print compile errors if any
-    glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
-    if (!success)
-    {
-        glGetShaderInfoLog(fragment, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n"
-                  << fragmentPath << infoLog << std::endl;
-    };
+    unsigned int vertex = compileStage(GL_VERTEX_SHADER, vShaderCode);
+    checkStage(vertex, vertexPath);
+    unsigned int fragment = compileStage(GL_FRAGMENT_SHADER, fShaderCode);
+    checkStage(fragment, fragmentPath);
 
     ID = glCreateProgram();
     glAttachShader(ID, vertex);
     glAttachShader(ID, fragment);
+    cache.prepare(ID);
     glLinkProgram(ID);
-    // print linking errors if any
-    glGetProgramiv(ID, GL_LINK_STATUS, &success);
-    if (!success)
+    if (checkProgram(ID, (std::string(vertexPath) + "and" + fragmentPath).c_str()))
     {
-        glGetProgramInfoLog(ID, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n"
-                  << vertexPath << "and" << fragmentPath << infoLog << std::endl;
+        cache.store(cacheKey, ID);
     }
     // delete shaders; they’re linked into our program and no longer necessary
     glDeleteShader(vertex);
     glDeleteShader(fragment);
 }
 
+Shader::Shader(unsigned int program) : ID(program)
+{
+}
+
+unsigned int Shader::compileStage(GLenum type, const char *source)
+{
+    unsigned int shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, NULL);
+    glCompileShader(shader);
+    return shader;
+}
+
+bool Shader::checkStage(unsigned int shader, const char *label)
+{
+    int success;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success)
+    {
+        char infoLog[512];
+        GLint type = 0;
+        glGetShaderiv(shader, GL_SHADER_TYPE, &type);
+        glGetShaderInfoLog(shader, 512, NULL, infoLog);
+        std::cout << (type == GL_VERTEX_SHADER ? "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" : "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n")
+                  << label << infoLog << std::endl;
+    }
+    return success != 0;
+}
+
+bool Shader::checkProgram(unsigned int program, const char *label)
+{
+    int success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        char infoLog[512];
+        glGetProgramInfoLog(program, 512, NULL, infoLog);
+        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n"
+                  << label << infoLog << std::endl;
+    }
+    return success != 0;
+}
+
 
 void Shader::use()
 {
     glUseProgram(ID);
+    RenderStats::add(RenderStats::Counter::ProgramBinds);
 }
 
 void Shader::setFloat(const std::string &name, float value) const
 {
-    glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+    setFloat(name.c_str(), value);
 }
 void Shader::setBool(const std::string &name, bool value) const
 {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+    setBool(name.c_str(), value);
+}
+
+void Shader::setVec2(const std::string &name, const glm::vec2 &value) const
+{
+    setVec2(name.c_str(), value);
 }
 
 void Shader::setVec3(const std::string &name, const glm::vec3 &value) const
 {
-    glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(value));
+    setVec3(name.c_str(), value);
 }
 
 void Shader::setMat4(const std::string &name, const glm::mat4 &mat) const
 {
-    glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat));
+    setMat4(name.c_str(), mat);
 }
 
 void Shader::setInt(const std::string &name, int value) const
 {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+    setInt(name.c_str(), value);
+}
+
+void Shader::setFloat(const char *name, float value) const
+{
+    glUniform1f(glGetUniformLocation(ID, name), value);
+    RenderStats::add(RenderStats::Counter::UniformUploads);
+}
+void Shader::setBool(const char *name, bool value) const
+{
+    glUniform1i(glGetUniformLocation(ID, name), (int)value);
+    RenderStats::add(RenderStats::Counter::UniformUploads);
+}
+
+void Shader::setVec2(const char *name, const glm::vec2 &value) const
+{
+    glUniform2f(glGetUniformLocation(ID, name), value.x, value.y);
+    RenderStats::add(RenderStats::Counter::UniformUploads);
+}
+
+void Shader::setVec3(const char *name, const glm::vec3 &value) const
+{
+    glUniform3fv(glGetUniformLocation(ID, name), 1, glm::value_ptr(value));
+    RenderStats::add(RenderStats::Counter::UniformUploads);
+}
+
+void Shader::setMat4(const char *name, const glm::mat4 &mat) const
+{
+    glUniformMatrix4fv(glGetUniformLocation(ID, name), 1, GL_FALSE, glm::value_ptr(mat));
+    RenderStats::add(RenderStats::Counter::UniformUploads);
+}
+
+void Shader::setInt(const char *name, int value) const
+{
+    glUniform1i(glGetUniformLocation(ID, name), value);
+    RenderStats::add(RenderStats::Counter::UniformUploads);
 }
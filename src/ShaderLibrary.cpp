@@ -0,0 +1,154 @@
+#include "ShaderLibrary.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+
+ShaderLibrary& ShaderLibrary::instance() {
+    static ShaderLibrary library;
+    return library;
+}
+
+ShaderLibrary::ShaderLibrary() {
+#ifdef GRAPHISQUE_EMBED_SHADERS
+    for (size_t i = 0; i < EMBEDDED_SHADER_COUNT; ++i) {
+        _sources.emplace(EMBEDDED_SHADERS[i].name, EMBEDDED_SHADERS[i].source);
+    }
+#endif
+}
+
+void ShaderLibrary::setDirectory(const std::string& directory) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _directory = directory;
+}
+
+void ShaderLibrary::addSource(const std::string& name, std::string source) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _sources[name] = std::move(source);
+}
+
+bool ShaderLibrary::source(const std::string& name, std::string& out) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto found = _sources.find(name);
+    if (found == _sources.end()) {
+        std::ifstream file(_directory + "/" + name, std::ios::binary);
+        if (!file) {
+            return false;
+        }
+        std::stringstream stream;
+        stream << file.rdbuf();
+        found = _sources.emplace(name, stream.str()).first;
+    }
+    out = found->second;
+    return true;
+}
+
+
+// "#  keyword argument" -> keyword, argument; false for anything that isn't a directive
+static bool parseDirective(const std::string& line, std::string& keyword, std::string& argument) {
+    size_t i = line.find_first_not_of(" \t");
+    if (i == std::string::npos || line[i] != '#') {
+        return false;
+    }
+    i = line.find_first_not_of(" \t", i + 1);
+    if (i == std::string::npos) {
+        return false;
+    }
+    size_t end = line.find_first_of(" \t\r", i);
+    keyword = line.substr(i, end == std::string::npos ? std::string::npos : end - i);
+    size_t start = end == std::string::npos ? std::string::npos : line.find_first_not_of(" \t", end);
+    argument = start == std::string::npos ? std::string() : line.substr(start);
+    return true;
+}
+
+void ShaderLibrary::expand(const std::string& name, Expansion& expansion) {
+    std::string text;
+    if (!source(name, text)) {
+        throw std::runtime_error("(ShaderLibrary) Unknown shader " + name);
+    }
+    const size_t index = expansion.files.size();
+    expansion.files.push_back(name);
+    const size_t slash = name.find_last_of('/');
+    const std::string directory = slash == std::string::npos ? std::string() : name.substr(0, slash + 1);
+
+    size_t lineNumber = 0;
+    size_t begin = 0;
+    while (begin < text.size()) {
+        size_t end = text.find('\n', begin);
+        std::string line = text.substr(begin, end == std::string::npos ? std::string::npos : end - begin);
+        begin = end == std::string::npos ? text.size() : end + 1;
+        ++lineNumber;
+
+        std::string keyword, argument;
+        if (!parseDirective(line, keyword, argument)) {
+            expansion.out += line;
+            expansion.out += '\n';
+            continue;
+        }
+        if (keyword == "include") {
+            char close = !argument.empty() && argument[0] == '<' ? '>' : '"';
+            size_t closing = argument.size() > 1 ? argument.find(close, 1) : std::string::npos;
+            if ((argument.empty() || (argument[0] != '"' && argument[0] != '<')) || closing == std::string::npos) {
+                throw std::runtime_error("(ShaderLibrary) " + name + ":" + std::to_string(lineNumber) + ": malformed #include");
+            }
+            std::string target = directory + argument.substr(1, closing - 1);
+            if (std::find(expansion.files.begin(), expansion.files.end(), target) != expansion.files.end()) {
+                expansion.out += '\n'; // already in, keep the line count
+                continue;
+            }
+            expansion.out += "#line 1 " + std::to_string(expansion.files.size()) + "\n";
+            expand(target, expansion);
+            expansion.out += "#line " + std::to_string(lineNumber + 1) + " " + std::to_string(index) + "\n";
+        } else if (keyword == "version") {
+            //only the shader itself declares the version; includes may carry one for editors
+            if (index == 0 && expansion.versionEnd == std::string::npos) {
+                expansion.out += line;
+                expansion.out += '\n';
+                expansion.versionEnd = expansion.out.size();
+                expansion.versionLine = lineNumber + 1;
+            } else {
+                expansion.out += '\n';
+            }
+        } else {
+            expansion.out += line;
+            expansion.out += '\n';
+        }
+    }
+}
+
+std::string ShaderLibrary::preprocess(const std::string& name, const ShaderDefines& defines,
+                                      std::vector<std::string>* files) {
+    Expansion expansion;
+    expand(name, expansion);
+    if (!defines.empty()) {
+        std::string block;
+        for (const auto& define : defines) {
+            block += "#define " + define.first;
+            if (!define.second.empty()) {
+                block += " " + define.second;
+            }
+            block += "\n";
+        }
+        //the defines don't count as lines of the file
+        size_t at = expansion.versionEnd == std::string::npos ? 0 : expansion.versionEnd;
+        block += "#line " + std::to_string(at == 0 ? 1 : expansion.versionLine) + " 0\n";
+        expansion.out.insert(at, block);
+    }
+    if (files != nullptr) {
+        *files = std::move(expansion.files);
+    }
+    return expansion.out;
+}
+
+std::string ShaderLibrary::definesKey(const ShaderDefines& defines) {
+    std::string key;
+    for (const auto& define : defines) {
+        key += define.first;
+        key += '=';
+        key += define.second;
+        key += ';';
+    }
+    return key;
+}
@@ -0,0 +1,176 @@
+#include "ShaderVariants.h"
+#include "ProgramCache.h"
+#include "Profiler.h"
+
+#include <cstring>
+
+
+// GL_KHR_parallel_shader_compile / GL_ARB_parallel_shader_compile, not in our glad header
+#ifndef GL_COMPLETION_STATUS_KHR
+    #define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+static const char* const FEATURE_DEFINES[ShaderVariants::FEATURE_COUNT] = {
+    "HEIGHTFIELD",
+    "LIT",
+    "WIREFRAME",
+    "INSTANCED",
+    "COLORMAP"
+};
+
+
+ShaderDefines ShaderVariants::defines(Features features) {
+    ShaderDefines defines;
+    for (size_t bit = 0; bit < FEATURE_COUNT; ++bit) {
+        if (features & (1u << bit)) {
+            defines.emplace_back(FEATURE_DEFINES[bit], "");
+        }
+    }
+    return defines;
+}
+
+void ShaderVariants::loadFunctions(GLADloadproc loader) {
+    _maxCompilerThreads = nullptr;
+    GLint extensions = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensions);
+    for (GLint i = 0; i < extensions && _maxCompilerThreads == nullptr; ++i) {
+        const char* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+        if (name == nullptr) {
+            continue;
+        }
+        if (std::strcmp(name, "GL_KHR_parallel_shader_compile") == 0) {
+            _maxCompilerThreads = reinterpret_cast<MaxShaderCompilerThreadsProc>(loader("glMaxShaderCompilerThreadsKHR"));
+        } else if (std::strcmp(name, "GL_ARB_parallel_shader_compile") == 0) {
+            _maxCompilerThreads = reinterpret_cast<MaxShaderCompilerThreadsProc>(loader("glMaxShaderCompilerThreadsARB"));
+        }
+    }
+    if (_maxCompilerThreads != nullptr) {
+        _maxCompilerThreads(0xFFFFFFFFu); // as many as the driver wants
+    }
+}
+
+ShaderVariants::VariantId ShaderVariants::request(const std::string& vertex, const std::string& fragment, Features features) {
+    for (size_t i = 0; i < _variants.size(); ++i) {
+        const Variant& variant = _variants[i];
+        if (variant.features == features && variant.vertex == vertex && variant.fragment == fragment) {
+            return static_cast<VariantId>(i);
+        }
+    }
+    GRAPHISQUE_PROFILE_SCOPE("Shader variant");
+    Variant variant;
+    variant.vertex = vertex;
+    variant.fragment = fragment;
+    variant.features = features;
+
+    ShaderDefines variantDefines = defines(features);
+    ShaderLibrary& library = ShaderLibrary::instance();
+    std::string vertexSource = library.preprocess(vertex, variantDefines);
+    std::string fragmentSource = library.preprocess(fragment, variantDefines);
+
+    ProgramCache& cache = ProgramCache::instance();
+    variant.cacheKey = cache.makeKey(vertexSource, fragmentSource, ShaderLibrary::definesKey(variantDefines));
+    variant.program = cache.load(variant.cacheKey);
+    if (variant.program != 0) {
+        variant.state = State::Linked;
+    } else {
+        //no status query here, that would wait for the compile to finish
+        variant.vertexShader = Shader::compileStage(GL_VERTEX_SHADER, vertexSource.c_str());
+        variant.fragmentShader = Shader::compileStage(GL_FRAGMENT_SHADER, fragmentSource.c_str());
+    }
+    _variants.push_back(std::move(variant));
+    return static_cast<VariantId>(_variants.size() - 1);
+}
+
+std::string ShaderVariants::label(const Variant& variant) const {
+    std::string text = variant.vertex + "+" + variant.fragment;
+    for (const auto& define : defines(variant.features)) {
+        text += " " + define.first;
+    }
+    text += " ";
+    return text;
+}
+
+void ShaderVariants::link(Variant& variant) {
+    GRAPHISQUE_PROFILE_SCOPE("Shader link");
+    std::string name = label(variant);
+    //check both stages so both logs get printed
+    bool vertexCompiled = Shader::checkStage(variant.vertexShader, name.c_str());
+    bool fragmentCompiled = Shader::checkStage(variant.fragmentShader, name.c_str());
+    variant.state = State::Failed;
+    if (vertexCompiled && fragmentCompiled) {
+        ProgramCache& cache = ProgramCache::instance();
+        variant.program = glCreateProgram();
+        glAttachShader(variant.program, variant.vertexShader);
+        glAttachShader(variant.program, variant.fragmentShader);
+        cache.prepare(variant.program);
+        glLinkProgram(variant.program);
+        if (Shader::checkProgram(variant.program, name.c_str())) {
+            cache.store(variant.cacheKey, variant.program);
+            variant.state = State::Linked;
+        } else {
+            glDeleteProgram(variant.program);
+            variant.program = 0;
+        }
+    }
+    glDeleteShader(variant.vertexShader);
+    glDeleteShader(variant.fragmentShader);
+    variant.vertexShader = 0;
+    variant.fragmentShader = 0;
+}
+
+std::shared_ptr<Shader> ShaderVariants::get(VariantId id) {
+    if (id >= _variants.size()) {
+        return nullptr;
+    }
+    Variant& variant = _variants[id];
+    if (variant.state == State::Compiling) {
+        link(variant);
+    }
+    if (!variant.shader) {
+        variant.shader = std::make_shared<Shader>(variant.program);
+    }
+    return variant.shader;
+}
+
+bool ShaderVariants::isReady(VariantId id) const {
+    if (id >= _variants.size()) {
+        return false;
+    }
+    const Variant& variant = _variants[id];
+    if (variant.state != State::Compiling) {
+        return true;
+    }
+    if (_maxCompilerThreads == nullptr) {
+        return false; // no way to ask without waiting
+    }
+    GLint vertexDone = GL_FALSE, fragmentDone = GL_FALSE;
+    glGetShaderiv(variant.vertexShader, GL_COMPLETION_STATUS_KHR, &vertexDone);
+    glGetShaderiv(variant.fragmentShader, GL_COMPLETION_STATUS_KHR, &fragmentDone);
+    return vertexDone == GL_TRUE && fragmentDone == GL_TRUE;
+}
+
+size_t ShaderVariants::linkedCount() const {
+    size_t linked = 0;
+    for (const Variant& variant : _variants) {
+        linked += variant.state == State::Linked ? 1 : 0;
+    }
+    return linked;
+}
+
+void ShaderVariants::release() {
+    for (Variant& variant : _variants) {
+        if (variant.vertexShader != 0) {
+            glDeleteShader(variant.vertexShader);
+        }
+        if (variant.fragmentShader != 0) {
+            glDeleteShader(variant.fragmentShader);
+        }
+        if (variant.program != 0) {
+            glDeleteProgram(variant.program);
+        }
+        if (variant.shader) {
+            variant.shader->ID = 0; // whoever still holds it sees an empty shader
+        }
+    }
+    _variants.clear();
+}
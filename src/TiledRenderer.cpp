@@ -0,0 +1,132 @@
+#include "TiledRenderer.h"
+
+#include "Profiler.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+
+TiledRenderer::TiledRenderer(const std::string& path, int width, int height, int tileSize)
+    : _path(path), _width(width), _height(height), _tileSize(tileSize) {
+}
+
+TiledRenderer::~TiledRenderer() {
+    if (_file != nullptr) {
+        std::fclose(_file);
+    }
+}
+
+glm::mat4 TiledRenderer::tileProjection(const glm::mat4& projection, int x, int y, int size, int width, int height) {
+    // the tile's rectangle in normalised device coordinates of the full image (y up)
+    float left = -1.0f + 2.0f * static_cast<float>(x) / static_cast<float>(width);
+    float right = -1.0f + 2.0f * static_cast<float>(x + size) / static_cast<float>(width);
+    float top = 1.0f - 2.0f * static_cast<float>(y) / static_cast<float>(height);
+    float bottom = 1.0f - 2.0f * static_cast<float>(y + size) / static_cast<float>(height);
+
+    // scale and shift clip space so that rectangle fills [-1, 1]
+    glm::mat4 crop(1.0f);
+    crop[0][0] = 2.0f / (right - left);
+    crop[1][1] = 2.0f / (top - bottom);
+    crop[3][0] = -(right + left) / (right - left);
+    crop[3][1] = -(top + bottom) / (top - bottom);
+    return crop * projection;
+}
+
+void TiledRenderer::fail(const std::string& message) {
+    std::cerr << "(TiledRenderer) " << _path << ": " << message << std::endl;
+    _failed = true;
+    if (_file != nullptr) {
+        std::fclose(_file);
+        _file = nullptr;
+    }
+}
+
+bool TiledRenderer::begin() {
+    GLint maxRenderbuffer = 0;
+    GLint maxViewport[2] = {0, 0};
+    glGetIntegerv(GL_MAX_RENDERBUFFER_SIZE, &maxRenderbuffer);
+    glGetIntegerv(GL_MAX_VIEWPORT_DIMS, maxViewport);
+    _tileSize = std::max(1, std::min({_tileSize, static_cast<int>(maxRenderbuffer), static_cast<int>(maxViewport[0]),
+                                      static_cast<int>(maxViewport[1])}));
+    _columns = (_width + _tileSize - 1) / _tileSize;
+    _rows = (_height + _tileSize - 1) / _tileSize;
+
+    try {
+        _tile = std::make_unique<GLFramebuffer>(_tileSize, _tileSize);
+    } catch (const std::exception& e) {
+        fail(e.what());
+        return false;
+    }
+    _stripe.resize(static_cast<size_t>(_width) * _tileSize * 4);
+
+    _file = std::fopen(_path.c_str(), "wb");
+    if (_file == nullptr) {
+        fail("cannot open for writing");
+        return false;
+    }
+    FILE* file = _file;
+    if (!_png.begin([file](const uint8_t* data, size_t size) { return std::fwrite(data, 1, size, file) == size; },
+                    _width, _height)) {
+        fail("write failed");
+        return false;
+    }
+    std::cout << "(TiledRenderer) " << _width << "x" << _height << " in " << tileCount() << " tiles of "
+              << _tileSize << "px" << std::endl;
+    return true;
+}
+
+TaskStatus TiledRenderer::renderNextTile(const glm::mat4& projection, const DrawFn& draw) {
+    if (_failed || !_tile) {
+        return TaskStatus::Done;
+    }
+    GRAPHISQUE_PROFILE_SCOPE("Poster tile");
+    const int column = _nextTile % _columns;
+    const int row = _nextTile / _columns;
+    const int x = column * _tileSize;
+    const int y = row * _tileSize;
+
+    try {
+        _tile->bind();
+        glViewport(0, 0, _tileSize, _tileSize);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        draw(tileProjection(projection, x, y, _tileSize, _width, _height));
+        _tile->readPixels(_tilePixels);
+    } catch (const std::exception& e) {
+        fail(e.what());
+        return TaskStatus::Done;
+    }
+
+    // edge tiles hang over the image; only the part inside is kept
+    const int usedWidth = std::min(_tileSize, _width - x);
+    const int usedHeight = std::min(_tileSize, _height - y);
+    for (int r = 0; r < usedHeight; ++r) {
+        // readback rows are bottom-up, stripe rows top-down
+        const uint8_t* src = _tilePixels.data() + static_cast<size_t>(_tileSize - 1 - r) * _tileSize * 4;
+        uint8_t* dst = _stripe.data() + (static_cast<size_t>(r) * _width + x) * 4;
+        std::memcpy(dst, src, static_cast<size_t>(usedWidth) * 4);
+    }
+
+    ++_nextTile;
+    if (column == _columns - 1) {
+        for (int r = 0; r < usedHeight; ++r) {
+            if (!_png.writeRow(_stripe.data() + static_cast<size_t>(r) * _width * 4)) {
+                fail("write failed");
+                return TaskStatus::Done;
+            }
+        }
+    }
+    if (_nextTile < tileCount()) {
+        return TaskStatus::Continue;
+    }
+
+    bool ok = _png.finish();
+    ok = std::fclose(_file) == 0 && ok;
+    _file = nullptr;
+    if (!ok) {
+        fail("write failed");
+    } else {
+        std::cout << "(TiledRenderer) Wrote " << _path << std::endl;
+    }
+    _tile.reset();
+    return TaskStatus::Done;
+}
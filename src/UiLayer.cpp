@@ -0,0 +1,132 @@
+#include "UiLayer.h"
+
+#include "imgui/imgui_impl_glfw.h"
+#include "imgui/imgui_impl_opengl3.h"
+#include <cstring>
+
+
+// ImVector's operator= frees and reallocates; this keeps the destination's capacity
+template<typename T>
+static void copyInto(ImVector<T>& dst, const ImVector<T>& src) {
+    dst.resize(src.Size);
+    if (src.Size > 0) {
+        std::memcpy(dst.Data, src.Data, static_cast<size_t>(src.Size) * sizeof(T));
+    }
+}
+
+
+bool UiLayer::init(GLFWwindow* window, const char* glslVersion) {
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext();
+    ImGui::StyleColorsDark();
+    if (!ImGui_ImplGlfw_InitForOpenGL(window, true)) {
+        return false;
+    }
+    if (!ImGui_ImplOpenGL3_Init(glslVersion)) {
+        ImGui_ImplGlfw_Shutdown();
+        return false;
+    }
+    _initialized = true;
+    return true;
+}
+
+void UiLayer::shutdown() {
+    if (!_initialized) {
+        return;
+    }
+    ImGui_ImplOpenGL3_Shutdown();
+    ImGui_ImplGlfw_Shutdown();
+    ImGui::DestroyContext();
+    _initialized = false;
+}
+
+void UiLayer::beginFrame() {
+    {
+        // the renderer updates ImGui's textures until it has drawn the frame; NewFrame may not
+        // touch them before that, so there is no timeout
+        std::unique_lock<std::mutex> lock(_textureMutex);
+        _textureCv.wait(lock, [this] { return !_texturesInFlight || _rendererStopped; });
+        _texturesInFlight = false;
+    }
+    ImGui_ImplGlfw_NewFrame();
+    ImGui::NewFrame();
+}
+
+void UiLayer::endFrame(UiDrawData& out) {
+    ImGui::Render();
+    ImDrawData* drawData = ImGui::GetDrawData();
+
+    out.valid = drawData->Valid;
+    out.displayPos = drawData->DisplayPos;
+    out.displaySize = drawData->DisplaySize;
+    out.framebufferScale = drawData->FramebufferScale;
+    out.totalVtxCount = drawData->TotalVtxCount;
+    out.totalIdxCount = drawData->TotalIdxCount;
+    out.listCount = drawData->CmdListsCount;
+    while (out.lists.size() < static_cast<size_t>(out.listCount)) {
+        out.lists.emplace_back(new ImDrawList(ImGui::GetDrawListSharedData()));
+    }
+    for (int i = 0; i < out.listCount; ++i) {
+        const ImDrawList* src = drawData->CmdLists[i];
+        ImDrawList* dst = out.lists[i].get();
+        copyInto(dst->CmdBuffer, src->CmdBuffer);
+        copyInto(dst->IdxBuffer, src->IdxBuffer);
+        copyInto(dst->VtxBuffer, src->VtxBuffer);
+        dst->Flags = src->Flags;
+    }
+
+    out.textures = nullptr;
+    if (drawData->Textures != nullptr) {
+        for (ImTextureData* texture : *drawData->Textures) {
+            if (texture->Status != ImTextureStatus_OK) {
+                out.textures = drawData->Textures;
+                std::lock_guard<std::mutex> lock(_textureMutex);
+                _texturesInFlight = true;
+                break;
+            }
+        }
+    }
+}
+
+void UiLayer::render(const UiDrawData& data) {
+    if (!_initialized || !data.valid) {
+        releaseTextures(data);
+        return;
+    }
+    ImGui_ImplOpenGL3_NewFrame();
+
+    _renderDrawData.Clear();
+    _renderDrawData.Valid = true;
+    _renderDrawData.DisplayPos = data.displayPos;
+    _renderDrawData.DisplaySize = data.displaySize;
+    _renderDrawData.FramebufferScale = data.framebufferScale;
+    for (int i = 0; i < data.listCount; ++i) {
+        _renderDrawData.CmdLists.push_back(data.lists[i].get());
+    }
+    _renderDrawData.CmdListsCount = data.listCount;
+    _renderDrawData.TotalVtxCount = data.totalVtxCount;
+    _renderDrawData.TotalIdxCount = data.totalIdxCount;
+    _renderDrawData.Textures = data.textures;
+    ImGui_ImplOpenGL3_RenderDrawData(&_renderDrawData);
+    releaseTextures(data);
+}
+
+// Whatever the frame asked for is done (or skipped, ImGui asks again next frame)
+void UiLayer::releaseTextures(const UiDrawData& data) {
+    if (data.textures == nullptr) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_textureMutex);
+        _texturesInFlight = false;
+    }
+    _textureCv.notify_all();
+}
+
+void UiLayer::rendererStopped() {
+    {
+        std::lock_guard<std::mutex> lock(_textureMutex);
+        _rendererStopped = true;
+    }
+    _textureCv.notify_all();
+}
@@ -0,0 +1,163 @@
+#include "UploadWorker.h"
+#include "Logger.h"
+#include "Profiler.h"
+
+#include <chrono>
+#include <iostream>
+
+
+UploadWorker::UploadWorker(GLFWwindow* sharedWindow, size_t queueCapacity)
+    : _sharedWindow(sharedWindow), _uploadWindow(nullptr),
+      _pending(queueCapacity), _completed(queueCapacity), _running(false) {
+}
+
+UploadWorker::~UploadWorker() {
+    stop();
+}
+
+bool UploadWorker::start() {
+    if (_running.load()) {
+        return true;
+    }
+    // Same context version as the main window, but never shown
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    _uploadWindow = glfwCreateWindow(1, 1, "upload", nullptr, _sharedWindow);
+    glfwDefaultWindowHints();
+    if (_uploadWindow == nullptr) {
+        std::cerr << "(UploadWorker) Failed to create shared upload context" << std::endl;
+        return false;
+    }
+
+    _running.store(true, std::memory_order_release);
+    _thread = std::thread(&UploadWorker::workerLoop, this);
+    return true;
+}
+
+void UploadWorker::stop() {
+    if (_running.exchange(false)) {
+        {
+            std::lock_guard<std::mutex> lock(_wakeMutex);
+        }
+        _wakeCv.notify_all();
+        if (_thread.joinable()) {
+            _thread.join();
+        }
+    }
+
+    // Whatever is left is released with the caller's (main) context current
+    CompletedUpload upload;
+    while (_completed.tryPop(upload)) {
+        releaseUpload(upload);
+    }
+    for (auto& inFlight : _inFlight) {
+        releaseUpload(inFlight);
+    }
+    _inFlight.clear();
+
+    if (_uploadWindow != nullptr) {
+        glfwDestroyWindow(_uploadWindow);
+        _uploadWindow = nullptr;
+    }
+}
+
+bool UploadWorker::submit(SampleGrid& grid) {
+    if (!_running.load(std::memory_order_acquire) || !_pending.tryPush(grid)) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_wakeMutex);
+    }
+    _wakeCv.notify_one();
+    return true;
+}
+
+void UploadWorker::workerLoop() {
+    Profiler::instance().setThreadName("upload");
+    glfwMakeContextCurrent(_uploadWindow);
+
+    while (_running.load(std::memory_order_acquire)) {
+        SampleGrid grid;
+        if (!_pending.tryPop(grid)) {
+            std::unique_lock<std::mutex> lock(_wakeMutex);
+            _wakeCv.wait_for(lock, std::chrono::milliseconds(50), [this] {
+                return !_running.load(std::memory_order_acquire) || !_pending.empty();
+            });
+            continue;
+        }
+        if (grid.generation < _currentGeneration.load(std::memory_order_relaxed)) {
+            continue; // superseded while it waited, don't spend an upload on it
+        }
+
+        CompletedUpload upload;
+        try {
+            GRAPHISQUE_PROFILE_SCOPE("Upload");
+            upload.buffer = std::make_unique<VertexBuffer>();
+            uploadSampleGrid(*upload.buffer, grid);
+        } catch (const std::exception& e) {
+            GRAPHISQUE_LOG_ERROR("UploadWorker", "Upload failed, handing the grid back: {}", e.what());
+            upload.buffer.reset();
+        }
+        // The fence is what the render thread polls; flush so it actually reaches the GPU
+        if (upload.buffer) {
+            upload.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            glFlush();
+        }
+        upload.grid = std::move(grid);
+
+        bool queued = true;
+        while (!_completed.tryPush(upload)) {
+            if (!_running.load(std::memory_order_acquire)) {
+                releaseUpload(upload);
+                queued = false;
+                break;
+            }
+            std::this_thread::yield();
+        }
+        if (queued && _onUploaded) {
+            _onUploaded();
+        }
+    }
+
+    glfwMakeContextCurrent(nullptr);
+}
+
+size_t UploadWorker::pollCompleted(const std::function<void(CompletedUpload&)>& onReady) {
+    CompletedUpload upload;
+    while (_completed.tryPop(upload)) {
+        _inFlight.push_back(std::move(upload));
+    }
+
+    size_t delivered = 0;
+    for (auto it = _inFlight.begin(); it != _inFlight.end();) {
+        // Zero timeout: this only queries the fence, it never blocks. A failed upload has none.
+        GLenum status = it->fence != nullptr ? glClientWaitSync(it->fence, 0, 0) : GL_ALREADY_SIGNALED;
+        if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED) {
+            if (it->fence != nullptr) {
+                glDeleteSync(it->fence);
+                it->fence = nullptr;
+            }
+            onReady(*it);
+            it = _inFlight.erase(it);
+            ++delivered;
+        } else if (status == GL_WAIT_FAILED) {
+            GRAPHISQUE_LOG_WARN("UploadWorker", "Fence wait failed, handing the grid back");
+            releaseUpload(*it);
+            onReady(*it);
+            it = _inFlight.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return delivered;
+}
+
+void UploadWorker::releaseUpload(CompletedUpload& upload) {
+    if (upload.fence != nullptr) {
+        glDeleteSync(upload.fence);
+        upload.fence = nullptr;
+    }
+    upload.buffer.reset();
+}
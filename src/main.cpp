@@ -1,10 +1,203 @@
 #include "Application.h"
+#include "AllocationTracker.h"
+#include "BatchRenderer.h"
+#include "HardwareCounters.h"
+#include "ResidencyManager.h"
+#include "ProgramCache.h"
 
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+
+// --batch JOBFILE: render every job of the file to PNG and exit, see BatchJob.h
+static int runBatch(const char* jobFile) { 
+    std::vector<BatchJob> jobs;
+    try { 
+        jobs = loadBatchJobs(jobFile);
+    } catch (const std::exception& e) { 
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    BatchRenderer renderer;
+    if (!renderer.init()) { 
+        return 1;
+    }
+    BatchResult result = renderer.run(jobs);
+    std::printf("Rendered %zu plots (%zu failed) in %.2f s: %.1f plots/s\n",
+                result.rendered, result.failed, result.seconds, result.plotsPerSecond());
+    return result.failed == 0 ? 0 : 2;
+}
+
+
+static void printCounterScopes() { 
+    CounterScopeStats::instance().print(stdout);
+}
+
+
+int main(int argc, char** argv) { 
+    //--perf-counters: hardware counters for the sampling scopes, printed on exit
+    for (int i = 1; i < argc; ++i) { 
+        if (std::strcmp(argv[i], "--perf-counters") == 0) { 
+            HardwareCounters::setScopesEnabled(true);
+            CounterScopeStats::instance(); // constructed first, so it outlives the exit handler
+            std::atexit(printCounterScopes);
+        }
+    }
+    //--shader-cache DIR: where linked programs are cached, --no-shader-cache: always compile
+    for (int i = 1; i < argc; ++i) { 
+        if (std::strcmp(argv[i], "--shader-cache") == 0 && i + 1 < argc) { 
+            ProgramCache::instance().setDirectory(argv[++i]);
+        }
+        if (std::strcmp(argv[i], "--no-shader-cache") == 0) { 
+            ProgramCache::instance().setDirectory("");
+        }
+    }
+    for (int i = 1; i + 1 < argc; ++i) { 
+        if (std::strcmp(argv[i], "--batch") == 0) { 
+            return runBatch(argv[i + 1]);
+        }
+    }
 
-int main() { 
     Application app("Grapher");
-    app.init();
+    const char* turntablePath = nullptr;
+    int turntableFrames = 360;
+    const char* posterPath = nullptr;
+    int posterWidth = 0, posterHeight = 0;
+    const char* recordPath = nullptr;
+    const char* replayPath = nullptr;
+    ColorMapping colorMapping;
+    int msaaSamples = -1;
+    float renderScale = 0.0f, targetMs = 0.0f;
+    int queuedFrames = -1; // no low latency mode
+    for (int i = 1; i < argc; ++i) { 
+        //--headless [WIDTHxHEIGHT]: render offscreen through EGL, no window needed
+        if (std::strcmp(argv[i], "--headless") == 0) { 
+            int width = 1280, height = 720;
+            if (i + 1 < argc && std::sscanf(argv[i + 1], "%dx%d", &width, &height) == 2) { 
+                ++i;
+            }
+            app.setHeadless(width, height);
+        }
+        //--low-latency [FRAMES]: input first, late camera, at most FRAMES queued frames (default 1, 0 no limit)
+        if (std::strcmp(argv[i], "--low-latency") == 0) { 
+            queuedFrames = 1;
+            if (i + 1 < argc && std::sscanf(argv[i + 1], "%d", &queuedFrames) == 1) { 
+                ++i;
+            }
+        }
+        //--turntable FRAMES PATH: record one turn of the scene (.y4m, .ppm or a PNG sequence)
+        if (std::strcmp(argv[i], "--turntable") == 0 && i + 2 < argc) { 
+            turntableFrames = std::atoi(argv[i + 1]);
+            turntablePath = argv[i + 2];
+            i += 2;
+        }
+        //--poster WIDTHxHEIGHT PATH: tiled render of the view, any size
+        if (std::strcmp(argv[i], "--poster") == 0 && i + 2 < argc &&
+            std::sscanf(argv[i + 1], "%dx%d", &posterWidth, &posterHeight) == 2) { 
+            posterPath = argv[i + 2];
+            i += 2;
+        }
+        //--record PATH: log input and scene commands; --replay PATH: play them back and time every frame
+        //--cpu-budget MIB / --gpu-budget MIB: pinned sample memory and mesh memory budgets
+        if (std::strcmp(argv[i], "--cpu-budget") == 0 && i + 1 < argc) { 
+            ResidencyManager::instance().setCpuBudget(static_cast<size_t>(std::atof(argv[++i]) * 1048576.0));
+        }
+        if (std::strcmp(argv[i], "--gpu-budget") == 0 && i + 1 < argc) { 
+            ResidencyManager::instance().setGpuBudget(static_cast<size_t>(std::atof(argv[++i]) * 1048576.0));
+        }
+        //--assert-no-alloc: abort if a frame allocates once the scene has settled
+        if (std::strcmp(argv[i], "--assert-no-alloc") == 0) { 
+            if (!AllocationTracker::isEnabled()) { 
+                std::cerr << "--assert-no-alloc needs a GRAPHISQUE_TRACK_ALLOCATIONS build" << std::endl;
+            }
+            app.setAssertNoAllocations(true);
+        }
+        //--color-by CHANNEL: height, slope or curvature; --colormap NAME: viridis, coolwarm or grayscale
+        //--color-range MIN MAX: map this range instead of the channel's own min/max
+        if (std::strcmp(argv[i], "--color-by") == 0 && i + 1 < argc) { 
+            colorMapping.enabled = parseScalarChannel(argv[++i], colorMapping.channel);
+            if (!colorMapping.enabled) { 
+                std::cerr << "Unknown channel " << argv[i] << ", expected height, slope or curvature" << std::endl;
+            }
+        }
+        if (std::strcmp(argv[i], "--colormap") == 0 && i + 1 < argc) { 
+            if (!parseColormap(argv[++i], colorMapping.colormap)) { 
+                std::cerr << "Unknown colormap " << argv[i] << ", expected viridis, coolwarm or grayscale" << std::endl;
+            }
+        }
+        if (std::strcmp(argv[i], "--color-range") == 0 && i + 2 < argc) { 
+            colorMapping.autoRange = false;
+            colorMapping.range = ScalarRange{static_cast<float>(std::atof(argv[i + 1])), static_cast<float>(std::atof(argv[i + 2]))};
+            i += 2;
+        }
+        //--msaa N: scene samples, 0 for none; --render-scale S: fixed scale of the scene;
+        //--target-ms MS: scale dynamically to keep the scene's GPU time under MS
+        if (std::strcmp(argv[i], "--msaa") == 0 && i + 1 < argc) { 
+            msaaSamples = std::atoi(argv[++i]);
+        }
+        if (std::strcmp(argv[i], "--render-scale") == 0 && i + 1 < argc) { 
+            renderScale = static_cast<float>(std::atof(argv[++i]));
+        }
+        if (std::strcmp(argv[i], "--target-ms") == 0 && i + 1 < argc) { 
+            targetMs = static_cast<float>(std::atof(argv[++i]));
+        }
+        if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) { 
+            recordPath = argv[++i];
+        }
+        if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) { 
+            replayPath = argv[++i];
+        }
+    }
+    if (!app.init()) { 
+        return 1;
+    }
+    app.setColorMapping(colorMapping);
+    ResolutionSettings resolution = app.getResolutionSettings();
+    if (msaaSamples >= 0) { 
+        resolution.samples = msaaSamples;
+    }
+    if (renderScale > 0.0f) { 
+        resolution.dynamic = false;
+        resolution.scale = renderScale;
+    }
+    if (targetMs > 0.0f) { 
+        resolution.dynamic = true;
+        resolution.targetMs = targetMs;
+    }
+    app.setResolutionSettings(resolution);
+    if (queuedFrames >= 0) { 
+        app.setLowLatency(true, queuedFrames);
+    }
+    if (replayPath != nullptr) { 
+        FrameTimeSummary summary = app.replayInput(replayPath);
+        if (summary.frames == 0) { 
+            return 1;
+        }
+        summary.print(stdout);
+        return 0;
+    }
+    if (recordPath != nullptr) { 
+        app.startInputRecording(recordPath);
+    }
+    if (posterPath != nullptr && app.isHeadless()) { 
+        app.renderOffscreen();
+        app.requestPoster(posterPath, posterWidth, posterHeight);
+        app.renderOffscreen(1 << 20); // ends once the last tile is written
+        return 0;
+    }
+    if (posterPath != nullptr) { 
+        app.requestPoster(posterPath, posterWidth, posterHeight);
+    }
+    if (turntablePath != nullptr && app.isHeadless()) { 
+        app.renderOffscreen(); // let the scene settle before the first captured frame
+        app.recordTurntable(turntablePath, static_cast<uint32_t>(turntableFrames));
+        app.renderOffscreen(turntableFrames + 16);
+        return 0;
+    }
+    if (turntablePath != nullptr) { 
+        app.recordTurntable(turntablePath, static_cast<uint32_t>(turntableFrames), 60);
+    }
     app.run(); 
     return 0;
 }
-
@@ -0,0 +1,621 @@
+// graphisque_tests: checks of the CPU side (parser, sampling, encoders, allocators, logger,
+// job and frame scheduling). Links only the core sources; no window or GL context needed.
+//
+//   graphisque_tests [--filter TEXT]
+//
+// Prints one line per failed check and exits with 1 if any failed.
+
+#include "Expression.h"
+#include "FrameScheduler.h"
+#include "InputRecording.h"
+#include "JobSystem.h"
+#include "Logger.h"
+#include "MemoryArena.h"
+#include "PngWriter.h"
+#include "SampleGrid.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+static int g_failures = 0;
+
+#define CHECK(condition)                                                                  \
+    do {                                                                                  \
+        if (!(condition)) {                                                               \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            ++g_failures;                                                                 \
+        }                                                                                 \
+    } while (0)
+
+#define CHECK_NEAR(a, b, tolerance) CHECK(std::fabs(static_cast<double>(a) - static_cast<double>(b)) <= (tolerance))
+
+
+static std::string tempPath(const char* name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+
+// --- Expression ---
+
+static void testExpressionEvaluate() {
+    CHECK_NEAR(Expression("1 + 2 * 3").evaluate(0.0f, 0.0f), 7.0f, 1e-6);
+    CHECK_NEAR(Expression("(1 + 2) * 3").evaluate(0.0f, 0.0f), 9.0f, 1e-6);
+    CHECK_NEAR(Expression("2 ^ 3 ^ 2").evaluate(0.0f, 0.0f), 512.0f, 1e-3); // right associative
+    CHECK_NEAR(Expression("-x ^ 2").evaluate(3.0f, 0.0f), -9.0f, 1e-5);
+    CHECK_NEAR(Expression("sin(x) * cos(y) + 0.1 * x^2").evaluate(1.0f, 2.0f),
+               std::sin(1.0f) * std::cos(2.0f) + 0.1f, 1e-5);
+    CHECK_NEAR(Expression("atan2(y, x) + max(x, y) - min(x, y)").evaluate(1.0f, 2.0f),
+               std::atan2(2.0f, 1.0f) + 1.0f, 1e-5);
+    CHECK_NEAR(Expression("pi").evaluate(0.0f, 0.0f), 3.14159265f, 1e-6);
+}
+
+static void testExpressionFolding() {
+    //constant subexpressions collapse while parsing, variables stop them
+    Expression constant("sin(0) + 2 * 3");
+    CHECK(constant.getProgram().size() == 1);
+    CHECK(constant.getProgram()[0].op == Expression::OpCode::Constant);
+    CHECK_NEAR(constant.evaluate(5.0f, 5.0f), 6.0f, 1e-6);
+
+    Expression mixed("x + 2 * 3");
+    CHECK(mixed.getProgram().size() == 3);
+    CHECK_NEAR(mixed.evaluate(1.0f, 0.0f), 7.0f, 1e-6);
+}
+
+static void testExpressionErrors() {
+    const char* invalid[] = {"", "1 +", "(x", "foo(x)", "sin()", "x y", "1 2"};
+    for (const char* source : invalid) {
+        bool threw = false;
+        try {
+            Expression expression(source);
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        CHECK(threw);
+    }
+    CHECK(!Expression().isValid());
+}
+
+
+// --- SampleGrid ---
+
+static void testScalarRows() {
+    //z = x^2 + y: slope and curvature have closed forms away from the edges
+    SampleDomain domain{-2.0f, 2.0f, -2.0f, 2.0f, 0.5f};
+    SampleGrid grid = sampleSurface([](float x, float y) { return x * x + y; }, domain);
+    computeScalarChannels(grid, ALL_SCALAR_CHANNELS);
+    CHECK(grid.scalars.size() == 3 * grid.points.size());
+
+    const size_t columns = domain.countY();
+    const size_t k = 3 * columns + 5; // x = -0.5, y = 0.5
+    const glm::vec3& p = grid.points[k];
+    CHECK_NEAR(p.x, -0.5f, 1e-6);
+    CHECK_NEAR(p.z, 0.5f, 1e-6);
+    CHECK_NEAR(grid.scalars[grid.channelStart(ScalarChannel::Height) + k], 0.75f, 1e-5);
+    float fx = 2.0f * p.x, fy = 1.0f;
+    CHECK_NEAR(grid.scalars[grid.channelStart(ScalarChannel::Slope) + k], std::sqrt(fx * fx + fy * fy), 1e-4);
+    float g = 1.0f + fx * fx + fy * fy;
+    CHECK_NEAR(grid.scalars[grid.channelStart(ScalarChannel::Curvature) + k],
+               (1.0f + fy * fy) * 2.0f / (2.0f * g * std::sqrt(g)), 1e-4);
+
+    //tiles of rows reduce to the same ranges as one pass
+    SampleGrid tiled = sampleSurface([](float x, float y) { return x * x + y; }, domain);
+    tiled.resizeChannels(ALL_SCALAR_CHANNELS);
+    ScalarRanges ranges;
+    for (size_t row = 0; row < domain.countX(); row += 3) {
+        ScalarRanges partial = computeScalarRows(tiled, row, std::min(row + 3, domain.countX()));
+        for (size_t channel = 0; channel < SCALAR_CHANNEL_COUNT; ++channel) {
+            ranges[channel].merge(partial[channel]);
+        }
+    }
+    CHECK(tiled.scalars == grid.scalars);
+    for (size_t channel = 0; channel < SCALAR_CHANNEL_COUNT; ++channel) {
+        CHECK(ranges[channel] == grid.ranges[channel]);
+    }
+    CHECK_NEAR(grid.ranges[0].min, -2.0f, 1e-5);
+    CHECK_NEAR(grid.ranges[0].max, 5.5f, 1e-5);
+}
+
+static void testScalarRowsSkipsNonFinite() {
+    SampleDomain domain{0.0f, 1.0f, 0.0f, 1.0f, 0.25f};
+    SampleGrid grid = sampleSurface([](float x, float) { return x > 0.4f && x < 0.6f ? NAN : x; }, domain);
+    computeScalarChannels(grid, channelBit(ScalarChannel::Height));
+    CHECK(grid.ranges[0].isValid());
+    CHECK_NEAR(grid.ranges[0].min, 0.0f, 1e-6);
+    CHECK_NEAR(grid.ranges[0].max, 0.75f, 1e-6);
+    CHECK(!grid.ranges[1].isValid());
+}
+
+
+// --- PNG ---
+
+static uint32_t loadU32(const uint8_t* in) {
+    return (uint32_t(in[0]) << 24) | (uint32_t(in[1]) << 16) | (uint32_t(in[2]) << 8) | uint32_t(in[3]);
+}
+
+// Decodes what PngStreamWriter writes (stored deflate blocks, filter 0), checking every
+// CRC and the Adler-32. False on anything else.
+static bool decodeStoredPng(const std::vector<uint8_t>& png, int& width, int& height, std::vector<uint8_t>& rgba,
+                            size_t& idatChunks) {
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    if (png.size() < 8 || std::memcmp(png.data(), signature, 8) != 0) {
+        return false;
+    }
+    std::vector<uint8_t> zlib;
+    bool ended = false;
+    idatChunks = 0;
+    for (size_t pos = 8; pos < png.size() && !ended;) {
+        if (png.size() - pos < 12) {
+            return false;
+        }
+        size_t length = loadU32(&png[pos]);
+        if (png.size() - pos - 12 < length) {
+            return false;
+        }
+        const uint8_t* type = &png[pos + 4];
+        const uint8_t* data = &png[pos + 8];
+        if (PngWriter::crc32(type, length + 4) != loadU32(data + length)) {
+            return false;
+        }
+        if (std::memcmp(type, "IHDR", 4) == 0) {
+            width = static_cast<int>(loadU32(data));
+            height = static_cast<int>(loadU32(data + 4));
+        } else if (std::memcmp(type, "IDAT", 4) == 0) {
+            zlib.insert(zlib.end(), data, data + length);
+            ++idatChunks;
+        } else if (std::memcmp(type, "IEND", 4) == 0) {
+            ended = true;
+        }
+        pos += length + 12;
+    }
+    if (!ended || zlib.size() < 6 || ((zlib[0] << 8) | zlib[1]) % 31 != 0) {
+        return false;
+    }
+    std::vector<uint8_t> raw;
+    size_t pos = 2;
+    for (bool last = false; !last;) {
+        if (zlib.size() - pos < 5) {
+            return false;
+        }
+        last = (zlib[pos] & 1) != 0;
+        size_t length = zlib[pos + 1] | (zlib[pos + 2] << 8);
+        size_t inverse = zlib[pos + 3] | (zlib[pos + 4] << 8);
+        if ((zlib[pos] & 6) != 0 || (length ^ 0xFFFF) != inverse || zlib.size() - pos - 5 < length) {
+            return false;
+        }
+        raw.insert(raw.end(), zlib.begin() + pos + 5, zlib.begin() + pos + 5 + length);
+        pos += 5 + length;
+    }
+    uint32_t a = 1, b = 0;
+    for (uint8_t byte : raw) {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    if (zlib.size() - pos != 4 || loadU32(&zlib[pos]) != ((b << 16) | a)) {
+        return false;
+    }
+    const size_t rowBytes = static_cast<size_t>(width) * 4;
+    if (raw.size() != (rowBytes + 1) * static_cast<size_t>(height)) {
+        return false;
+    }
+    rgba.clear();
+    for (int row = 0; row < height; ++row) {
+        const uint8_t* line = &raw[row * (rowBytes + 1)];
+        if (line[0] != 0) {
+            return false;
+        }
+        rgba.insert(rgba.end(), line + 1, line + 1 + rowBytes);
+    }
+    return true;
+}
+
+static void testPngStreamWriter() {
+    //large enough for several stored blocks and more than one IDAT chunk
+    const int width = 700, height = 400;
+    std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+    for (size_t i = 0; i < pixels.size(); ++i) {
+        pixels[i] = static_cast<uint8_t>((i * 7) ^ (i >> 9));
+    }
+    std::vector<uint8_t> png;
+    PngStreamWriter writer;
+    auto sink = [&png](const uint8_t* data, size_t size) {
+        png.insert(png.end(), data, data + size);
+        return true;
+    };
+    CHECK(writer.begin(sink, width, height));
+    for (int row = 0; row < height; ++row) {
+        CHECK(writer.writeRow(&pixels[static_cast<size_t>(row) * width * 4]));
+    }
+    CHECK(!writer.writeRow(pixels.data())); // one row too many
+    CHECK(writer.finish());
+
+    int decodedWidth = 0, decodedHeight = 0;
+    size_t idatChunks = 0;
+    std::vector<uint8_t> decoded;
+    CHECK(decodeStoredPng(png, decodedWidth, decodedHeight, decoded, idatChunks));
+    CHECK(decodedWidth == width && decodedHeight == height);
+    CHECK(idatChunks > 1);
+    CHECK(decoded == pixels);
+
+    //PngWriter::encode with a flip writes the last row first
+    std::vector<uint8_t> flipped;
+    PngWriter::encode(width, height, pixels.data(), true, flipped);
+    CHECK(decodeStoredPng(flipped, decodedWidth, decodedHeight, decoded, idatChunks));
+    CHECK(std::memcmp(decoded.data(), &pixels[static_cast<size_t>(height - 1) * width * 4], width * 4) == 0);
+}
+
+static void testPngStreamWriterFailures() {
+    PngStreamWriter writer;
+    auto discard = [](const uint8_t*, size_t) { return true; };
+    CHECK(!writer.begin(discard, 0, 4));
+
+    uint8_t row[16] = {};
+    CHECK(writer.begin(discard, 4, 2));
+    CHECK(writer.writeRow(row));
+    CHECK(!writer.finish()); // a row is missing
+
+    //a failing sink fails the writer, not just the one call
+    size_t calls = 0;
+    auto failing = [&calls](const uint8_t*, size_t) { return ++calls < 3; };
+    CHECK(!writer.begin(failing, 4, 2));
+    CHECK(!writer.writeRow(row));
+}
+
+
+// --- Input recording ---
+
+static void testInputRoundTrip() {
+    const std::string path = tempPath("graphisque_tests_input.gqir");
+    std::vector<InputEvent> events(5);
+    events[0].type = InputEventType::Key;
+    events[0].code = 87;
+    events[0].action = 1;
+    events[0].mods = 2;
+    events[1].type = InputEventType::MouseButton;
+    events[1].code = 1;
+    events[1].action = 1;
+    events[1].x = 120.5;
+    events[1].y = -3.25;
+    events[2].type = InputEventType::CursorPos;
+    events[2].x = 640.125;
+    events[2].y = 360.0;
+    events[3].type = InputEventType::FramebufferSize;
+    events[3].x = 1920;
+    events[3].y = 1080;
+    events[4].type = InputEventType::Command;
+    events[4].code = static_cast<int>(SceneCommand::SampleStep);
+    events[4].value = 0.125f;
+    const double start = 100.0;
+    const double times[] = {0.0, 0.016, 0.5, 0.5, 2.75};
+
+    InputRecorder recorder;
+    CHECK(recorder.begin(path, 800, 600, start));
+    for (size_t i = 0; i < events.size(); ++i) {
+        recorder.record(events[i], start + times[i]);
+    }
+    CHECK(recorder.eventCount() == events.size());
+    recorder.end();
+
+    InputReplay replay;
+    CHECK(replay.load(path));
+    CHECK(replay.getWidth() == 800 && replay.getHeight() == 600);
+    const std::vector<InputEvent>& loaded = replay.getEvents();
+    CHECK(loaded.size() == events.size());
+    for (size_t i = 0; i < loaded.size() && i < events.size(); ++i) {
+        const InputEvent& a = events[i];
+        const InputEvent& b = loaded[i];
+        CHECK(a.type == b.type);
+        CHECK_NEAR(b.time, times[i], 1e-6);
+        CHECK(a.code == b.code && a.action == b.action && a.mods == b.mods);
+        if (a.type != InputEventType::Key) {
+            CHECK(a.x == b.x && a.y == b.y);
+        }
+        CHECK(a.value == b.value);
+    }
+    CHECK_NEAR(replay.getDuration(), 2.75, 1e-6);
+    std::error_code error;
+    std::filesystem::remove(path, error);
+
+    CHECK(!replay.load(tempPath("graphisque_tests_missing.gqir")));
+}
+
+static void testFrameTimeSummary() {
+    std::vector<double> frames;
+    for (int i = 100; i >= 1; --i) {
+        frames.push_back(static_cast<double>(i)); // unsorted on purpose
+    }
+    FrameTimeSummary summary = FrameTimeSummary::from(frames);
+    CHECK(summary.frames == 100);
+    CHECK_NEAR(summary.meanMs, 50.5, 1e-9);
+    CHECK(summary.p50Ms == 50.0);
+    CHECK(summary.p99Ms == 99.0);
+    CHECK(summary.maxMs == 100.0);
+
+    FrameTimeSummary one = FrameTimeSummary::from({4.0});
+    CHECK(one.p50Ms == 4.0 && one.p99Ms == 4.0 && one.maxMs == 4.0);
+    CHECK(FrameTimeSummary::from({}).frames == 0);
+}
+
+
+// --- Allocators ---
+
+static void testArenaResource() {
+    ArenaResource arena(1024);
+    void* a = arena.allocate(100, 8);
+    CHECK(reinterpret_cast<uintptr_t>(a) % 8 == 0);
+    ArenaResource::Marker marker = arena.mark();
+    void* b = arena.allocate(64, 64);
+    CHECK(reinterpret_cast<uintptr_t>(b) % 64 == 0);
+    arena.rewind(marker);
+    CHECK(arena.allocate(64, 64) == b); // the same bytes again after a rewind
+
+    //outgrowing the first chunk, then a reset merges the chunks into one
+    for (int i = 0; i < 20; ++i) {
+        CHECK(arena.allocate(500, 16) != nullptr);
+    }
+    const size_t peak = arena.bytesUsed();
+    CHECK(arena.peakBytes() >= peak);
+    CHECK(arena.capacity() >= peak);
+    arena.reset();
+    CHECK(arena.bytesUsed() == 0);
+    const size_t capacity = arena.capacity();
+    for (int i = 0; i < 20; ++i) {
+        CHECK(arena.allocate(500, 16) != nullptr);
+    }
+    CHECK(arena.capacity() == capacity); // the steady workload no longer grows it
+}
+
+static void testPoolResource() {
+    PoolResource pool(48, 4);
+    CHECK(pool.blockSize() >= 48);
+    std::vector<void*> blocks;
+    for (int i = 0; i < 6; ++i) {
+        blocks.push_back(pool.allocate(48, 8));
+    }
+    CHECK(pool.blocksInUse() == 6);
+    CHECK(pool.blocksAllocated() == 8);
+    void* last = blocks.back();
+    pool.deallocate(last, 48, 8);
+    blocks.pop_back();
+    CHECK(pool.allocate(48, 8) == last); // free list hands back the newest block
+    blocks.push_back(last);
+
+    void* big = pool.allocate(pool.blockSize() + 1, 8);
+    CHECK(pool.oversizedRequests() == 1);
+    pool.deallocate(big, pool.blockSize() + 1, 8);
+    for (void* block : blocks) {
+        pool.deallocate(block, 48, 8);
+    }
+    CHECK(pool.blocksInUse() == 0);
+}
+
+
+// --- Logger ---
+
+static LogRecord makeRecord(const char* format) {
+    LogRecord record;
+    record.timeNs = 0;
+    record.tag = "test";
+    record.format = format;
+    record.threadId = 1;
+    record.level = LogLevel::Info;
+    record.size = 0;
+    record.truncated = false;
+    return record;
+}
+
+// The formatted message, without the time/level/thread/tag prefix and the newline
+static std::string formatMessage(const LogRecord& record) {
+    char line[512];
+    size_t length = Logger::format(record, line, sizeof(line));
+    std::string text(line, length);
+    size_t start = text.find("(test) ");
+    if (start == std::string::npos || text.empty() || text.back() != '\n') {
+        return "<malformed: " + text + ">";
+    }
+    return text.substr(start + 7, text.size() - start - 8);
+}
+
+static void testLoggerFormat() {
+    LogRecord record = makeRecord("{} {} {:.2f} {:08x} {} {} {{}}");
+    record.put(-42);
+    record.put(7u);
+    record.put(3.14159);
+    record.put(0xbeefu);
+    record.put('c');
+    record.put(std::string("text"));
+    CHECK(formatMessage(record) == "-42 7 3.14 0000beef c text {}");
+
+    LogRecord missing = makeRecord("{} and {}");
+    missing.put(true);
+    CHECK(formatMessage(missing) == "true and {?}");
+}
+
+static void testLoggerTruncation() {
+    //an argument that doesn't fit ends the packing: later ones don't slide into its placeholder
+    LogRecord record = makeRecord("{} {} {} {}");
+    record.put(1);
+    record.put(std::string(LogRecord::PAYLOAD_BYTES, 'x'));
+    record.put(2);
+    record.put(3);
+    CHECK(record.truncated);
+    std::string message = formatMessage(record);
+    CHECK(message.compare(0, 4, "1 xx") == 0);
+    CHECK(message.find(" {?} {?} [truncated]") != std::string::npos);
+
+    //14 integers leave 2 bytes: the double doesn't fit, the char after it would
+    LogRecord numbers = makeRecord("{} {} {} {} {} {} {} {} {} {} {} {} {} {} {} {}");
+    for (int i = 0; i < 14; ++i) {
+        numbers.put(i);
+    }
+    CHECK(!numbers.truncated);
+    numbers.put(2.5);
+    numbers.put('z');
+    CHECK(numbers.truncated);
+    CHECK(formatMessage(numbers) == "0 1 2 3 4 5 6 7 8 9 10 11 12 13 {?} {?} [truncated]");
+
+    LogRecord fits = makeRecord("{}");
+    fits.put(std::string("short"));
+    CHECK(!fits.truncated);
+    CHECK(formatMessage(fits) == "short");
+
+    //a small buffer still ends in a newline
+    char line[24];
+    size_t length = Logger::format(numbers, line, sizeof(line));
+    CHECK(length > 0 && length < sizeof(line) && line[length - 1] == '\n');
+}
+
+
+// --- JobSystem ---
+
+static void testJobDependencies() {
+    JobSystem jobs(3);
+    std::atomic<int> sum{0};
+    JobHandle first = jobs.parallelFor(1000, 64, [&sum](size_t begin, size_t end) {
+        sum.fetch_add(static_cast<int>(end - begin));
+    });
+    int seen = -1;
+    JobHandle after = jobs.schedule([&sum, &seen] { seen = sum.load(); }, JobPriority::Refine, CancellationToken(), {first});
+    jobs.wait(after);
+    CHECK(seen == 1000);
+
+    CancellationToken token;
+    token.cancel();
+    bool ran = false;
+    jobs.wait(jobs.schedule([&ran] { ran = true; }, JobPriority::VisibleNow, token));
+    CHECK(!ran);
+}
+
+static void testJobShutdown() {
+    //jobs still queued at shutdown, their dependents and jobs submitted afterwards all
+    //finish without running, so nothing waiting on them hangs
+    JobSystem jobs(1);
+    std::atomic<bool> release{false};
+    std::atomic<int> ran{0};
+    JobHandle blocker = jobs.schedule([&release] {
+        while (!release.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+    std::vector<JobHandle> queued;
+    for (int i = 0; i < 16; ++i) {
+        queued.push_back(jobs.schedule([&ran] { ran.fetch_add(1); }, JobPriority::Prefetch));
+    }
+    JobHandle dependent = jobs.schedule([&ran] { ran.fetch_add(1); }, JobPriority::Refine, CancellationToken(), queued);
+
+    std::thread releaser([&release] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        release = true;
+    });
+    jobs.shutdown();
+    releaser.join();
+
+    jobs.wait(blocker);
+    for (const JobHandle& job : queued) {
+        jobs.wait(job);
+    }
+    jobs.wait(dependent);
+    CHECK(ran.load() <= 17);
+
+    bool late = false;
+    JobHandle afterShutdown = jobs.schedule([&late] { late = true; });
+    jobs.wait(afterShutdown);
+    CHECK(!late);
+}
+
+
+// --- FrameScheduler ---
+
+static void testFrameSchedulerBudget() {
+    //a slice always runs, even one that overshoots the whole budget
+    FrameScheduler scheduler(0.5);
+    int slow = 0;
+    scheduler.enqueue("slow", [&slow] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        return ++slow < 3 ? TaskStatus::Continue : TaskStatus::Done;
+    });
+    CHECK(scheduler.pending() == 1);
+    CHECK(scheduler.runFrame() == 1);
+    CHECK(scheduler.lastFrameTime() >= 2.0);
+    CHECK(scheduler.runFrame() == 1);
+    CHECK(scheduler.runFrame() == 1);
+    CHECK(scheduler.idle());
+    CHECK(scheduler.runFrame() == 0);
+
+    //cheap slices share a frame and take turns; a throwing task is dropped, not retried
+    scheduler.setBudget(50.0);
+    std::string order;
+    auto task = [&order](char name, int slices) {
+        auto left = std::make_shared<int>(slices);
+        return [&order, name, left] {
+            order += name;
+            return --*left > 0 ? TaskStatus::Continue : TaskStatus::Done;
+        };
+    };
+    scheduler.enqueue("a", task('a', 3));
+    scheduler.enqueue("b", task('b', 2));
+    scheduler.enqueue("throws", []() -> TaskStatus { throw std::runtime_error("expected by the test"); });
+    CHECK(scheduler.pending() == 3);
+    CHECK(scheduler.runFrame() == 6);
+    CHECK(order == "ababa");
+    CHECK(scheduler.idle());
+}
+
+
+struct TestCase {
+    const char* name;
+    void (*run)();
+};
+
+static const TestCase TESTS[] = {
+    {"expression/evaluate", testExpressionEvaluate},
+    {"expression/folding", testExpressionFolding},
+    {"expression/errors", testExpressionErrors},
+    {"samplegrid/scalar_rows", testScalarRows},
+    {"samplegrid/non_finite", testScalarRowsSkipsNonFinite},
+    {"png/stream_writer", testPngStreamWriter},
+    {"png/failures", testPngStreamWriterFailures},
+    {"input/round_trip", testInputRoundTrip},
+    {"input/frame_time_summary", testFrameTimeSummary},
+    {"memory/arena", testArenaResource},
+    {"memory/pool", testPoolResource},
+    {"logger/format", testLoggerFormat},
+    {"logger/truncation", testLoggerTruncation},
+    {"jobs/dependencies", testJobDependencies},
+    {"jobs/shutdown", testJobShutdown},
+    {"scheduler/budget", testFrameSchedulerBudget},
+};
+
+
+int main(int argc, char** argv) {
+    std::string filter;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else {
+            std::fprintf(stderr, "usage: %s [--filter TEXT]\n", argv[0]);
+            return 2;
+        }
+    }
+    size_t run = 0;
+    for (const TestCase& test : TESTS) {
+        if (!filter.empty() && std::string(test.name).find(filter) == std::string::npos) {
+            continue;
+        }
+        const int before = g_failures;
+        test.run();
+        std::printf("%-28s %s\n", test.name, g_failures == before ? "ok" : "FAILED");
+        ++run;
+    }
+    std::printf("%zu tests, %d failed checks\n", run, g_failures);
+    return g_failures == 0 ? 0 : 1;
+}